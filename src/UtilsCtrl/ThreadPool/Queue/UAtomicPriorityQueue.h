@@ -4,12 +4,19 @@
 @File: UAtomicPriorityQueue.h
 @Time: 2022/10/1 21:40
 @Desc: 线程安全的优先队列。因为 priority_queue和queue的弹出方式不一致，故暂时不做合并
+ * 1. 按照优先级，将任务放到不同的桶中，每个桶是一个独立加锁的先进先出队列。通过位图，快速找到非空的桶
+ * 2. 支持老化(aging)机制：任务每等待 aging 时长，优先级视为提升1，防止低优先级任务一直得不到执行
 ***************************/
 
 #ifndef CGRAPH_UATOMICPRIORITYQUEUE_H
 #define CGRAPH_UATOMICPRIORITYQUEUE_H
 
-#include <queue>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
 
 #include "UQueueObject.h"
 
@@ -17,8 +24,34 @@ CGRAPH_NAMESPACE_BEGIN
 
 template<typename T>
 class UAtomicPriorityQueue : public UQueueObject {
+    static const CInt MIN_PRIORITY = -128;                      // 最小的优先级，更小的按照此值处理
+    static const CInt MAX_PRIORITY = 127;                       // 最大的优先级，更大的按照此值处理
+    static const CInt BUCKET_SIZE = MAX_PRIORITY - MIN_PRIORITY + 1;
+    static const CInt WORD_SIZE = BUCKET_SIZE / 64;
+
+    struct Bucket {
+        std::mutex mutex_;
+        std::deque<std::pair<T, std::int64_t> > items_;         // 任务信息，以及写入时间（ns）
+        std::atomic<std::int64_t> front_time_ {0};              // 队首任务的写入时间，用于老化计算
+    };
+
 public:
-    UAtomicPriorityQueue() = default;
+    UAtomicPriorityQueue() {
+        for (auto& bucket : buckets_) {
+            bucket.store(nullptr, std::memory_order_relaxed);
+        }
+        for (auto& word : bitmap_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+
+    ~UAtomicPriorityQueue() override {
+        for (auto& bucket : buckets_) {
+            delete bucket.load(std::memory_order_relaxed);
+        }
+    }
+
 
     /**
      * 尝试弹出
@@ -26,17 +59,27 @@ public:
      * @return
      */
     CBool tryPop(T& value) {
-        CBool result = false;
-        if (mutex_.try_lock()) {
-            if (!priority_queue_.empty()) {
-                value = std::move(*priority_queue_.top());
-                priority_queue_.pop();
-                result = true;
+        while (true) {
+            CInt index = selectBucket();
+            if (index < 0) {
+                return false;
             }
-            mutex_.unlock();
-        }
 
-        return result;
+            Bucket* bucket = buckets_[index].load(std::memory_order_acquire);
+            CGRAPH_LOCK_GUARD lk(bucket->mutex_);
+            if (bucket->items_.empty()) {
+                continue;    // 已经被其他线程取走了，重新选择
+            }
+
+            value = std::move(bucket->items_.front().first);
+            bucket->items_.pop_front();
+            if (bucket->items_.empty()) {
+                bitmap_[index / 64].fetch_and(~(1ULL << (index % 64)), std::memory_order_acq_rel);
+            } else {
+                bucket->front_time_.store(bucket->items_.front().second, std::memory_order_relaxed);
+            }
+            return true;
+        }
     }
 
 
@@ -48,15 +91,11 @@ public:
      */
     CBool tryPop(std::vector<T>& values, int maxPoolBatchSize) {
         CBool result = false;
-        if (mutex_.try_lock()) {
-            while (!priority_queue_.empty() && maxPoolBatchSize-- > 0) {
-                values.emplace_back(std::move(*priority_queue_.top()));
-                priority_queue_.pop();
-                result = true;
-            }
-            mutex_.unlock();
+        T value;
+        while (maxPoolBatchSize-- > 0 && tryPop(value)) {
+            values.emplace_back(std::move(value));
+            result = true;
         }
-
         return result;
     }
 
@@ -64,13 +103,21 @@ public:
     /**
      * 传入数据
      * @param value
-     * @param priority 任务优先级，数字排序
+     * @param priority 任务优先级，数字排序。超过 [-128, 127] 范围的，按照边界值处理
      * @return
      */
     CVoid push(T&& value, int priority) {
-        std::unique_ptr<T> task(c_make_unique<T>(std::move(value), priority));
-        CGRAPH_LOCK_GUARD lk(mutex_);
-        priority_queue_.push(std::move(task));
+        priority = priority < MIN_PRIORITY ? MIN_PRIORITY : (priority > MAX_PRIORITY ? MAX_PRIORITY : priority);
+        CInt index = priority - MIN_PRIORITY;
+        Bucket* bucket = obtainBucket(index);
+        std::int64_t now = aging_ns_ > 0 ? currentNs() : 0;
+
+        CGRAPH_LOCK_GUARD lk(bucket->mutex_);
+        bucket->items_.emplace_back(std::move(value), now);
+        if (1 == bucket->items_.size()) {
+            bucket->front_time_.store(now, std::memory_order_relaxed);
+            bitmap_[index / 64].fetch_or(1ULL << (index % 64), std::memory_order_acq_rel);
+        }
     }
 
 
@@ -79,14 +126,124 @@ public:
      * @return
      */
     CBool empty() {
-        CGRAPH_LOCK_GUARD lk(mutex_);
-        return priority_queue_.empty();
+        return std::all_of(std::begin(bitmap_), std::end(bitmap_), [](const std::atomic<std::uint64_t>& word) {
+            return 0 == word.load(std::memory_order_acquire);
+        });
+    }
+
+
+    /**
+     * 获取队列中任务的个数。依次对非空的桶加锁，仅用于统计信息
+     * @return
+     */
+    CSize size() {
+        CSize result = 0;
+        for (CInt index = 0; index < BUCKET_SIZE; index++) {
+            if (0 == (bitmap_[index / 64].load(std::memory_order_acquire) & (1ULL << (index % 64)))) {
+                continue;
+            }
+
+            Bucket* bucket = buckets_[index].load(std::memory_order_acquire);
+            CGRAPH_LOCK_GUARD lk(bucket->mutex_);
+            result += bucket->items_.size();
+        }
+        return result;
+    }
+
+
+    /**
+     * 设置老化时间。任务每等待 ms 时长，优先级视为提升1。为0的时候，不开启老化机制
+     * @param ms
+     * @notice 需要在写入任务之前设置
+     */
+    CVoid setAgingInterval(CMSec ms) {
+        aging_ns_ = (ms > 0) ? (std::int64_t)ms * 1000000 : 0;
     }
 
     CGRAPH_NO_ALLOWED_COPY(UAtomicPriorityQueue)
 
 private:
-    std::priority_queue<std::unique_ptr<T> > priority_queue_;    // 优先队列信息，根据重要级别决定先后执行顺序
+    /**
+     * 选择待弹出的桶。不开启老化的时候，直接选择优先级最高的桶
+     * 开启老化的时候，比较每个非空桶队首任务的等效优先级（优先级 + 等待时长 / aging）
+     * @return 没有任务的时候，返回-1
+     */
+    CInt selectBucket() {
+        CInt best = -1;
+        std::int64_t bestScore = 0;
+        for (CInt word = WORD_SIZE - 1; word >= 0; word--) {
+            std::uint64_t bits = bitmap_[word].load(std::memory_order_acquire);
+            while (0 != bits) {
+                CInt offset = highestBit(bits);
+                bits &= ~(1ULL << offset);
+                CInt index = word * 64 + offset;
+                if (aging_ns_ <= 0) {
+                    return index;
+                }
+
+                Bucket* bucket = buckets_[index].load(std::memory_order_acquire);
+                std::int64_t score = index * aging_ns_ - bucket->front_time_.load(std::memory_order_relaxed);
+                if (best < 0 || score > bestScore) {
+                    best = index;
+                    bestScore = score;
+                }
+            }
+        }
+        return best;
+    }
+
+
+    /**
+     * 获取对应的桶，第一次使用的时候创建
+     * @param index
+     * @return
+     */
+    Bucket* obtainBucket(CInt index) {
+        Bucket* bucket = buckets_[index].load(std::memory_order_acquire);
+        if (unlikely(nullptr == bucket)) {
+            auto* fresh = new Bucket();
+            if (buckets_[index].compare_exchange_strong(bucket, fresh, std::memory_order_acq_rel,
+                                                        std::memory_order_acquire)) {
+                bucket = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        return bucket;
+    }
+
+
+    /**
+     * 获取最高位的1所在的位置
+     * @param bits 非0值
+     * @return
+     */
+    static CInt highestBit(std::uint64_t bits) {
+    #if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(bits);
+    #else
+        CInt result = 0;
+        while (bits >>= 1) {
+            result++;
+        }
+        return result;
+    #endif
+    }
+
+
+    /**
+     * 获取当前时间，单位为ns
+     * @return
+     */
+    static std::int64_t currentNs() {
+        return (std::int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    std::atomic<Bucket *> buckets_[BUCKET_SIZE];                // 每个优先级对应的桶，按需创建
+    std::atomic<std::uint64_t> bitmap_[WORD_SIZE];              // 记录非空的桶，用于快速查找
+    std::int64_t aging_ns_ = 0;                                 // 老化时间，单位为ns
 };
 
 CGRAPH_NAMESPACE_END
@@ -11,7 +11,7 @@
 
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <vector>
 #include <condition_variable>
 
 #include "../UThreadPoolDefine.h"
@@ -31,7 +31,7 @@ public:
     CVoid waitPop(T& value) {
         CGRAPH_UNIQUE_LOCK lk(mutex_);
         cv_.wait(lk, [this] { return !queue_.empty(); });
-        value = std::move(*queue_.front());
+        value = std::move(queue_.front());
         queue_.pop();
     }
 
@@ -45,7 +45,7 @@ public:
         CBool result = false;
         if (!queue_.empty() && mutex_.try_lock()) {
             if (!queue_.empty()) {
-                value = std::move(*queue_.front());
+                value = std::move(queue_.front());
                 queue_.pop();
                 result = true;
             }
@@ -66,7 +66,7 @@ public:
         CBool result = false;
         if (!queue_.empty() && mutex_.try_lock()) {
             while (!queue_.empty() && maxPoolBatchSize-- > 0) {
-                values.emplace_back(std::move(*queue_.front()));
+                values.emplace_back(std::move(queue_.front()));
                 queue_.pop();
                 result = true;
             }
@@ -79,22 +79,35 @@ public:
 
     /**
      * 阻塞式等待弹出
+     * @param value
+     * @param ms
      * @return
      */
-    std::unique_ptr<T> popWithTimeout(CMSec ms) {
+    CBool popWithTimeout(T& value, CMSec ms) {
         CGRAPH_UNIQUE_LOCK lk(mutex_);
         if (!cv_.wait_for(lk, std::chrono::milliseconds(ms),
                           [this] { return (!queue_.empty()) || (!ready_flag_); })) {
-            return nullptr;
+            return false;
         }
 
         if (queue_.empty() || !ready_flag_) {
-            return nullptr;
+            return false;
         }
 
-        std::unique_ptr<T> result = std::move(queue_.front());
+        value = std::move(queue_.front());
         queue_.pop();    // 如果等成功了，则弹出一个信息
-        return result;
+        return true;
+    }
+
+
+    /**
+     * 阻塞式等待弹出
+     * @return
+     * @notice 返回智能指针的方式，会额外申请一次内存。推荐使用 popWithTimeout(value, ms) 的方式
+     */
+    std::unique_ptr<T> popWithTimeout(CMSec ms) {
+        T value;
+        return popWithTimeout(value, ms) ? c_make_unique<T>(std::move(value)) : nullptr;
     }
 
 
@@ -105,7 +118,7 @@ public:
     std::unique_ptr<T> tryPop() {
         CGRAPH_LOCK_GUARD lk(mutex_);
         if (queue_.empty()) { return std::unique_ptr<T>(); }
-        std::unique_ptr<T> ptr = std::move(queue_.front());
+        std::unique_ptr<T> ptr = c_make_unique<T>(std::move(queue_.front()));
         queue_.pop();
         return ptr;
     }
@@ -114,13 +127,12 @@ public:
     /**
      * 传入数据
      * @param value
+     * @notice 直接存放 T 类型的值，不再额外申请内存
      */
     CVoid push(T&& value) {
-        std::unique_ptr<typename std::remove_reference<T>::type>     \
-                task(c_make_unique<typename std::remove_reference<T>::type>(std::forward<T>(value)));
         while (true) {
             if (mutex_.try_lock()) {
-                queue_.push(std::move(task));
+                queue_.push(std::forward<T>(value));
                 mutex_.unlock();
                 break;
             } else {
@@ -131,6 +143,34 @@ public:
     }
 
 
+    /**
+     * 批量传入数据，仅加锁一次，并且按照任务个数唤醒等待的线程
+     * @tparam Iterator
+     * @param begin
+     * @param end
+     * @notice [begin, end) 中的内容，会被 move 到队列中
+     */
+    template<typename Iterator>
+    CVoid pushBulk(Iterator begin, Iterator end) {
+        CSize size = 0;
+        while (true) {
+            if (mutex_.try_lock()) {
+                for (auto iter = begin; iter != end; ++iter, ++size) {
+                    queue_.push(std::move(*iter));
+                }
+                mutex_.unlock();
+                break;
+            } else {
+                CGRAPH_YIELD();
+            }
+        }
+
+        while (size-- > 0) {
+            cv_.notify_one();
+        }
+    }
+
+
     /**
      * 判定队列是否为空
      * @return
@@ -141,6 +181,16 @@ public:
     }
 
 
+    /**
+     * 获取队列中任务的个数
+     * @return
+     */
+    CSize size() {
+        CGRAPH_LOCK_GUARD lk(mutex_);
+        return queue_.size();
+    }
+
+
     /**
      * 功能是通知所有的辅助线程停止工作
      * @return
@@ -163,7 +213,57 @@ public:
     CGRAPH_NO_ALLOWED_COPY(UAtomicQueue)
 
 private:
-    std::queue<std::unique_ptr<T>> queue_ {};    // 任务队列
+    /**
+     * 可扩容的环形缓冲区，接口和 std::queue 保持一致
+     * std::deque 在写入和弹出的过程中，会反复申请和释放内存块。这里弹出之后保留容量，稳定运行时写入不再申请内存
+     */
+    class RingQueue {
+    public:
+        CBool empty() const {
+            return 0 == size_;
+        }
+
+        CSize size() const {
+            return size_;
+        }
+
+        T& front() {
+            return buffer_[head_];
+        }
+
+        CVoid pop() {
+            head_ = (head_ + 1) & (buffer_.size() - 1);
+            size_--;
+        }
+
+        CVoid push(T&& value) {
+            if (size_ == buffer_.size()) {
+                grow();
+            }
+            buffer_[(head_ + size_) & (buffer_.size() - 1)] = std::move(value);
+            size_++;
+        }
+
+    private:
+        /**
+         * 容量翻倍（保持为2的幂），并且将已有的内容按照顺序 move 到新的缓冲区中
+         */
+        CVoid grow() {
+            std::vector<T> buffer(buffer_.empty() ? CGRAPH_ATOMIC_QUEUE_INIT_SIZE : buffer_.size() * 2);
+            for (CSize i = 0; i < size_; i++) {
+                buffer[i] = std::move(buffer_[(head_ + i) & (buffer_.size() - 1)]);
+            }
+            buffer_.swap(buffer);
+            head_ = 0;
+        }
+
+    private:
+        std::vector<T> buffer_;                  // 缓冲区，容量为0或者2的幂
+        CSize head_ = 0;                         // 队首的位置
+        CSize size_ = 0;                         // 元素个数
+    };
+
+    RingQueue queue_ {};                         // 任务队列
     CBool ready_flag_ { true };                  // 执行标记，主要用于快速释放 destroy 逻辑中，多个辅助线程等待的状态
 };
 
@@ -0,0 +1,123 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: UHazardPointer.h
+@Time: 2026/10/17 22:40
+@Desc: 简易的 hazard pointer 实现，用于无锁队列中内存的安全回收
+ * 每个线程持有一个 record，记录当前正在访问的节点。
+ * 被回收的节点，只有在没有任何线程记录的时候，才会被真正释放
+***************************/
+
+#ifndef CGRAPH_UHAZARDPOINTER_H
+#define CGRAPH_UHAZARDPOINTER_H
+
+#include <atomic>
+
+#include "../UThreadObject.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+class UHazardPointer : public UThreadObject {
+    struct HazardRecord {
+        std::atomic<CVoidPtr> ptr_ {nullptr};               // 当前线程正在访问的节点
+        std::atomic<CBool> active_ {false};                 // 是否被某个线程持有
+        HazardRecord* next_ = nullptr;                      // record 串成链表，只增不减
+    };
+
+    /**
+     * 线程退出的时候，归还 record，供后续线程复用
+     */
+    struct HazardHolder {
+        HazardRecord* record_ = nullptr;
+        ~HazardHolder() {
+            if (record_) {
+                record_->ptr_.store(nullptr, std::memory_order_release);
+                record_->active_.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+public:
+    /**
+     * 保护 src 当前指向的节点，保证返回后节点不会被释放
+     * @tparam T
+     * @param src
+     * @return
+     */
+    template<typename T>
+    static T* protect(const std::atomic<T *>& src) {
+        HazardRecord* record = localRecord();
+        T* ptr = src.load(std::memory_order_relaxed);
+        while (true) {
+            record->ptr_.store(ptr, std::memory_order_seq_cst);
+            T* cur = src.load(std::memory_order_seq_cst);
+            if (cur == ptr) {
+                break;
+            }
+            ptr = cur;
+        }
+        return ptr;
+    }
+
+    /**
+     * 清除当前线程的保护信息
+     */
+    static CVoid clear() {
+        localRecord()->ptr_.store(nullptr, std::memory_order_release);
+    }
+
+    /**
+     * 判断节点是否正在被某个线程访问
+     * @param ptr
+     * @return
+     */
+    static CBool isHazard(CVoidPtr ptr) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (HazardRecord* cur = head().load(std::memory_order_acquire); cur; cur = cur->next_) {
+            if (cur->ptr_.load(std::memory_order_acquire) == ptr) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static std::atomic<HazardRecord *>& head() {
+        static std::atomic<HazardRecord *> head {nullptr};
+        return head;
+    }
+
+    /**
+     * 获取当前线程的 record。优先复用已退出线程的 record
+     * @return
+     */
+    static HazardRecord* localRecord() {
+        static thread_local HazardHolder holder;
+        if (likely(holder.record_)) {
+            return holder.record_;
+        }
+
+        auto& records = head();
+        for (HazardRecord* cur = records.load(std::memory_order_acquire); cur; cur = cur->next_) {
+            CBool expected = false;
+            if (!cur->active_.load(std::memory_order_relaxed)
+                && cur->active_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                holder.record_ = cur;
+                return cur;
+            }
+        }
+
+        auto* record = new HazardRecord();
+        record->active_.store(true, std::memory_order_relaxed);
+        record->next_ = records.load(std::memory_order_relaxed);
+        while (!records.compare_exchange_weak(record->next_, record,
+                                              std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        holder.record_ = record;
+        return record;
+    }
+};
+
+CGRAPH_NAMESPACE_END
+
+#endif //CGRAPH_UHAZARDPOINTER_H
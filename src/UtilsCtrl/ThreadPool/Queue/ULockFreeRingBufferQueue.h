@@ -3,14 +3,15 @@
 @Contact: chunel@foxmail.com
 @File: ULockFreeRingBufferQueue.h
 @Time: 2023/10/7 21:35
-@Desc: 
+@Desc: 有界的多入多出无锁环形队列。参考 Vyukov 的实现，每个槽位记录一个序号，用于判断当前槽位是否可读/可写
 ***************************/
 
 #ifndef CGRAPH_ULOCKFREERINGBUFFERQUEUE_H
 #define CGRAPH_ULOCKFREERINGBUFFERQUEUE_H
 
 #include <atomic>
-#include <memory>
+#include <vector>
+#include <cstdint>
 
 #include "UQueueObject.h"
 
@@ -18,32 +19,91 @@ CGRAPH_NAMESPACE_BEGIN
 
 template<typename T, CInt CAPACITY = CGRAPH_DEFAULT_RINGBUFFER_SIZE>
 class ULockFreeRingBufferQueue : public UQueueObject {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of 2");
+
+    struct Slot {
+        std::atomic<CSize> sequence_ {0};               // 槽位序号。等于写入位置表示可写，等于写入位置+1表示可读
+        T value_ {};
+    };
+
 public:
     explicit ULockFreeRingBufferQueue() {
-        head_ = 0;
-        tail_ = 0;
-        ring_buffer_.resize(CAPACITY);
+        for (CSize i = 0; i < (CSize)CAPACITY; i++) {
+            slots_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
     }
 
-    ~ULockFreeRingBufferQueue() override {
-        ring_buffer_.clear();
+    /**
+     * 写入一个任务，队列已满的时候，等待其他线程出队
+     * @param value
+     */
+    CVoid push(T&& value) {
+        while (!tryPush(std::forward<T>(value))) {
+            CGRAPH_YIELD();
+        }
     }
 
     /**
-     * 写入一个任务
+     * 尝试写入一个任务
      * @param value
+     * @return 队列已满的时候，返回false
      */
-    CVoid push(T&& value) {
-        int curTail = tail_.load(std::memory_order_relaxed);
-        int nextTail = (curTail + 1) % CAPACITY;
+    CBool tryPush(T&& value) {
+        CSize pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[pos & MASK];
+            CSize seq = slot->sequence_.load(std::memory_order_acquire);
+            auto diff = (std::intptr_t)seq - (std::intptr_t)pos;
+            if (0 == diff) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;    // 队列已满
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
 
-        while (nextTail == head_.load(std::memory_order_acquire)) {
-            // 队列已满，等待其他线程出队
-            CGRAPH_YIELD();
+        slot->value_ = std::forward<T>(value);
+        slot->sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 尝试批量写入任务，一次 CAS 占据多个连续的槽位
+     * @param values 写入成功的任务，会从 values 中移除
+     * @return 全部写入成功的时候，返回true
+     */
+    CBool tryPush(std::vector<T>& values) {
+        CSize pos = tail_.load(std::memory_order_relaxed);
+        CSize size = 0;
+        while (!values.empty()) {
+            size = 0;
+            while (size < values.size() && size < (CSize)CAPACITY
+                   && slots_[(pos + size) & MASK].sequence_.load(std::memory_order_acquire) == pos + size) {
+                size++;
+            }
+
+            if (0 == size) {
+                CSize seq = slots_[pos & MASK].sequence_.load(std::memory_order_acquire);
+                if ((std::intptr_t)seq - (std::intptr_t)pos < 0) {
+                    return false;    // 队列已满
+                }
+                pos = tail_.load(std::memory_order_relaxed);
+            } else if (tail_.compare_exchange_weak(pos, pos + size, std::memory_order_relaxed)) {
+                break;
+            }
         }
 
-        ring_buffer_[curTail] = std::move(value);
-        tail_.store(nextTail, std::memory_order_release);
+        for (CSize i = 0; i < size; i++) {
+            Slot& slot = slots_[(pos + i) & MASK];
+            slot.value_ = std::move(values[i]);
+            slot.sequence_.store(pos + i + 1, std::memory_order_release);
+        }
+        values.erase(values.begin(), values.begin() + size);
+        return values.empty();
     }
 
     /**
@@ -52,24 +112,188 @@ public:
      * @return
      */
     CBool tryPop(T& value) {
-        int curHead = head_.load(std::memory_order_relaxed);
-        if (curHead == tail_.load(std::memory_order_acquire)) {
-            // 队列已空，直接返回false
-            return false;
+        CSize pos = head_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[pos & MASK];
+            CSize seq = slot->sequence_.load(std::memory_order_acquire);
+            auto diff = (std::intptr_t)seq - (std::intptr_t)(pos + 1);
+            if (0 == diff) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;    // 队列已空
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
         }
 
-        value = std::move(ring_buffer_[curHead]);
+        value = std::move(slot->value_);
+        slot->sequence_.store(pos + MASK + 1, std::memory_order_release);
+        return true;
+    }
 
-        int nextHead = (curHead + 1) % CAPACITY;
-        head_.store(nextHead, std::memory_order_release);
+    /**
+     * 尝试批量弹出任务，一次 CAS 获取多个连续的槽位
+     * @param values
+     * @param maxBatchSize
+     * @return
+     */
+    CBool tryPop(std::vector<T>& values, int maxBatchSize) {
+        CSize pos = head_.load(std::memory_order_relaxed);
+        CSize size = 0;
+        while (maxBatchSize > 0) {
+            size = 0;
+            while (size < (CSize)maxBatchSize && size < (CSize)CAPACITY
+                   && slots_[(pos + size) & MASK].sequence_.load(std::memory_order_acquire) == pos + size + 1) {
+                size++;
+            }
+
+            if (0 == size) {
+                CSize seq = slots_[pos & MASK].sequence_.load(std::memory_order_acquire);
+                if ((std::intptr_t)seq - (std::intptr_t)(pos + 1) < 0) {
+                    return false;    // 队列已空
+                }
+                pos = head_.load(std::memory_order_relaxed);
+            } else if (head_.compare_exchange_weak(pos, pos + size, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (CSize i = 0; i < size; i++) {
+            Slot& slot = slots_[(pos + i) & MASK];
+            values.emplace_back(std::move(slot.value_));
+            slot.sequence_.store(pos + i + MASK + 1, std::memory_order_release);
+        }
+        return size > 0;
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(ULockFreeRingBufferQueue)
+
+private:
+    static const CSize MASK = (CSize)CAPACITY - 1;
+
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<CSize> head_ {0};      // 开始元素（较早写入的）的位置
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<CSize> tail_ {0};      // 尾部的位置
+    alignas(CGRAPH_CACHE_LINE_SIZE) Slot slots_[CAPACITY];             // 环形队列
+};
+
+
+/**
+ * 单入单出的无锁环形队列
+ * 写入线程和读取线程，各自缓存对方的位置信息，仅在缓存信息不足的时候，才去读取对方的原子变量，从而降低缓存同步的开销
+ */
+template<typename T, CInt CAPACITY = CGRAPH_DEFAULT_RINGBUFFER_SIZE>
+class ULockFreeSpscRingBufferQueue : public UQueueObject {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of 2");
+
+public:
+    explicit ULockFreeSpscRingBufferQueue() = default;
+
+    /**
+     * 写入一个任务，队列已满的时候，等待读取线程出队
+     * @param value
+     * @notice 仅允许一个写入线程调用
+     */
+    CVoid push(T&& value) {
+        while (!tryPush(std::forward<T>(value))) {
+            CGRAPH_YIELD();
+        }
+    }
+
+    /**
+     * 尝试写入一个任务
+     * @param value
+     * @return
+     * @notice 仅允许一个写入线程调用
+     */
+    CBool tryPush(T&& value) {
+        CSize tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ >= (CSize)CAPACITY) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ >= (CSize)CAPACITY) {
+                return false;
+            }
+        }
+
+        slots_[tail & MASK] = std::forward<T>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 尝试批量写入任务
+     * @param values 写入成功的任务，会从 values 中移除
+     * @return 全部写入成功的时候，返回true
+     * @notice 仅允许一个写入线程调用
+     */
+    CBool tryPush(std::vector<T>& values) {
+        CSize tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ + values.size() > (CSize)CAPACITY) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+
+        CSize size = (std::min)(values.size(), (CSize)CAPACITY - (tail - cached_head_));
+        for (CSize i = 0; i < size; i++) {
+            slots_[(tail + i) & MASK] = std::move(values[i]);
+        }
+        tail_.store(tail + size, std::memory_order_release);
+        values.erase(values.begin(), values.begin() + size);
+        return values.empty();
+    }
+
+    /**
+     * 尝试弹出一个任务
+     * @param value
+     * @return
+     * @notice 仅允许一个读取线程调用
+     */
+    CBool tryPop(T& value) {
+        CSize head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+
+        value = std::move(slots_[head & MASK]);
+        head_.store(head + 1, std::memory_order_release);
         return true;
     }
 
+    /**
+     * 尝试批量弹出任务
+     * @param values
+     * @param maxBatchSize
+     * @return
+     * @notice 仅允许一个读取线程调用
+     */
+    CBool tryPop(std::vector<T>& values, int maxBatchSize) {
+        CSize head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < (CSize)maxBatchSize) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+
+        CSize size = (std::min)((CSize)maxBatchSize, cached_tail_ - head);
+        for (CSize i = 0; i < size; i++) {
+            values.emplace_back(std::move(slots_[(head + i) & MASK]));
+        }
+        head_.store(head + size, std::memory_order_release);
+        return size > 0;
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(ULockFreeSpscRingBufferQueue)
 
 private:
-    std::atomic<CInt> head_;                                // 开始元素（较早写入的）的位置
-    std::atomic<CInt> tail_;                                // 尾部的位置
-    std::vector<std::unique_ptr<T> > ring_buffer_;          // 环形队列
+    static const CSize MASK = (CSize)CAPACITY - 1;
+
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<CSize> head_ {0};      // 读取位置，仅读取线程写入
+    CSize cached_tail_ = 0;                                            // 读取线程缓存的写入位置
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<CSize> tail_ {0};      // 写入位置，仅写入线程写入
+    CSize cached_head_ = 0;                                            // 写入线程缓存的读取位置
+    alignas(CGRAPH_CACHE_LINE_SIZE) T slots_[CAPACITY];                // 环形队列
 };
 
 CGRAPH_NAMESPACE_END
@@ -0,0 +1,363 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: ULockFreeSegmentQueue.h
+@Time: 2026/10/17 22:45
+@Desc: 无界的多入多出无锁队列。由多个固定大小的段(segment)串联而成，任务按值存放在段的槽位中
+ * 1. 写入线程通过 fetch_add 在尾部段中占位，段写满后追加新的段
+ * 2. 读取线程通过 CAS 在头部段中占位，段读完后后移，旧段通过 hazard pointer 安全回收并复用
+ * 3. popWithTimeout 在无锁操作的基础上，增加了阻塞等待的能力
+***************************/
+
+#ifndef CGRAPH_ULOCKFREESEGMENTQUEUE_H
+#define CGRAPH_ULOCKFREESEGMENTQUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "UQueueObject.h"
+#include "UHazardPointer.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+template<typename T, CSize SEGMENT_SIZE = CGRAPH_DEFAULT_SEGMENT_SIZE>
+class ULockFreeSegmentQueue : public UQueueObject {
+    struct Slot {
+        std::atomic<CBool> ready_ {false};                  // 写入线程是否已经写完
+        T value_ {};
+    };
+
+    struct Segment {
+        std::atomic<CSize> enqueue_index_ {0};              // 写入占位的位置，可能超过 SEGMENT_SIZE
+        std::atomic<CSize> dequeue_index_ {0};              // 读取占位的位置
+        std::atomic<Segment *> next_ {nullptr};             // 下一个段
+        Slot slots_[SEGMENT_SIZE];
+
+        /**
+         * 复用之前，恢复初始状态
+         */
+        CVoid reset() {
+            for (auto& slot : slots_) {
+                slot.ready_.store(false, std::memory_order_relaxed);
+            }
+            enqueue_index_.store(0, std::memory_order_relaxed);
+            dequeue_index_.store(0, std::memory_order_relaxed);
+            next_.store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+public:
+    explicit ULockFreeSegmentQueue() {
+        auto* seg = new Segment();
+        head_.store(seg, std::memory_order_relaxed);
+        tail_.store(seg, std::memory_order_relaxed);
+    }
+
+    ~ULockFreeSegmentQueue() override {
+        Segment* seg = head_.load(std::memory_order_relaxed);
+        while (seg) {
+            Segment* next = seg->next_.load(std::memory_order_relaxed);
+            delete seg;
+            seg = next;
+        }
+
+        for (auto* cur : retired_segments_) {
+            delete cur;
+        }
+        for (auto* cur : free_segments_) {
+            delete cur;
+        }
+    }
+
+    /**
+     * 传入数据
+     * @param value
+     */
+    CVoid push(T&& value) {
+        pushValue(std::forward<T>(value));
+        wakeupWaiter(1);
+    }
+
+
+    /**
+     * 批量传入数据，并且按照任务个数唤醒等待的线程
+     * @tparam Iterator
+     * @param begin
+     * @param end
+     * @notice [begin, end) 中的内容，会被 move 到队列中
+     */
+    template<typename Iterator>
+    CVoid pushBulk(Iterator begin, Iterator end) {
+        CSize size = 0;
+        for (auto iter = begin; iter != end; ++iter, ++size) {
+            pushValue(std::move(*iter));
+        }
+        wakeupWaiter(size);
+    }
+
+
+    /**
+     * 尝试弹出
+     * @param value
+     * @return
+     */
+    CBool tryPop(T& value) {
+        CBool result = false;
+        while (true) {
+            Segment* seg = UHazardPointer::protect(head_);
+            CSize dequeueIndex = seg->dequeue_index_.load(std::memory_order_acquire);
+            if (likely(dequeueIndex < SEGMENT_SIZE)) {
+                CSize enqueueIndex = (std::min)(seg->enqueue_index_.load(std::memory_order_acquire), SEGMENT_SIZE);
+                if (dequeueIndex >= enqueueIndex) {
+                    break;    // 队列为空
+                }
+
+                if (!seg->dequeue_index_.compare_exchange_weak(dequeueIndex, dequeueIndex + 1,
+                                                               std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    continue;
+                }
+
+                // 写入线程已经占位，但可能还没有写完，稍加等待即可
+                Slot& slot = seg->slots_[dequeueIndex];
+                while (!slot.ready_.load(std::memory_order_acquire)) {
+                    CGRAPH_YIELD();
+                }
+                value = std::move(slot.value_);
+                result = true;
+                break;
+            }
+
+            // 当前段已经读完了。如果有下一个段，则后移 head，并回收当前段
+            Segment* next = seg->next_.load(std::memory_order_acquire);
+            if (nullptr == next) {
+                break;
+            }
+
+            Segment* tail = seg;
+            tail_.compare_exchange_strong(tail, next, std::memory_order_acq_rel, std::memory_order_relaxed);    // 确保 tail 不会落后于 head
+            if (head_.compare_exchange_strong(seg, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                UHazardPointer::clear();
+                retireSegment(seg);
+            }
+        }
+
+        UHazardPointer::clear();
+        return result;
+    }
+
+
+    /**
+     * 尝试弹出多个任务
+     * @param values
+     * @param maxPoolBatchSize
+     * @return
+     */
+    CBool tryPop(std::vector<T>& values, int maxPoolBatchSize) {
+        CBool result = false;
+        T value;
+        while (maxPoolBatchSize-- > 0 && tryPop(value)) {
+            values.emplace_back(std::move(value));
+            result = true;
+        }
+        return result;
+    }
+
+
+    /**
+     * 阻塞式等待弹出
+     * @param value
+     * @param ms
+     * @return
+     */
+    CBool popWithTimeout(T& value, CMSec ms) {
+        if (tryPop(value)) {
+            return true;
+        }
+
+        CBool result = false;
+        CGRAPH_UNIQUE_LOCK lk(mutex_);
+        waiter_num_.fetch_add(1, std::memory_order_seq_cst);
+        cv_.wait_for(lk, std::chrono::milliseconds(ms), [this, &value, &result] {
+            result = ready_flag_.load(std::memory_order_acquire) && tryPop(value);
+            return result || !ready_flag_.load(std::memory_order_acquire);
+        });
+        waiter_num_.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+
+    /**
+     * 判定队列是否为空
+     * @return
+     */
+    CBool empty() {
+        Segment* seg = UHazardPointer::protect(head_);
+        CSize dequeueIndex = seg->dequeue_index_.load(std::memory_order_acquire);
+        CSize enqueueIndex = (std::min)(seg->enqueue_index_.load(std::memory_order_acquire), SEGMENT_SIZE);
+        CBool result = dequeueIndex >= enqueueIndex && nullptr == seg->next_.load(std::memory_order_acquire);
+        UHazardPointer::clear();
+        return result;
+    }
+
+
+    /**
+     * 获取队列中任务的大致个数。持有 segment_mutex_ 的时候，读完的段不会被复用，可以安全的遍历
+     * @return
+     * @notice 需要加锁遍历所有的段，仅用于统计信息
+     */
+    CSize size() {
+        CGRAPH_LOCK_GUARD lk(segment_mutex_);
+        CSize result = 0;
+        for (Segment* seg = head_.load(std::memory_order_acquire); seg; seg = seg->next_.load(std::memory_order_acquire)) {
+            CSize enqueueIndex = (std::min)(seg->enqueue_index_.load(std::memory_order_acquire), SEGMENT_SIZE);
+            CSize dequeueIndex = (std::min)(seg->dequeue_index_.load(std::memory_order_acquire), SEGMENT_SIZE);
+            result += enqueueIndex > dequeueIndex ? enqueueIndex - dequeueIndex : 0;
+        }
+        return result;
+    }
+
+
+    /**
+     * 功能是通知所有的辅助线程停止工作
+     * @return
+     */
+    CVoid reset() {
+        ready_flag_.store(false, std::memory_order_release);
+        CGRAPH_LOCK_GUARD lk(mutex_);
+        cv_.notify_all();
+    }
+
+
+    /**
+     * 初始化状态，并清空剩余任务
+     * @return
+     */
+    CVoid setup() {
+        ready_flag_.store(true, std::memory_order_release);
+        T value;
+        while (tryPop(value)) {
+        }
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(ULockFreeSegmentQueue)
+
+private:
+    /**
+     * 写入数据，不唤醒等待的线程
+     * @param value
+     */
+    CVoid pushValue(T&& value) {
+        while (true) {
+            Segment* seg = UHazardPointer::protect(tail_);
+            CSize index = seg->enqueue_index_.fetch_add(1, std::memory_order_acq_rel);
+            if (likely(index < SEGMENT_SIZE)) {
+                Slot& slot = seg->slots_[index];
+                slot.value_ = std::forward<T>(value);
+                slot.ready_.store(true, std::memory_order_release);
+                UHazardPointer::clear();
+                break;
+            }
+
+            // 当前段已经写满了，则追加一个新的段，并且后移 tail
+            Segment* next = seg->next_.load(std::memory_order_acquire);
+            if (nullptr == next) {
+                Segment* fresh = obtainSegment();
+                if (seg->next_.compare_exchange_strong(next, fresh,
+                                                       std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    next = fresh;
+                } else {
+                    releaseSegment(fresh);
+                }
+            }
+            tail_.compare_exchange_strong(seg, next, std::memory_order_acq_rel, std::memory_order_relaxed);
+            UHazardPointer::clear();
+        }
+    }
+
+
+    /**
+     * 如果有等待中的线程，则最多唤醒 size 个。没有等待线程的时候，仅有一次原子读的开销
+     * @param size
+     */
+    CVoid wakeupWaiter(CSize size) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        CInt waiterNum = waiter_num_.load(std::memory_order_relaxed);
+        if (waiterNum > 0 && size > 0) {
+            CGRAPH_LOCK_GUARD lk(mutex_);
+            if (size >= (CSize)waiterNum) {
+                cv_.notify_all();
+            } else {
+                while (size-- > 0) {
+                    cv_.notify_one();
+                }
+            }
+        }
+    }
+
+
+    /**
+     * 获取一个新的段，优先复用已回收的段
+     * @return
+     */
+    Segment* obtainSegment() {
+        Segment* seg = nullptr;
+        {
+            CGRAPH_LOCK_GUARD lk(segment_mutex_);
+            if (!free_segments_.empty()) {
+                seg = free_segments_.back();
+                free_segments_.pop_back();
+            }
+        }
+
+        if (seg) {
+            seg->reset();
+        } else {
+            seg = new Segment();
+        }
+        return seg;
+    }
+
+
+    /**
+     * 归还未被使用过的段
+     * @param seg
+     */
+    CVoid releaseSegment(Segment* seg) {
+        CGRAPH_LOCK_GUARD lk(segment_mutex_);
+        free_segments_.push_back(seg);
+    }
+
+
+    /**
+     * 回收已经读完的段。没有被任何线程访问的段，可以被再次复用
+     * @param seg
+     */
+    CVoid retireSegment(Segment* seg) {
+        CGRAPH_LOCK_GUARD lk(segment_mutex_);
+        retired_segments_.push_back(seg);
+        for (auto iter = retired_segments_.begin(); iter != retired_segments_.end(); ) {
+            if (!UHazardPointer::isHazard(*iter)) {
+                free_segments_.push_back(*iter);
+                iter = retired_segments_.erase(iter);
+            } else {
+                iter++;
+            }
+        }
+    }
+
+private:
+    std::atomic<Segment *> head_ {nullptr};                 // 读取的段
+    std::atomic<Segment *> tail_ {nullptr};                 // 写入的段
+    std::atomic<CInt> waiter_num_ {0};                      // 阻塞等待中的线程个数
+    std::atomic<CBool> ready_flag_ {true};                  // 执行标记，主要用于快速释放 destroy 逻辑中，多个辅助线程等待的状态
+
+    std::mutex segment_mutex_;                              // 回收和复用段的时候加锁，每 SEGMENT_SIZE 次写入才会触发一次
+    std::vector<Segment *> retired_segments_;               // 已读完，但可能还在被其他线程访问的段
+    std::vector<Segment *> free_segments_;                  // 可以被复用的段
+};
+
+CGRAPH_NAMESPACE_END
+
+#endif //CGRAPH_ULOCKFREESEGMENTQUEUE_H
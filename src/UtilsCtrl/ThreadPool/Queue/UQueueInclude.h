@@ -14,5 +14,19 @@
 #include "UAtomicPriorityQueue.h"
 #include "UAtomicRingBufferQueue.h"
 #include "ULockFreeRingBufferQueue.h"
+#include "ULockFreeSegmentQueue.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+/** 线程池中通用任务队列的类型。开启 _CGRAPH_LOCKFREE_POOL_QUEUE_ENABLE_ 后，使用无锁的分段队列 */
+    #ifdef _CGRAPH_LOCKFREE_POOL_QUEUE_ENABLE_
+template<typename T>
+using UPoolTaskQueue = ULockFreeSegmentQueue<T>;
+    #else
+template<typename T>
+using UPoolTaskQueue = UAtomicQueue<T>;
+    #endif
+
+CGRAPH_NAMESPACE_END
 
 #endif //CGRAPH_UQUEUEINCLUDE_H
@@ -4,13 +4,19 @@
 @File: UWorkStealingQueue.h
 @Time: 2021/7/2 11:29 下午
 @Desc: 实现了一个包含盗取功能的安全队列
+ * 内部为 Chase-Lev 无锁双端队列（参考 Lê et al. 2013 的 C11 内存序版本）：
+ * 1. 持有线程(owner)在底部(bottom)写入和弹出，通常情况下不需要原子的 RMW 操作
+ * 2. 盗取线程在顶部(top)通过 CAS 获取任务
+ * 3. 非持有线程写入的任务，先放入 inbox 中，由持有线程批量转移到双端队列中
 ***************************/
 
 
 #ifndef CGRAPH_UWORKSTEALINGQUEUE_H
 #define CGRAPH_UWORKSTEALINGQUEUE_H
 
-#include <deque>
+#include <atomic>
+#include <vector>
+#include <cstdint>
 
 #include "UQueueObject.h"
 
@@ -18,7 +24,84 @@ CGRAPH_NAMESPACE_BEGIN
 
 template<typename T>
 class UWorkStealingQueue : public UQueueObject {
+    /**
+     * 任务节点，从持有线程的缓存中获取，被盗取后再归还回来
+     */
+    struct TaskNode {
+        T value_ {};
+        TaskNode* next_ = nullptr;
+    };
+
+    /**
+     * 环形数组，容量为2的幂次。扩容后，旧数组保留至队列析构，保证盗取线程的访问安全
+     */
+    struct TaskArray {
+        explicit TaskArray(std::int64_t capacity) {
+            capacity_ = capacity;
+            slots_ = new std::atomic<TaskNode *>[capacity];
+        }
+
+        ~TaskArray() {
+            CGRAPH_DELETE_PTR_ARRAY(slots_)
+        }
+
+        TaskNode* get(std::int64_t index) const {
+            return slots_[index & (capacity_ - 1)].load(std::memory_order_relaxed);
+        }
+
+        CVoid put(std::int64_t index, TaskNode* node) {
+            slots_[index & (capacity_ - 1)].store(node, std::memory_order_relaxed);
+        }
+
+        std::int64_t capacity_ = 0;
+        std::atomic<TaskNode *>* slots_ = nullptr;
+    };
+
 public:
+    explicit UWorkStealingQueue(std::int64_t capacity = CGRAPH_DEFAULT_WORK_STEALING_CAPACITY) {
+        std::int64_t realCapacity = 1;
+        while (realCapacity < capacity) {
+            realCapacity <<= 1;
+        }
+        array_.store(new TaskArray(realCapacity), std::memory_order_relaxed);
+    }
+
+    ~UWorkStealingQueue() override {
+        TaskNode* node = nullptr;
+        while (nullptr != (node = takeBottom())) {
+            delete node;
+        }
+        releaseNodes(free_nodes_);
+        releaseNodes(returned_nodes_.exchange(nullptr, std::memory_order_acquire));
+
+        for (auto* arr : retired_arrays_) {
+            delete arr;
+        }
+        delete array_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 预留空间。空闲节点和 inbox 的容量不少于 size，任务个数不超过 size 的时候，写入和弹出都不再申请内存
+     * @param size
+     * @notice 仅允许在持有线程开始执行之前调用
+     */
+    CVoid reserve(CSize size) {
+        {
+            CGRAPH_LOCK_GUARD lk(mutex_);
+            inbox_.reserve(size);
+        }
+        drain_buffer_.reserve(size);
+
+        CSize cur = 0;
+        for (TaskNode* node = free_nodes_; nullptr != node; node = node->next_) {
+            cur++;
+        }
+        for (; cur < size; cur++) {
+            recycleNode(new TaskNode());
+        }
+    }
+
+
     /**
      * 向队列中写入信息
      * @param value
@@ -26,7 +109,7 @@ public:
     CVoid push(T&& value) {
         while (true) {
             if (mutex_.try_lock()) {
-                deque_.emplace_back(std::forward<T>(value));
+                pushInbox(std::forward<T>(value));
                 mutex_.unlock();
                 break;
             } else {
@@ -47,7 +130,7 @@ public:
         if (enable && lockable) {
             mutex_.lock();
         }
-        deque_.emplace_back(std::forward<T>(value));
+        pushInbox(std::forward<T>(value));
         if (enable && !lockable) {
             mutex_.unlock();
         }
@@ -62,7 +145,7 @@ public:
     CBool tryPush(T&& value) {
         CBool result = false;
         if (mutex_.try_lock()) {
-            deque_.emplace_back(std::forward<T>(value));
+            pushInbox(std::forward<T>(value));
             mutex_.unlock();
             result = true;
         }
@@ -78,8 +161,33 @@ public:
         while (true) {
             if (mutex_.try_lock()) {
                 for (auto& value : values) {
-                    deque_.emplace_back(value);
+                    inbox_.emplace_back(value);
+                }
+                inbox_size_.store(inbox_.size(), std::memory_order_release);
+                mutex_.unlock();
+                break;
+            } else {
+                CGRAPH_YIELD();
+            }
+        }
+    }
+
+
+    /**
+     * 批量写入信息，仅加锁一次
+     * @tparam Iterator
+     * @param begin
+     * @param end
+     * @notice [begin, end) 中的内容，会被 move 到队列中
+     */
+    template<typename Iterator>
+    CVoid pushBulk(Iterator begin, Iterator end) {
+        while (true) {
+            if (mutex_.try_lock()) {
+                for (auto iter = begin; iter != end; ++iter) {
+                    inbox_.emplace_back(std::move(*iter));
                 }
+                inbox_size_.store(inbox_.size(), std::memory_order_release);
                 mutex_.unlock();
                 break;
             } else {
@@ -90,41 +198,57 @@ public:
 
 
     /**
-     * 弹出节点，从头部进行
+     * 持有线程直接写入双端队列的底部，无锁
+     * @param value
+     * @notice 仅允许持有当前队列的线程调用
+     */
+    CVoid pushLocal(T&& value) {
+        TaskNode* node = obtainNode();
+        node->value_ = std::forward<T>(value);
+        putBottom(node);
+    }
+
+
+    /**
+     * 弹出节点，从底部进行
      * @param value
      * @return
+     * @notice 仅允许持有当前队列的线程调用
      */
     CBool tryPop(T& value) {
-        // 这里不使用raii锁，主要是考虑到多线程的情况下，可能会重复进入
-        bool result = false;
-        if (!deque_.empty() && mutex_.try_lock()) {
-            if (!deque_.empty()) {
-                value = std::forward<T>(deque_.front());    // 从前方弹出
-                deque_.pop_front();
-                result = true;
-            }
-            mutex_.unlock();
+        TaskNode* node = takeBottom();
+        if (nullptr == node && drainInbox()) {
+            node = takeBottom();
         }
 
-        return result;
+        if (nullptr == node) {
+            return false;
+        }
+
+        value = std::move(node->value_);
+        recycleNode(node);
+        return true;
     }
 
 
     /**
-     * 从头部开始批量获取可执行任务信息
+     * 从底部开始批量获取可执行任务信息
      * @param values
      * @param maxLocalBatchSize
      * @return
+     * @notice 仅允许持有当前队列的线程调用
      */
     CBool tryPop(std::vector<T>& values, int maxLocalBatchSize) {
         bool result = false;
-        if (!deque_.empty() && mutex_.try_lock()) {
-            while (!deque_.empty() && maxLocalBatchSize--) {
-                values.emplace_back(std::forward<T>(deque_.front()));
-                deque_.pop_front();
-                result = true;
-            }
-            mutex_.unlock();
+        if (isDequeEmpty()) {
+            drainInbox();
+        }
+
+        TaskNode* node = nullptr;
+        while (maxLocalBatchSize-- > 0 && nullptr != (node = takeBottom())) {
+            values.emplace_back(std::move(node->value_));
+            recycleNode(node);
+            result = true;
         }
 
         return result;
@@ -132,50 +256,363 @@ public:
 
 
     /**
-     * 窃取节点，从尾部进行
-     * @param task
+     * 优先弹出其他线程写入 inbox 中的任务
+     * 本地任务持续不断（如递归提交）的时候，用于保证外部写入的任务也可以被执行
+     * @param value
+     * @return
+     * @notice 仅允许持有当前队列的线程调用
+     */
+    CBool tryPopExternal(T& value) {
+        if (!drainInbox()) {
+            return false;
+        }
+
+        TaskNode* node = takeBottom();    // inbox 中最早写入的任务，被放在了最底部
+        if (nullptr == node) {
+            return false;
+        }
+
+        value = std::move(node->value_);
+        recycleNode(node);
+        return true;
+    }
+
+
+    /**
+     * 窃取节点，从顶部进行
+     * @param value
      * @return
      */
     CBool trySteal(T& value) {
+        TaskNode* node = stealTop();
+        if (nullptr != node) {
+            value = std::move(node->value_);
+            returnNode(node);
+            return true;
+        }
+
+        return stealInbox(value);
+    }
+
+
+    /**
+     * 批量窃取节点，从顶部进行
+     * @param values
+     * @return
+     */
+    CBool trySteal(std::vector<T>& values, int maxStealBatchSize) {
         bool result = false;
-        if (!deque_.empty() && mutex_.try_lock()) {
-            if (!deque_.empty()) {
-                value = std::forward<T>(deque_.back());    // 从后方窃取
-                deque_.pop_back();
+        TaskNode* node = nullptr;
+        while (maxStealBatchSize > 0 && nullptr != (node = stealTop())) {
+            values.emplace_back(std::move(node->value_));
+            returnNode(node);
+            maxStealBatchSize--;
+            result = true;
+        }
+
+        if (!result) {
+            T value;
+            if (stealInbox(value)) {
+                values.emplace_back(std::move(value));
                 result = true;
             }
-            mutex_.unlock();
         }
 
-        return result;
+        return result;    // 如果非空，表示盗取成功
     }
 
 
     /**
-     * 批量窃取节点，从尾部进行
+     * 一次盗取队列中大约一半的任务，从顶部进行。双端队列为空的时候，盗取 inbox 中一半的任务
+     * 每个节点仍然通过单独的 CAS 获取，保证和持有线程的无锁弹出之间的正确性。被抢先的时候，提前结束
      * @param values
      * @return
      */
-    CBool trySteal(std::vector<T>& values, int maxStealBatchSize) {
+    CBool tryStealHalf(std::vector<T>& values) {
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t half = (bottom - top + 1) / 2;
+
         bool result = false;
-        if (!deque_.empty() && mutex_.try_lock()) {
-            while (!deque_.empty() && maxStealBatchSize--) {
-                values.emplace_back(std::forward<T>(deque_.back()));
-                deque_.pop_back();
+        TaskNode* node = nullptr;
+        while (half > 0 && nullptr != (node = stealTop())) {
+            values.emplace_back(std::move(node->value_));
+            returnNode(node);
+            half--;
+            result = true;
+        }
+
+        if (!result) {
+            result = stealInboxHalf(values);
+        }
+        return result;
+    }
+
+
+    /**
+     * 获取队列中任务的大致数量
+     * @return
+     */
+    CSize size() const {
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        CSize dequeSize = bottom > top ? (CSize)(bottom - top) : 0;
+        return dequeSize + inbox_size_.load(std::memory_order_relaxed);
+    }
+
+
+    /**
+     * 判断队列是否（大致）为空
+     * @return
+     */
+    CBool empty() const {
+        return 0 == size();
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(UWorkStealingQueue)
+
+private:
+    /**
+     * 写入 inbox 中，需要在 mutex_ 保护下调用
+     * @param value
+     */
+    CVoid pushInbox(T&& value) {
+        inbox_.emplace_back(std::forward<T>(value));
+        inbox_size_.store(inbox_.size(), std::memory_order_release);
+    }
+
+
+    /**
+     * 将 inbox 中的任务，批量转移到双端队列中
+     * 逆序写入，保证持有线程优先弹出较早写入的任务，与盗取线程的方向相反
+     * @return
+     */
+    CBool drainInbox() {
+        if (0 == inbox_size_.load(std::memory_order_acquire) || !mutex_.try_lock()) {
+            return false;
+        }
+
+        drain_buffer_.swap(inbox_);    // 交换之后，两个 vector 的容量都得以保留，稳定状态下不再申请内存
+        inbox_size_.store(0, std::memory_order_relaxed);
+        mutex_.unlock();
+
+        for (auto iter = drain_buffer_.rbegin(); iter != drain_buffer_.rend(); ++iter) {
+            pushLocal(std::move(*iter));
+        }
+        CBool result = !drain_buffer_.empty();
+        drain_buffer_.clear();
+        return result;
+    }
+
+
+    /**
+     * 从 inbox 中盗取最新写入的任务
+     * @param value
+     * @return
+     */
+    CBool stealInbox(T& value) {
+        CBool result = false;
+        if (inbox_size_.load(std::memory_order_acquire) > 0 && mutex_.try_lock()) {
+            if (!inbox_.empty()) {
+                value = std::move(inbox_.back());
+                inbox_.pop_back();
+                inbox_size_.store(inbox_.size(), std::memory_order_release);
+                result = true;
+            }
+            mutex_.unlock();
+        }
+        return result;
+    }
+
+
+    /**
+     * 从 inbox 中盗取一半（向上取整）最新写入的任务
+     * @param values
+     * @return
+     */
+    CBool stealInboxHalf(std::vector<T>& values) {
+        CBool result = false;
+        if (inbox_size_.load(std::memory_order_acquire) > 0 && mutex_.try_lock()) {
+            CSize half = (inbox_.size() + 1) / 2;
+            while (half-- > 0) {
+                values.emplace_back(std::move(inbox_.back()));
+                inbox_.pop_back();
                 result = true;
             }
+            inbox_size_.store(inbox_.size(), std::memory_order_release);
             mutex_.unlock();
         }
+        return result;
+    }
+
+
+    /**
+     * 持有线程，在底部写入节点
+     * @param node
+     */
+    CVoid putBottom(TaskNode* node) {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        TaskArray* arr = array_.load(std::memory_order_relaxed);
+        if (bottom - top > arr->capacity_ - 1) {
+            arr = grow(arr, top, bottom);
+        }
 
-        return result;    // 如果非空，表示盗取成功
+        arr->put(bottom, node);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
     }
 
-    UWorkStealingQueue() = default;
 
-    CGRAPH_NO_ALLOWED_COPY(UWorkStealingQueue)
+    /**
+     * 持有线程，从底部获取节点。只有在竞争最后一个节点的时候，才需要 CAS
+     * @return
+     */
+    TaskNode* takeBottom() {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        TaskArray* arr = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+
+        TaskNode* node = nullptr;
+        if (top <= bottom) {
+            node = arr->get(bottom);
+            if (top == bottom) {
+                // 仅剩最后一个节点的时候，和盗取线程进行竞争
+                if (!top_.compare_exchange_strong(top, top + 1,
+                                                  std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    node = nullptr;
+                }
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+            }
+        } else {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return node;
+    }
+
+
+    /**
+     * 盗取线程，从顶部获取节点
+     * @return
+     */
+    TaskNode* stealTop() {
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        TaskNode* node = nullptr;
+        if (top < bottom) {
+            TaskArray* arr = array_.load(std::memory_order_acquire);
+            node = arr->get(top);
+            if (!top_.compare_exchange_strong(top, top + 1,
+                                              std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                node = nullptr;    // 被其他线程抢先了，本次盗取失败
+            }
+        }
+
+        return node;
+    }
+
+
+    /**
+     * 扩容，仅持有线程调用
+     * @param arr
+     * @param top
+     * @param bottom
+     * @return
+     */
+    TaskArray* grow(TaskArray* arr, std::int64_t top, std::int64_t bottom) {
+        auto* bigger = new TaskArray(arr->capacity_ * 2);
+        for (std::int64_t i = top; i < bottom; i++) {
+            bigger->put(i, arr->get(i));
+        }
+        retired_arrays_.push_back(arr);
+        array_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+
+    /**
+     * 获取一个空闲节点，优先使用本地缓存，其次使用被盗取后归还的节点
+     * @return
+     */
+    TaskNode* obtainNode() {
+        if (nullptr == free_nodes_) {
+            free_nodes_ = returned_nodes_.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        TaskNode* node = free_nodes_;
+        if (nullptr != node) {
+            free_nodes_ = node->next_;
+        } else {
+            node = new TaskNode();
+        }
+        return node;
+    }
+
+
+    /**
+     * 持有线程回收节点
+     * @param node
+     */
+    CVoid recycleNode(TaskNode* node) {
+        node->next_ = free_nodes_;
+        free_nodes_ = node;
+    }
+
+
+    /**
+     * 盗取线程归还节点
+     * @param node
+     */
+    CVoid returnNode(TaskNode* node) {
+        node->next_ = returned_nodes_.load(std::memory_order_relaxed);
+        while (!returned_nodes_.compare_exchange_weak(node->next_, node,
+                                                      std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+
+    /**
+     * 释放链表中的所有节点
+     * @param head
+     */
+    static CVoid releaseNodes(TaskNode* head) {
+        while (head) {
+            TaskNode* next = head->next_;
+            delete head;
+            head = next;
+        }
+    }
+
+
+    /**
+     * 双端队列部分，是否为空
+     * @return
+     */
+    CBool isDequeEmpty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
 
 private:
-    std::deque<T> deque_;            // 存放任务的双向队列
+    /**
+     * 按照写入的线程，分别放在不同的缓存行中：
+     * inbox 和 mutex_ 一起，由其他写入线程修改；top 由盗取线程修改；bottom 和本地缓存，由持有线程修改
+     */
+    std::vector<T> inbox_;                                  // 非持有线程写入的任务，由 mutex_ 保护
+    std::atomic<CSize> inbox_size_ {0};                     // inbox 中任务的个数，用于无锁判空
+
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<std::int64_t> top_ {0};    // 盗取线程获取的位置
+    std::atomic<TaskNode *> returned_nodes_ {nullptr};      // 盗取线程归还的空闲节点
+
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<std::int64_t> bottom_ {0};    // 持有线程写入和弹出的位置
+    std::atomic<TaskArray *> array_ {nullptr};              // 当前使用的环形数组
+    std::vector<TaskArray *> retired_arrays_;               // 扩容后的旧数组，队列析构时释放
+    TaskNode* free_nodes_ = nullptr;                        // 持有线程本地的空闲节点
+    std::vector<T> drain_buffer_;                           // 持有线程转移 inbox 时使用的缓存
 };
 
 CGRAPH_NAMESPACE_END
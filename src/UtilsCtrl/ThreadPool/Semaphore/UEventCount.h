@@ -0,0 +1,161 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: UEventCount.h
+@Time: 2026/10/18 15:10
+@Desc: 事件计数器(eventcount)，用于线程的休眠和唤醒
+ * 等待线程：prepareWait() -> 再次检查条件 -> 条件满足则 cancelWait()，否则 commitWait()
+ * 通知线程：修改条件 -> notify()
+ * 没有等待线程的时候，notify() 仅有一次原子读的开销；并且不会出现唤醒丢失的情况
+ * linux 系统中，基于 futex 实现；其他系统中，基于 mutex + condition_variable 实现
+***************************/
+
+#ifndef CGRAPH_UEVENTCOUNT_H
+#define CGRAPH_UEVENTCOUNT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+
+    #ifdef __linux__
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+    #endif
+
+#include "../UThreadObject.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+class UEventCount : public UThreadObject {
+    static const std::uint64_t WAITER_INC = 1;                          // 低32位，记录等待线程的个数
+    static const std::uint64_t WAITER_MASK = 0xFFFFFFFFULL;
+    static const std::uint64_t EPOCH_INC = 1ULL << 32;                  // 高32位，记录通知的轮次
+    static const CInt EPOCH_SHIFT = 32;
+
+public:
+    using Key = std::uint32_t;
+
+    /**
+     * 准备进入等待。调用之后，需要再次检查等待条件
+     * @return 当前的轮次信息，用于 commitWait
+     */
+    Key prepareWait() {
+        std::uint64_t prev = value_.fetch_add(WAITER_INC, std::memory_order_seq_cst);
+        return (Key)(prev >> EPOCH_SHIFT);
+    }
+
+    /**
+     * 条件已经满足，取消等待
+     */
+    CVoid cancelWait() {
+        value_.fetch_sub(WAITER_INC, std::memory_order_seq_cst);
+    }
+
+    /**
+     * 进入等待，直到 prepareWait 之后有通知，或者超时
+     * @param key
+     * @param ms
+     * @return 被通知的时候，返回true；超时返回false
+     */
+    CBool commitWait(Key key, CMSec ms) {
+        CBool result = true;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        while (key == (Key)(value_.load(std::memory_order_acquire) >> EPOCH_SHIFT)) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) {
+                result = false;
+                break;
+            }
+            sleep(key, left);
+        }
+
+        value_.fetch_sub(WAITER_INC, std::memory_order_seq_cst);
+        return result;
+    }
+
+    /**
+     * 唤醒一个等待的线程
+     * @return 有等待线程的时候，返回true
+     */
+    CBool notify() {
+        return wake(false);
+    }
+
+    /**
+     * 唤醒所有等待的线程
+     * @return 有等待线程的时候，返回true
+     */
+    CBool notifyAll() {
+        return wake(true);
+    }
+
+private:
+    /**
+     * 通知。没有等待线程的时候，直接返回
+     * @param all
+     * @return
+     */
+    CBool wake(CBool all) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);    // 保证条件的修改，对 prepareWait 之后的检查可见
+        if (0 == (value_.load(std::memory_order_relaxed) & WAITER_MASK)) {
+            return false;
+        }
+
+        value_.fetch_add(EPOCH_INC, std::memory_order_acq_rel);
+    #ifdef __linux__
+        syscall(SYS_futex, epochAddr(), FUTEX_WAKE_PRIVATE, all ? INT32_MAX : 1, nullptr, nullptr, 0);
+    #else
+        {
+            CGRAPH_LOCK_GUARD lk(mutex_);    // 防止等待线程在检查轮次和进入等待之间，错过通知
+        }
+        all ? cv_.notify_all() : cv_.notify_one();
+    #endif
+        return true;
+    }
+
+    /**
+     * 轮次信息发生变化之前，进入休眠
+     * @param key
+     * @param ms
+     */
+    CVoid sleep(Key key, CMSec ms) {
+    #ifdef __linux__
+        struct timespec ts = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000 };
+        syscall(SYS_futex, epochAddr(), FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+    #else
+        CGRAPH_UNIQUE_LOCK lk(mutex_);
+        cv_.wait_for(lk, std::chrono::milliseconds(ms), [this, key] {
+            return key != (Key)(value_.load(std::memory_order_acquire) >> EPOCH_SHIFT);
+        });
+    #endif
+    }
+
+    #ifdef __linux__
+    /**
+     * futex 仅支持32位，这里获取轮次信息（高32位）所在的地址
+     * @return
+     */
+    Key* epochAddr() {
+        #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return reinterpret_cast<Key *>(&value_);
+        #else
+        return reinterpret_cast<Key *>(&value_) + 1;
+        #endif
+    }
+    #endif
+
+private:
+    std::atomic<std::uint64_t> value_ {0};                  // 高32位为轮次信息，低32位为等待线程个数
+    #ifndef __linux__
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    #endif
+};
+
+CGRAPH_NAMESPACE_END
+
+#endif //CGRAPH_UEVENTCOUNT_H
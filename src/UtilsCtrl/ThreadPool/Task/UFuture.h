@@ -0,0 +1,579 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: UFuture.h
+@Time: 2026/10/18 10:20
+@Desc: 线程池内部使用的 promise/future，用于 commitFast() 和 UTaskGroup 中，替代 std::packaged_task + std::future
+ * 1. 共享状态从线程本地的缓存中获取，用完之后回收复用，稳定运行时不需要申请内存
+ * 2. 就绪状态和引用计数合并在一个原子变量中，无等待线程的时候，写入结果不需要加锁
+ * 3. get() 先自旋等待一段时间（按照最近的自旋耗时自适应），仍未就绪的时候，再进入阻塞等待
+***************************/
+
+#ifndef CGRAPH_UFUTURE_H
+#define CGRAPH_UFUTURE_H
+
+#include <new>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+#include "../UThreadObject.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+/**
+ * 存放结果信息，针对 void 和引用类型做特化
+ * @tparam T
+ */
+template<typename T>
+class UFutureValue {
+public:
+    template<typename... Args>
+    CVoid set(Args&&... args) {
+        ::new(&buffer_) T(std::forward<Args>(args)...);
+        has_value_ = true;
+    }
+
+    T take() {
+        return std::move(*reinterpret_cast<T *>(&buffer_));
+    }
+
+    CVoid fulfill(std::promise<T>& promise) {
+        promise.set_value(take());
+    }
+
+    CVoid reset() {
+        if (has_value_) {
+            reinterpret_cast<T *>(&buffer_)->~T();
+            has_value_ = false;
+        }
+    }
+
+    ~UFutureValue() {
+        reset();
+    }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer_;
+    CBool has_value_ = false;
+};
+
+
+template<typename T>
+class UFutureValue<T&> {
+public:
+    CVoid set(T& value) {
+        ptr_ = std::addressof(value);
+    }
+
+    T& take() {
+        return *ptr_;
+    }
+
+    CVoid fulfill(std::promise<T&>& promise) {
+        promise.set_value(*ptr_);
+    }
+
+    CVoid reset() {
+        ptr_ = nullptr;
+    }
+
+private:
+    T* ptr_ = nullptr;
+};
+
+
+template<>
+class UFutureValue<CVoid> {
+public:
+    CVoid set() {}
+
+    CVoid take() {}
+
+    CVoid fulfill(std::promise<CVoid>& promise) {
+        promise.set_value();
+    }
+
+    CVoid reset() {}
+};
+
+
+/**
+ * promise 和 future 之间的共享状态
+ * status_ 中，最低位表示是否就绪，次低位表示是否有线程在阻塞等待，其余的位表示引用计数
+ * @tparam T
+ */
+template<typename T>
+class UFutureState : public CStruct {
+    static const CSize READY_FLAG = 1;
+    static const CSize WAITER_FLAG = 2;
+    static const CSize REF_UNIT = 4;
+
+    /**
+     * 线程本地的缓存，线程退出的时候统一释放
+     * 释放之后，当前线程中的其他 thread_local 对象析构时，仍可能获取或回收状态，此时不再使用缓存
+     */
+    struct StateCache {
+        std::vector<UFutureState *> states_;
+        ~StateCache() {
+            isCacheDestroyed() = true;
+            for (auto* state : states_) {
+                delete state;
+            }
+        }
+    };
+
+public:
+    /**
+     * 获取一个共享状态，优先从当前线程的缓存中获取
+     * @return
+     */
+    static UFutureState* obtain() {
+        StateCache* cache = localCache();
+        UFutureState* state = nullptr;
+        if (likely(cache && !cache->states_.empty())) {
+            state = cache->states_.back();
+            cache->states_.pop_back();
+        } else {
+            state = new UFutureState();
+        }
+
+        state->status_.store(REF_UNIT, std::memory_order_relaxed);
+        return state;
+    }
+
+    CVoid addRef() {
+        status_.fetch_add(REF_UNIT, std::memory_order_relaxed);
+    }
+
+    /**
+     * 释放一份引用。最后一个持有者，负责回收
+     */
+    CVoid release() {
+        if (REF_UNIT == (status_.fetch_sub(REF_UNIT, std::memory_order_acq_rel) & ~(READY_FLAG | WAITER_FLAG))) {
+            recycle();
+        }
+    }
+
+    CBool isReady() const {
+        return 0 != (status_.load(std::memory_order_acquire) & READY_FLAG);
+    }
+
+    template<typename... Args>
+    CVoid setValue(Args&&... args) {
+        value_.set(std::forward<Args>(args)...);
+        publish();
+    }
+
+    CVoid setException(std::exception_ptr exception) {
+        exception_ = exception;
+        publish();
+    }
+
+    /**
+     * 等待结果就绪，先自旋，再阻塞
+     * @param deadline
+     * @return 超时的时候，返回false
+     */
+    template<typename Clock, typename Duration>
+    CBool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (spin()) {
+            return true;
+        }
+
+        CGRAPH_UNIQUE_LOCK lk(mutex_);
+        if (status_.fetch_or(WAITER_FLAG, std::memory_order_acq_rel) & READY_FLAG) {
+            return true;
+        }
+        return cv_.wait_until(lk, deadline, [this] { return isReady(); });
+    }
+
+    CVoid wait() {
+        if (spin()) {
+            return;
+        }
+
+        CGRAPH_UNIQUE_LOCK lk(mutex_);
+        if (status_.fetch_or(WAITER_FLAG, std::memory_order_acq_rel) & READY_FLAG) {
+            return;
+        }
+        cv_.wait(lk, [this] { return isReady(); });
+    }
+
+    /**
+     * 获取结果信息。如果执行过程中有异常，则抛出
+     * @return
+     */
+    T take() {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+        return value_.take();
+    }
+
+    /**
+     * 转换成 std::future。如果结果还未就绪，则就绪的时候，由写入线程负责设置
+     * @return
+     */
+    std::future<T> toStdFuture() {
+        std::promise<T> promise;
+        std::future<T> result = promise.get_future();
+
+        CGRAPH_LOCK_GUARD lk(mutex_);
+        if (status_.fetch_or(WAITER_FLAG, std::memory_order_acq_rel) & READY_FLAG) {
+            fulfill(promise);
+        } else {
+            bridge_.reset(new std::promise<T>(std::move(promise)));
+        }
+        return result;
+    }
+
+private:
+    explicit UFutureState() = default;
+
+    /**
+     * 自旋等待一段时间
+     * 记录当前线程最近几次自旋的平均耗时。线程数超过cpu核数的时候，让出cpu之后需要较长时间才能重新被调度，
+     * 此时自旋比阻塞等待（就绪后被直接唤醒）更慢，平均耗时超过 CGRAPH_FUTURE_SPIN_NS 之后不再自旋，并逐步衰减后重新尝试
+     * @return 就绪的时候，返回true
+     */
+    CBool spin() const {
+        CLong& avgNs = spinCostNs();
+        if (avgNs >= CGRAPH_FUTURE_SPIN_NS) {
+            avgNs -= (avgNs >> 8) + 1;
+            return isReady();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        CBool ready = false;
+        for (CInt i = 0; i < CGRAPH_FUTURE_SPIN_TIMES && !(ready = isReady()); i++) {
+            CGRAPH_YIELD();
+            if (std::chrono::steady_clock::now() - start > std::chrono::nanoseconds(CGRAPH_FUTURE_SPIN_NS)) {
+                ready = isReady();
+                break;
+            }
+        }
+        const CLong curNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        avgNs += (curNs - avgNs) / 4;
+        return ready;
+    }
+
+    /**
+     * 当前线程自旋的平均耗时（ns）
+     * @return
+     */
+    static CLong& spinCostNs() {
+        static thread_local CLong avgNs = 0;
+        return avgNs;
+    }
+
+    /**
+     * 设置为就绪状态，并且释放 promise 持有的引用
+     * 没有等待线程的时候，仅有一次 CAS 的开销。此时 future 一定是最后的持有者，状态会回收到调用线程的缓存中
+     */
+    CVoid publish() {
+        CSize cur = status_.load(std::memory_order_relaxed);
+        while (!(cur & WAITER_FLAG)) {
+            if (status_.compare_exchange_weak(cur, (cur | READY_FLAG) - REF_UNIT,
+                                              std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                if (REF_UNIT == (cur & ~(READY_FLAG | WAITER_FLAG))) {
+                    recycle();
+                }
+                return;
+            }
+        }
+
+        {
+            CGRAPH_LOCK_GUARD lk(mutex_);
+            status_.fetch_or(READY_FLAG, std::memory_order_acq_rel);
+            if (bridge_) {
+                fulfill(*bridge_);
+                bridge_.reset();
+            }
+        }
+        cv_.notify_all();    // 在锁外通知，被唤醒的线程不会再阻塞在 mutex_ 上。release() 之前状态仍被持有，不会被回收
+        release();
+    }
+
+    CVoid fulfill(std::promise<T>& promise) {
+        if (exception_) {
+            promise.set_exception(exception_);
+        } else {
+            value_.fulfill(promise);
+        }
+    }
+
+    /**
+     * 清空状态，并且放回当前线程的缓存中。缓存满了的话，直接释放
+     */
+    CVoid recycle() {
+        value_.reset();
+        exception_ = nullptr;
+        bridge_.reset();
+
+        StateCache* cache = localCache();
+        if (likely(cache && cache->states_.size() < CGRAPH_FUTURE_STATE_CACHE_SIZE)) {
+            cache->states_.push_back(this);
+        } else {
+            delete this;
+        }
+    }
+
+    /**
+     * 获取当前线程的缓存
+     * @return 线程退出、缓存已经释放的时候，返回nullptr
+     */
+    static StateCache* localCache() {
+        if (unlikely(isCacheDestroyed())) {
+            return nullptr;
+        }
+        static thread_local StateCache cache;
+        return &cache;
+    }
+
+    /**
+     * 缓存是否已经释放。bool 类型的 thread_local 没有析构过程，线程退出的过程中也可以安全访问
+     * @return
+     */
+    static CBool& isCacheDestroyed() {
+        static thread_local CBool destroyed = false;
+        return destroyed;
+    }
+
+private:
+    std::atomic<CSize> status_ {0};                         // 就绪标记 + 等待标记 + 引用计数
+    UFutureValue<T> value_;                                 // 结果信息
+    std::exception_ptr exception_ = nullptr;                // 执行过程中的异常信息
+    std::mutex mutex_;                                      // 仅在阻塞等待的时候使用
+    std::condition_variable cv_;
+    std::unique_ptr<std::promise<T>> bridge_;               // 转换成 std::future 时使用
+};
+
+
+/**
+ * 异步结果，接口和 std::future 保持一致（不支持 share()）
+ * @tparam T
+ */
+template<typename T>
+class UFuture {
+public:
+    UFuture() = default;
+
+    explicit UFuture(UFutureState<T>* state) noexcept
+        : state_(state) {
+    }
+
+    UFuture(UFuture&& future) noexcept
+        : state_(future.state_) {
+        future.state_ = nullptr;
+    }
+
+    UFuture& operator=(UFuture&& future) noexcept {
+        if (this != &future) {
+            reset();
+            state_ = future.state_;
+            future.state_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~UFuture() {
+        reset();
+    }
+
+    /**
+     * 兼容 std::future 的写法。转换之后，当前 future 失效
+     * @return
+     * @notice 转换的时候，会额外申请 std::promise 的共享状态。需要 share() 等功能的时候，建议直接使用 commit() 接口
+     */
+    operator std::future<T>() {
+        std::future<T> result = state_->toStdFuture();
+        reset();
+        return result;
+    }
+
+    /**
+     * 获取结果信息，未就绪的时候会等待。获取之后，当前 future 失效
+     * @return
+     */
+    T get() {
+        state_->wait();
+        StateHolder holder(state_);
+        state_ = nullptr;
+        return holder.state_->take();
+    }
+
+    CVoid wait() const {
+        state_->wait();
+    }
+
+    template<typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period>& duration) const {
+        return wait_until(std::chrono::steady_clock::now() + duration);
+    }
+
+    template<typename Clock, typename Duration>
+    std::future_status wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const {
+        return state_->waitUntil(deadline) ? std::future_status::ready : std::future_status::timeout;
+    }
+
+    CBool valid() const noexcept {
+        return nullptr != state_;
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(UFuture)
+
+private:
+    /**
+     * 保证 get() 抛出异常的时候，也可以正常回收状态
+     */
+    struct StateHolder {
+        explicit StateHolder(UFutureState<T>* state) : state_(state) {}
+        ~StateHolder() { state_->release(); }
+        UFutureState<T>* state_;
+    };
+
+    CVoid reset() {
+        if (state_) {
+            state_->release();
+            state_ = nullptr;
+        }
+    }
+
+private:
+    UFutureState<T>* state_ = nullptr;
+};
+
+
+/**
+ * 设置异步结果，接口和 std::promise 保持一致
+ * @tparam T
+ */
+template<typename T>
+class UPromise {
+public:
+    explicit UPromise()
+        : state_(UFutureState<T>::obtain()) {
+    }
+
+    UPromise(UPromise&& promise) noexcept
+        : state_(promise.state_) {
+        promise.state_ = nullptr;
+    }
+
+    UPromise& operator=(UPromise&& promise) noexcept {
+        if (this != &promise) {
+            abandon();
+            state_ = promise.state_;
+            promise.state_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~UPromise() {
+        abandon();
+    }
+
+    /**
+     * 获取对应的 future，仅允许调用一次
+     * @return
+     */
+    UFuture<T> get_future() {
+        state_->addRef();
+        return UFuture<T>(state_);
+    }
+
+    template<typename... Args>
+    CVoid set_value(Args&&... args) {
+        state_->setValue(std::forward<Args>(args)...);
+        state_ = nullptr;    // 设置结果之后，promise 不再持有状态
+    }
+
+    CVoid set_exception(std::exception_ptr exception) {
+        state_->setException(exception);
+        state_ = nullptr;
+    }
+
+    /**
+     * 执行函数，并且记录结果信息或者异常信息
+     * @tparam F
+     * @param func
+     */
+    template<typename F>
+    CVoid run(F& func) {
+        try {
+            invoke(func, std::is_void<T>());
+        } catch (...) {
+            if (state_) {
+                set_exception(std::current_exception());
+            }
+        }
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(UPromise)
+
+private:
+    template<typename F>
+    CVoid invoke(F& func, std::false_type) {
+        set_value(func());
+    }
+
+    template<typename F>
+    CVoid invoke(F& func, std::true_type) {
+        func();
+        set_value();
+    }
+
+    /**
+     * 未设置结果就被析构的时候，通知 future 一侧
+     */
+    CVoid abandon() {
+        if (state_) {
+            set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+private:
+    UFutureState<T>* state_ = nullptr;
+};
+
+
+/**
+ * 函数执行结果的类型。任务中存放的是退化后的函数，并且以左值的方式调用
+ */
+template<typename F>
+using UTaskResultType = decltype(std::declval<typename std::decay<F>::type &>()());
+
+
+/**
+ * 将函数和 promise 绑定在一起，作为 UTask 中实际执行的内容
+ * 仅比函数本身多一个指针的大小，较小的函数仍然可以直接存放在 UTask 内部
+ * @tparam F
+ * @tparam T
+ */
+template<typename F, typename T>
+class UPromiseTask {
+public:
+    template<typename Func>
+    explicit UPromiseTask(Func&& func, UPromise<T>&& promise)
+        : func_(std::forward<Func>(func))
+        , promise_(std::move(promise)) {
+    }
+
+    CVoid operator()() {
+        promise_.run(func_);
+    }
+
+private:
+    F func_;
+    UPromise<T> promise_;
+};
+
+CGRAPH_NAMESPACE_END
+
+#endif //CGRAPH_UFUTURE_H
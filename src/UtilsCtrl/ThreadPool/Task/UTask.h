@@ -3,12 +3,15 @@
 @Contact: chunel@foxmail.com
 @File: UTask.h
 @Time: 2021/7/2 11:32 下午
-@Desc: 
+@Desc:
 ***************************/
 
 #ifndef CGRAPH_UTASK_H
 #define CGRAPH_UTASK_H
 
+#include <new>
+#include <chrono>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <type_traits>
@@ -18,43 +21,117 @@
 CGRAPH_NAMESPACE_BEGIN
 
 class UTask : public CStruct {
-    struct TaskBased {
-        explicit TaskBased() = default;
-        virtual CVoid call() = 0;
-        virtual ~TaskBased() = default;
+    using TaskBuffer = std::aligned_storage<CGRAPH_TASK_INLINE_SIZE, alignof(std::max_align_t)>::type;
+
+    /**
+     * 类型擦除后的操作函数集合，每种函数类型对应一份静态实例
+     * 通过函数指针的方式调用，不需要额外在堆上申请 TaskBased 这种带虚表的对象
+     */
+    struct TaskOps {
+        CVoid (*call_)(CVoidPtr buf);
+        CVoid (*move_)(CVoidPtr dst, CVoidPtr src);    // 将src中的内容移动到dst中，并且释放src
+        CVoid (*destroy_)(CVoidPtr buf);
+        CBool is_heap_;                                 // 函数体是否在堆上申请
+    };
+
+    /**
+     * 函数体较小的时候，直接存放在 buffer_ 中
+     * 为了保证 move 操作的安全性，仅针对 noexcept move 的类型生效
+     */
+    template<typename T>
+    struct TaskInline {
+        static CVoid call(CVoidPtr buf) {
+            (*static_cast<T *>(buf))();
+        }
+
+        static CVoid move(CVoidPtr dst, CVoidPtr src) {
+            ::new(dst) T(std::move(*static_cast<T *>(src)));
+            static_cast<T *>(src)->~T();
+        }
+
+        static CVoid destroy(CVoidPtr buf) {
+            static_cast<T *>(buf)->~T();
+        }
+
+        static const TaskOps ops_;
+    };
+
+    /**
+     * 函数体较大的时候，在堆上申请，buffer_ 中仅记录指针信息
+     */
+    template<typename T>
+    struct TaskHeap {
+        static T*& ptr(CVoidPtr buf) {
+            return *static_cast<T **>(buf);
+        }
+
+        static CVoid call(CVoidPtr buf) {
+            (*ptr(buf))();
+        }
+
+        static CVoid move(CVoidPtr dst, CVoidPtr src) {
+            ::new(dst) T*(ptr(src));
+            ptr(src) = nullptr;
+        }
+
+        static CVoid destroy(CVoidPtr buf) {
+            delete ptr(buf);
+        }
+
+        static const TaskOps ops_;
     };
 
     // 退化以获得实际类型，修改思路参考：https://github.com/ChunelFeng/CThreadPool/pull/3
     template<typename F, typename T = typename std::decay<F>::type>
-    struct TaskDerided : TaskBased {
-        T func_;
-        explicit TaskDerided(F&& func) : func_(std::forward<F>(func)) {}
-        CVoid call() final { func_(); }
+    struct TaskTraits {
+        static const CBool is_inline_ = sizeof(T) <= sizeof(TaskBuffer)
+                                        && alignof(T) <= alignof(TaskBuffer)
+                                        && std::is_nothrow_move_constructible<T>::value;
     };
 
 public:
-    template<typename F>
+    template<typename F, typename T = typename std::decay<F>::type,
+             c_enable_if_t<!std::is_same<T, UTask>::value, int> = 0>
     UTask(F&& func, int priority = 0)
-        : impl_(new TaskDerided<F>(std::forward<F>(func)))
-        , priority_(priority) {}
+        : priority_(priority) {
+        construct<T>(std::forward<F>(func), std::integral_constant<CBool, TaskTraits<F>::is_inline_>());
+    }
+
+    /**
+     * 通过已有的任务，构造一个新的带优先级的任务
+     * @param task
+     * @param priority
+     */
+    UTask(UTask&& task, int priority) noexcept
+        : priority_(priority) {
+        moveFrom(task);
+    }
 
     CVoid operator()() {
-        // impl_ 理论上不可能为空
-        impl_->call();
+        // ops_ 理论上不可能为空
+        ops_->call_(&buffer_);
     }
 
     UTask() = default;
 
-    UTask(UTask&& task) noexcept:
-            impl_(std::move(task.impl_)),
-            priority_(task.priority_) {}
+    UTask(UTask&& task) noexcept
+        : priority_(task.priority_) {
+        moveFrom(task);
+    }
 
     UTask &operator=(UTask&& task) noexcept {
-        impl_ = std::move(task.impl_);
-        priority_ = task.priority_;
+        if (this != &task) {
+            reset();
+            moveFrom(task);
+            priority_ = task.priority_;
+        }
         return *this;
     }
 
+    ~UTask() override {
+        reset();
+    }
+
     CBool operator>(const UTask& task) const {
         return priority_ < task.priority_;    // 新加入的，放到后面
     }
@@ -63,13 +140,122 @@ public:
         return priority_ >= task.priority_;
     }
 
+    /**
+     * 判断当前任务是否为空
+     * @return
+     */
+    CBool empty() const {
+        return nullptr == ops_;
+    }
+
+    /**
+     * 获取存放的函数体，用法和 std::function::target() 一致
+     * @tparam T
+     * @return 类型不一致或者任务为空的时候，返回nullptr
+     */
+    template<typename T>
+    T* target() noexcept {
+        if (&TaskInline<T>::ops_ == ops_) {
+            return reinterpret_cast<T *>(&buffer_);
+        } else if (&TaskHeap<T>::ops_ == ops_) {
+            return TaskHeap<T>::ptr(&buffer_);
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    const T* target() const noexcept {
+        return const_cast<UTask *>(this)->target<T>();
+    }
+
+    /**
+     * 预取函数体所在的内存。函数体在堆上的时候，预取堆上的内存
+     */
+    CVoid prefetch() const {
+        if (ops_) {
+            CGRAPH_PREFETCH(ops_->is_heap_ ? *reinterpret_cast<CVoid* const*>(&buffer_) : &buffer_);
+        }
+    }
+
+    /**
+     * 记录写入队列的时间和任务的分类标签，仅在开启耗时统计的时候调用
+     * @param tag 超出范围的标签，按照默认标签记录
+     */
+    CVoid stamp(CInt tag) {
+        enqueue_ns_ = (std::int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        tag_ = (tag >= 0 && tag < CGRAPH_TASK_TAG_SIZE) ? tag : CGRAPH_DEFAULT_TASK_TAG;
+    }
+
+    /**
+     * 获取写入队列的时间，单位为ns。为0表示没有记录
+     * @return
+     */
+    std::int64_t getEnqueueNs() const {
+        return enqueue_ns_;
+    }
+
+    /**
+     * 获取任务的分类标签
+     * @return
+     */
+    CInt getTag() const {
+        return tag_;
+    }
+
     CGRAPH_NO_ALLOWED_COPY(UTask)
 
 private:
-    std::unique_ptr<TaskBased> impl_ = nullptr;
+    template<typename T, typename F>
+    CVoid construct(F&& func, std::true_type) {
+        ::new(&buffer_) T(std::forward<F>(func));
+        ops_ = &TaskInline<T>::ops_;
+    }
+
+    template<typename T, typename F>
+    CVoid construct(F&& func, std::false_type) {
+        ::new(&buffer_) T*(new T(std::forward<F>(func)));
+        ops_ = &TaskHeap<T>::ops_;
+    }
+
+    /**
+     * 将 task 中的内容转移过来。调用前，需确保当前任务为空
+     * @param task
+     */
+    CVoid moveFrom(UTask& task) noexcept {
+        if (task.ops_) {
+            task.ops_->move_(&buffer_, &task.buffer_);
+            ops_ = task.ops_;
+            task.ops_ = nullptr;
+        }
+        enqueue_ns_ = task.enqueue_ns_;
+        tag_ = task.tag_;
+    }
+
+    /**
+     * 释放当前任务中的函数信息
+     */
+    CVoid reset() noexcept {
+        if (ops_) {
+            ops_->destroy_(&buffer_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    std::int64_t enqueue_ns_ = 0;                       // 写入队列的时间，仅开启耗时统计的时候记录。放在 buffer_ 之前的对齐空隙中，不增加任务的大小
+    TaskBuffer buffer_;                                 // 存放函数体（或函数体指针）的内存
+    const TaskOps* ops_ = nullptr;                      // 函数体对应的操作信息，为空表示当前没有任务
     CInt priority_ = 0;                                 // 任务的优先级信息
+    CInt tag_ = CGRAPH_DEFAULT_TASK_TAG;                // 任务的分类标签，用于耗时统计
 };
 
+template<typename T>
+const UTask::TaskOps UTask::TaskInline<T>::ops_ = { &TaskInline<T>::call, &TaskInline<T>::move, &TaskInline<T>::destroy, false };
+
+template<typename T>
+const UTask::TaskOps UTask::TaskHeap<T>::ops_ = { &TaskHeap<T>::call, &TaskHeap<T>::move, &TaskHeap<T>::destroy, true };
+
 
 using UTaskRef = UTask &;
 using UTaskPtr = UTask *;
@@ -9,37 +9,84 @@
 #ifndef CGRAPH_UTASKGROUP_H
 #define CGRAPH_UTASKGROUP_H
 
+#include <vector>
 #include <utility>
+#include <type_traits>
 
 #include "../UThreadObject.h"
+#include "UTask.h"
+#include "UFuture.h"
 
 CGRAPH_NAMESPACE_BEGIN
 
 class UTaskGroup : public UThreadObject {
+    /**
+     * 将任务组中的函数，和 promise 绑定成可以执行的任务。每种函数类型对应一份静态实例
+     */
+    using TaskCopier = UTask (*)(const UTask& task, UPromise<CVoid>&& promise);
+
+    struct TaskBinder {
+        TaskCopier copy_;                                                // 拷贝函数，不可拷贝的函数为nullptr
+        UTask (*move_)(UTask& task, UPromise<CVoid>&& promise);          // 将函数 move 出来
+    };
+
+    template<typename T>
+    struct TaskBinderImpl {
+        static UTask copy(const UTask& task, UPromise<CVoid>&& promise) {
+            return UTask(UPromiseTask<T, CVoid>(*task.target<T>(), std::move(promise)));
+        }
+
+        static UTask move(UTask& task, UPromise<CVoid>&& promise) {
+            return UTask(UPromiseTask<T, CVoid>(std::move(*task.target<T>()), std::move(promise)));
+        }
+
+        static const TaskBinder binder_;
+    };
+
+    /**
+     * 仅可拷贝的函数，提供拷贝的方法。constexpr 保证 binder_ 为静态初始化
+     */
+    template<typename T, c_enable_if_t<std::is_copy_constructible<T>::value, int> = 0>
+    static constexpr TaskCopier copier() {
+        return &TaskBinderImpl<T>::copy;
+    }
+
+    template<typename T, c_enable_if_t<!std::is_copy_constructible<T>::value, int> = 0>
+    static constexpr TaskCopier copier() {
+        return nullptr;
+    }
+
 public:
     explicit UTaskGroup() = default;
     CGRAPH_NO_ALLOWED_COPY(UTaskGroup)
 
     /**
      * 直接通过函数来申明taskGroup
+     * @tparam FunctionType
      * @param task
      * @param ttl
      * @param onFinished
      */
-    explicit UTaskGroup(CGRAPH_DEFAULT_CONST_FUNCTION_REF task,
+    template<typename FunctionType,
+             c_enable_if_t<!std::is_same<typename std::decay<FunctionType>::type, UTaskGroup>::value, int> = 0>
+    explicit UTaskGroup(FunctionType&& task,
                         CMSec ttl = CGRAPH_MAX_BLOCK_TTL,
-                        CGRAPH_CALLBACK_CONST_FUNCTION_REF onFinished = nullptr) noexcept {
-        this->addTask(task)
+                        CGRAPH_CALLBACK_CONST_FUNCTION_REF onFinished = nullptr) {
+        this->addTask(std::forward<FunctionType>(task))
             ->setTtl(ttl)
             ->setOnFinished(onFinished);
     }
 
     /**
-     * 添加一个任务
+     * 添加一个任务。传入右值的时候，函数体会被 move 进来，不会发生拷贝
+     * @tparam FunctionType
      * @param task
+     * @notice 任务的返回值会被忽略。不可拷贝的函数，仅支持通过 submit(std::move(taskGroup)) 的方式执行
      */
-    UTaskGroup* addTask(CGRAPH_DEFAULT_CONST_FUNCTION_REF task) {
-        task_arr_.emplace_back(task);
+    template<typename FunctionType>
+    UTaskGroup* addTask(FunctionType&& task) {
+        task_arr_.emplace_back(std::forward<FunctionType>(task));
+        binder_arr_.emplace_back(&TaskBinderImpl<typename std::decay<FunctionType>::type>::binder_);
         return this;
     }
 
@@ -75,6 +122,7 @@ public:
      */
     CVoid clear() {
         task_arr_.clear();
+        binder_arr_.clear();
     }
 
     /**
@@ -87,13 +135,58 @@ public:
     }
 
 private:
-    std::vector<CGRAPH_DEFAULT_FUNCTION> task_arr_;         // 任务消息
+    /**
+     * 拷贝任务组中的函数，生成可以执行的任务。任务组本身不变，可以重复执行
+     * @param tasks
+     * @param futures
+     * @return 包含不可拷贝的函数的时候，返回错误信息
+     */
+    CStatus copyTasks(UTaskArrRef tasks, std::vector<UFuture<CVoid>>& futures) const {
+        CGRAPH_FUNCTION_BEGIN
+        for (const auto* binder : binder_arr_) {
+            CGRAPH_RETURN_ERROR_STATUS_BY_CONDITION(nullptr == binder->copy_,
+                                                    "task group contains move-only task, please submit by std::move")
+        }
+
+        tasks.reserve(task_arr_.size());
+        futures.reserve(task_arr_.size());
+        for (CSize i = 0; i < task_arr_.size(); i++) {
+            UPromise<CVoid> promise;
+            futures.emplace_back(promise.get_future());
+            tasks.emplace_back(binder_arr_[i]->copy_(task_arr_[i], std::move(promise)));
+        }
+        CGRAPH_FUNCTION_END
+    }
+
+    /**
+     * 将任务组中的函数 move 出来，生成可以执行的任务。之后任务组被清空
+     * @param tasks
+     * @param futures
+     */
+    CVoid takeTasks(UTaskArrRef tasks, std::vector<UFuture<CVoid>>& futures) {
+        tasks.reserve(task_arr_.size());
+        futures.reserve(task_arr_.size());
+        for (CSize i = 0; i < task_arr_.size(); i++) {
+            UPromise<CVoid> promise;
+            futures.emplace_back(promise.get_future());
+            tasks.emplace_back(binder_arr_[i]->move_(task_arr_[i], std::move(promise)));
+        }
+        clear();
+    }
+
+private:
+    UTaskArr task_arr_;                                     // 任务消息，存放的是函数本身
+    std::vector<const TaskBinder *> binder_arr_;            // 函数对应的绑定方法，和 task_arr_ 一一对应
     CMSec ttl_ = CGRAPH_MAX_BLOCK_TTL;                      // 任务组最大执行耗时(如果是0的话，则表示不阻塞)
     CGRAPH_CALLBACK_FUNCTION on_finished_ = nullptr;        // 执行函数任务结束
 
     friend class UThreadPool;
 };
 
+template<typename T>
+const UTaskGroup::TaskBinder UTaskGroup::TaskBinderImpl<T>::binder_ = { UTaskGroup::copier<T>(), &UTaskGroup::TaskBinderImpl<T>::move };
+
+
 using UTaskGroupPtr = UTaskGroup *;
 using UTaskGroupRef = UTaskGroup &;
 
@@ -10,6 +10,7 @@
 #define CGRAPH_UTASKINCLUDE_H
 
 #include "UTask.h"
+#include "UFuture.h"
 #include "UTaskGroup.h"
 
 #endif //CGRAPH_UTASKINCLUDE_H
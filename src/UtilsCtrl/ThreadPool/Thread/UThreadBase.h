@@ -10,15 +10,77 @@
 #define CGRAPH_UTHREADBASE_H
 
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
 
 #include "../UThreadObject.h"
+#include "../UThreadPoolStats.h"
+#include "../UThreadPoolTrace.h"
 #include "../Queue/UQueueInclude.h"
 #include "../Task/UTaskInclude.h"
+#include "../Semaphore/UEventCount.h"
+#include "../Topology/UCpuTopology.h"
 
 
 CGRAPH_NAMESPACE_BEGIN
 
+/** 线程池中，所有线程共享的计数信息 */
+struct UThreadCounter : public CStruct {
+    std::atomic<CInt> primary_num_ {0};                                // 正在运行的 primary 线程个数，运行中的线程为 primary_threads_ 中的前 primary_num_ 个
+    std::atomic<CInt> idle_num_ {0};                                   // 休眠中的 primary 线程个数
+    std::atomic<CInt> spin_num_ {0};                                   // 自旋等待中的线程个数
+    std::atomic<CInt> secondary_idle_num_ {0};                         // 休眠中的 secondary 线程个数
+    std::atomic<CInt> secondary_num_ {0};                              // secondary 线程个数，提交任务时无锁读取
+    std::atomic<CInt> lane_task_num_[CGRAPH_TASK_LANE_SIZE] {};        // 每个通道中，待执行的任务个数（仅统计非 NORMAL 通道）
+    std::atomic<CSize> pool_push_num_ {0};                             // 写入 pool 队列（含优先级队列）的任务总数，仅在开启弹性伸缩时统计
+    std::atomic<CSize> pool_pop_num_ {0};                              // 从 pool 队列（含优先级队列）中取出的任务总数，仅在开启弹性伸缩时统计
+    UEventCount secondary_event_;                                      // 所有 secondary 线程共用的休眠和唤醒，唤醒的时候不需要遍历辅助线程
+};
+
 class UThreadBase : public UThreadObject {
+public:
+    /**
+     * 按照缓存行对齐申请内存。C++17 之前，new 不保证超过 16 字节的对齐，内部按照缓存行隔离的信息会失效
+     * @param size
+     * @return
+     */
+    static CVoid* operator new(std::size_t size) {
+        CVoid* ptr = operator new(size, std::nothrow);
+        if (nullptr == ptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+
+    static CVoid* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+        // 多申请一个缓存行的空间，并在对齐之后的地址前面，记录原始地址
+        CVoid* origin = std::malloc(size + CGRAPH_CACHE_LINE_SIZE + sizeof(CVoid*));
+        if (nullptr == origin) {
+            return nullptr;
+        }
+        auto addr = ((std::uintptr_t)origin + sizeof(CVoid*) + CGRAPH_CACHE_LINE_SIZE - 1) & ~(std::uintptr_t)(CGRAPH_CACHE_LINE_SIZE - 1);
+        ((CVoid**)addr)[-1] = origin;
+        return (CVoid*)addr;
+    }
+
+
+    static CVoid operator delete(CVoid* ptr) noexcept {
+        if (ptr) {
+            std::free(((CVoid**)ptr)[-1]);
+        }
+    }
+
+
+    static CVoid operator delete(CVoid* ptr, const std::nothrow_t&) noexcept {
+        operator delete(ptr);
+    }
+
+
 protected:
     explicit UThreadBase() {
         done_ = true;
@@ -27,6 +89,7 @@ protected:
         pool_task_queue_ = nullptr;
         pool_priority_task_queue_ = nullptr;
         config_ = nullptr;
+        pool_counter_ = nullptr;
         total_task_num_ = 0;
     }
 
@@ -56,6 +119,13 @@ protected:
             // 如果辅助线程没有获取到的话，还需要再尝试从长时间任务队列中，获取一次
             result = pool_priority_task_queue_->tryPop(task);
         }
+        if (result) {
+            addLocalCount(pool_pop_num_, 1);
+            CGRAPH_TRACE(DEQUEUE, CGRAPH_POOL_TASK_STRATEGY, 1)
+            if (config_->elastic_enable_) {
+                pool_counter_->pool_pop_num_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
         return result;
     }
 
@@ -66,10 +136,18 @@ protected:
      * @return
      */
     virtual CBool popPoolTask(UTaskArrRef tasks) {
+        const CSize size = tasks.size();
         CBool result = pool_task_queue_->tryPop(tasks, config_->max_pool_batch_size_);
         if (!result && CGRAPH_THREAD_TYPE_SECONDARY == type_) {
             result = pool_priority_task_queue_->tryPop(tasks, 1);    // 从优先队列里，最多pop出来一个
         }
+        if (result) {
+            addLocalCount(pool_pop_num_, tasks.size() - size);
+            CGRAPH_TRACE(DEQUEUE, CGRAPH_POOL_TASK_STRATEGY, tasks.size() - size)
+            if (config_->elastic_enable_) {
+                pool_counter_->pool_pop_num_.fetch_add(tasks.size() - size, std::memory_order_relaxed);
+            }
+        }
 
         return result;
     }
@@ -80,10 +158,16 @@ protected:
      * @param task
      */
     CVoid runTask(UTask& task) {
-        is_running_ = true;
-        task();
-        total_task_num_++;
-        is_running_ = false;
+        is_running_.store(true, std::memory_order_relaxed);
+        CGRAPH_TRACE(RUN_BEGIN, 0, 1)
+        if (unlikely(latency_buckets_)) {
+            runLatencyTask(task);
+        } else {
+            task();
+        }
+        CGRAPH_TRACE(RUN_END, 0, 1)
+        addLocalCount(total_task_num_, 1);
+        is_running_.store(false, std::memory_order_release);
     }
 
 
@@ -92,27 +176,196 @@ protected:
      * @param tasks
      */
     CVoid runTasks(UTaskArr& tasks) {
-        is_running_ = true;
-        for (auto& task : tasks) {
-            task();
+        is_running_.store(true, std::memory_order_relaxed);
+        const CSize size = tasks.size();
+        if (unlikely(latency_buckets_)) {
+            runLatencyTasks(tasks);
+        } else {
+            for (CSize i = 0; i < size; i++) {
+                if (i + 1 < size) {
+                    tasks[i + 1].prefetch();    // 执行当前任务的时候，预取下一个任务的函数体
+                }
+                CGRAPH_TRACE(RUN_BEGIN, 0, 1)
+                tasks[i]();
+                CGRAPH_TRACE(RUN_END, 0, 1)
+            }
         }
-        total_task_num_ += tasks.size();
-        is_running_ = false;
+        addLocalCount(total_task_num_, size);
+        tasks.clear();    // 仅释放任务，保留容量，下一批复用
+        is_running_.store(false, std::memory_order_release);
+    }
+
+
+    /**
+     * 执行单个任务，并记录耗时。仅开启耗时统计的时候调用，不内联，不影响 runTask 的内联
+     * @param task
+     */
+    CGRAPH_NOINLINE CVoid runLatencyTask(UTask& task) {
+        const std::int64_t start = currentNs();
+        task();
+        recordLatency(task, start, currentNs());
+    }
+
+
+    /**
+     * 批量执行任务，并记录耗时。上一个任务的结束时间，即为下一个任务的开始时间，每个任务仅需获取一次时间
+     * @param tasks
+     */
+    CGRAPH_NOINLINE CVoid runLatencyTasks(UTaskArr& tasks) {
+        const CSize size = tasks.size();
+        std::int64_t start = currentNs();
+        for (CSize i = 0; i < size; i++) {
+            if (i + 1 < size) {
+                tasks[i + 1].prefetch();
+            }
+            CGRAPH_TRACE(RUN_BEGIN, 0, 1)
+            tasks[i]();
+            CGRAPH_TRACE(RUN_END, 0, 1)
+            const std::int64_t end = currentNs();
+            recordLatency(tasks[i], start, end);
+            start = end;
+        }
+    }
+
+
+    /**
+     * 按照单次最多可以获取的任务数，预留批量任务的空间。之后每一批任务都复用这块内存，不再申请
+     */
+    CVoid reserveBatchTasks() {
+        if (!config_->batch_task_enable_) {
+            return;
+        }
+
+        CInt capacity = (std::max)((std::max)(config_->max_local_batch_size_, config_->max_pool_batch_size_),
+                                   (std::max)(config_->max_steal_batch_size_, 1));
+        batch_tasks_.reserve(capacity);
+    }
+
+
+    /**
+     * 开启耗时统计的时候，申请记录耗时直方图的内存。在注册线程池信息的时候调用，之后不再变化，获取统计信息的时候可以无锁读取
+     */
+    CVoid prepareLatency() {
+        if (config_->latency_enable_ && !latency_buckets_) {
+            latency_buckets_.reset(new std::atomic<CULong>[CGRAPH_TASK_TAG_SIZE * 2 * CGRAPH_LATENCY_BUCKET_SIZE]());
+        }
+    }
+
+
+    /**
+     * 记录任务的等待时长和执行时长。直方图仅本线程写入，不需要加锁和原子的 RMW 操作
+     * @param task
+     * @param start 开始执行的时间
+     * @param end 执行结束的时间
+     */
+    CVoid recordLatency(const UTask& task, std::int64_t start, std::int64_t end) {
+        std::atomic<CULong>* buckets = latency_buckets_.get() + task.getTag() * 2 * CGRAPH_LATENCY_BUCKET_SIZE;
+        const std::int64_t enqueue = task.getEnqueueNs();
+        if (enqueue > 0) {
+            addLocalCount(buckets[ULatencyHistogram::calcBucket(start > enqueue ? (std::uint64_t)(start - enqueue) : 0)], 1);
+        }
+        addLocalCount(buckets[CGRAPH_LATENCY_BUCKET_SIZE + ULatencyHistogram::calcBucket((std::uint64_t)(end - start))], 1);
+    }
+
+
+    /**
+     * 将当前线程的耗时直方图，累加到 latency 中。在其他线程中调用，仅读取计数
+     * @param latency 按照分类标签记录，个数为 CGRAPH_TASK_TAG_SIZE
+     */
+    CVoid collectLatency(std::vector<UTaskLatency>& latency) const {
+        if (!latency_buckets_) {
+            return;
+        }
+
+        const std::atomic<CULong>* buckets = latency_buckets_.get();
+        for (CInt tag = 0; tag < CGRAPH_TASK_TAG_SIZE; tag++) {
+            for (CInt i = 0; i < CGRAPH_LATENCY_BUCKET_SIZE; i++) {
+                latency[tag].wait_.buckets_[i] += buckets[i].load(std::memory_order_relaxed);
+                latency[tag].run_.buckets_[i] += buckets[CGRAPH_LATENCY_BUCKET_SIZE + i].load(std::memory_order_relaxed);
+            }
+            buckets += 2 * CGRAPH_LATENCY_BUCKET_SIZE;
+        }
+    }
+
+
+    /**
+     * 增加仅本线程写入的计数。不需要原子的 RMW 操作，其他线程可以安全的读取
+     * @param count
+     * @param size
+     */
+    template<typename T>
+    static CVoid addLocalCount(std::atomic<T>& count, typename std::common_type<T>::type size) {
+        count.store(count.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
     }
 
 
     /**
-     * 清空所有任务内容
+     * 获取当前时间，单位为ns
+     * @return
+     */
+    static std::int64_t currentNs() {
+        return (std::int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+
+    /**
+     * 休眠直到被唤醒或者超时，并记录休眠的次数和时长。仅在休眠的时候计时，不影响执行任务的效率
+     * @param key
+     * @param ms
+     */
+    CVoid parkWait(UEventCount::Key key, CMSec ms) {
+        const std::int64_t start = currentNs();
+        CGRAPH_TRACE(PARK, 0, 1)
+        CBool notified = park_event_->commitWait(key, ms);
+        CGRAPH_TRACE(UNPARK, notified ? 1 : 0, 1)
+        addLocalCount(park_num_, 1);
+        addLocalCount(wakeup_num_, notified ? 1 : 0);
+        addLocalCount(parked_ns_, (std::uint64_t)(currentNs() - start));
+    }
+
+
+    /**
+     * 开启线程的时候调用，记录开启的时间
+     */
+    CVoid markStart() {
+        start_ns_.store(currentNs(), std::memory_order_relaxed);
+    }
+
+
+    /**
+     * 获取当前线程的统计信息。在其他线程中调用，仅读取计数
+     * @param stats
+     */
+    virtual CVoid collectStats(UThreadStats& stats) const {
+        stats.is_active_ = is_init_.load(std::memory_order_acquire) && done_.load(std::memory_order_acquire);
+        stats.task_num_ = total_task_num_.load(std::memory_order_relaxed);
+        stats.pool_pop_num_ = pool_pop_num_.load(std::memory_order_relaxed);
+        stats.batch_num_ = batch_num_.load(std::memory_order_relaxed);
+        stats.park_num_ = park_num_.load(std::memory_order_relaxed);
+        stats.wakeup_num_ = wakeup_num_.load(std::memory_order_relaxed);
+        stats.parked_ns_ = parked_ns_.load(std::memory_order_relaxed);
+        stats.alive_ns_ = alive_ns_.load(std::memory_order_relaxed);
+        if (stats.is_active_) {
+            stats.alive_ns_ += (std::uint64_t)(currentNs() - start_ns_.load(std::memory_order_relaxed));
+        }
+    }
+
+
+    /**
+     * 停止当前线程。统计信息在线程的整个生命周期内累计，不清空
      */
     CVoid reset() {
         done_ = false;
-        cv_.notify_one();    // 防止主线程 wait时间过长，导致的结束缓慢问题
+        park_event_->notifyAll();    // 防止主线程 wait时间过长，导致的结束缓慢问题
         if (thread_.joinable()) {
             thread_.join();    // 等待线程结束
         }
+        if (is_init_) {
+            addLocalCount(alive_ns_, (std::uint64_t)(currentNs() - start_ns_.load(std::memory_order_relaxed)));
+        }
         is_init_ = false;
         is_running_ = false;
-        total_task_num_ = 0;
     }
 
 
@@ -122,14 +375,76 @@ protected:
      */
     CBool wakeup() {
         CBool result = false;
-        if (!is_running_) {
-            cv_.notify_one();
-            result = true;
+        if (!is_running_.load(std::memory_order_acquire)) {
+            result = park_event_->notify();
         }
         return result;
     }
 
 
+    /**
+     * 没有获取到任务的时候调用，根据等待策略，判断是继续自旋，还是进入休眠
+     * SPIN / ADAPTIVE 策略中，同时自旋的线程个数不超过 max_spin_thread_size_，超过的线程直接休眠
+     * YIELD 策略中每一轮都会让出cpu，不占用自旋名额
+     * @return 返回true，表示继续自旋；返回false，表示需要休眠
+     */
+    CBool spinWait() {
+        const auto strategy = config_->wait_strategy_;
+        if (!is_idle_) {
+            is_idle_ = true;
+            if (UThreadWaitStrategy::ADAPTIVE == strategy) {
+                idle_start_ = std::chrono::steady_clock::now();
+            }
+        }
+
+        cur_empty_epoch_++;
+        CBool spinnable = false;
+        switch (strategy) {
+            case UThreadWaitStrategy::SPIN: spinnable = true; break;
+            case UThreadWaitStrategy::YIELD: spinnable = cur_empty_epoch_ < config_->primary_thread_busy_epoch_; break;
+            case UThreadWaitStrategy::ADAPTIVE: spinnable = (std::chrono::steady_clock::now() - idle_start_) < calcSpinBudget(); break;
+            default: break;
+        }
+
+        if (spinnable && !is_spinning_ && UThreadWaitStrategy::YIELD != strategy) {
+            spinnable = is_spinning_ = acquireSpin();
+        }
+        if (!spinnable) {
+            releaseSpin();
+            cur_empty_epoch_ = 0;
+            return false;
+        }
+
+        if (UThreadWaitStrategy::YIELD == strategy) {
+            CGRAPH_YIELD();
+        } else {
+            for (CInt i = 0; i < CGRAPH_SPIN_PAUSE_TIMES; i++) {
+                CGRAPH_PAUSE();
+            }
+        }
+        return true;
+    }
+
+
+    /**
+     * 获取到任务的时候调用，结束本轮空闲，并且记录空闲时长
+     */
+    CVoid finishIdle() {
+        if (likely(!is_idle_)) {
+            return;
+        }
+
+        releaseSpin();
+        if (UThreadWaitStrategy::ADAPTIVE == config_->wait_strategy_) {
+            auto gap = (CLong)(std::min)(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - idle_start_).count(),
+                                         (std::chrono::nanoseconds::rep)CGRAPH_ADAPTIVE_MAX_SPIN_NS * 2);
+            avg_idle_ns_ = (avg_idle_ns_ * 7 + gap) / 8;    // 指数平滑，主要参考最近几次的空闲时长
+        }
+        is_idle_ = false;
+        cur_empty_epoch_ = 0;
+    }
+
+
     /**
      * 执行单个消息
      * @return
@@ -150,14 +465,15 @@ protected:
     CVoid loopProcess() {
         CGRAPH_ASSERT_NOT_NULL_THROW_ERROR(config_)
         if (config_->batch_task_enable_) {
-            while (done_) {
+            while (done_.load(std::memory_order_acquire)) {
                 processTasks();    // 批量任务获取执行接口
             }
         } else {
-            while (done_) {
+            while (done_.load(std::memory_order_acquire)) {
                 processTask();    // 单个任务获取执行接口
             }
         }
+        releaseSpin();    // 退出的时候，归还可能占用的自旋名额
     }
 
 
@@ -187,27 +503,67 @@ protected:
 
     /**
      * 设置线程亲和性，仅针对linux系统
+     * 主线程按照绑定策略，绑定在单个cpu上。辅助线程（index < 0）可以在绑定策略用到的所有cpu上运行
+     * @param index
      */
     CVoid setAffinity(int index) {
-#if defined(__linux__) && !defined(__ANDROID__)
-        if (!config_->bind_cpu_enable_ || CGRAPH_CPU_NUM == 0 || index < 0) {
+        if (!config_->bind_cpu_enable_) {
             return;
         }
 
-        cpu_set_t mask;
-        CPU_ZERO(&mask);
-        CPU_SET(index % CGRAPH_CPU_NUM, &mask);
+        auto cpus = UCpuTopology::get().calcBindCpus(config_->bind_cpu_policy_, config_->bind_cpu_list_);
+        if (cpus.empty()) {
+            return;
+        }
 
-        auto handle = thread_.native_handle();
-        int ret = pthread_setaffinity_np(handle, sizeof(cpu_set_t), &mask);
+        if (index >= 0) {
+            cpus = { cpus[index % cpus.size()] };
+        }
+        int ret = UCpuTopology::bindThread(thread_.native_handle(), cpus);
         if (0 != ret) {
             CGRAPH_ECHO("warning : set thread affinity failed, system error code is [%d]", ret);
         }
-#endif
     }
 
 
 private:
+    /**
+     * 自适应策略下的自旋时长。任务到达的平均间隔越短，自旋越久；间隔过长，则不自旋，直接休眠
+     * @return
+     */
+    std::chrono::nanoseconds calcSpinBudget() const {
+        return std::chrono::nanoseconds(avg_idle_ns_ >= CGRAPH_ADAPTIVE_MAX_SPIN_NS
+                                        ? 0 : (std::min)(avg_idle_ns_ * 2, CGRAPH_ADAPTIVE_MAX_SPIN_NS));
+    }
+
+
+    /**
+     * 申请自旋名额，类似于 go 中的 nmspinning 机制
+     * @return
+     */
+    CBool acquireSpin() {
+        CInt cur = pool_counter_->spin_num_.load(std::memory_order_relaxed);
+        while (cur < config_->max_spin_thread_size_) {
+            if (pool_counter_->spin_num_.compare_exchange_weak(cur, cur + 1, std::memory_order_acq_rel,
+                                                               std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    /**
+     * 归还自旋名额
+     */
+    CVoid releaseSpin() {
+        if (is_spinning_) {
+            pool_counter_->spin_num_.fetch_sub(1, std::memory_order_acq_rel);
+            is_spinning_ = false;
+        }
+    }
+
+
     /**
      * 设定计算线程调度策略信息，
      * 非OTHER/RR/FIFO对应数值，统一返回OTHER类型
@@ -236,19 +592,42 @@ private:
 
 
 protected:
-    CBool done_;                                                       // 线程状态标记
-    CBool is_init_;                                                    // 标记初始化状态
-    CBool is_running_;                                                 // 是否正在执行
+    /**
+     * 以下信息按照读写的线程，分别放在不同的缓存行中，避免伪共享：
+     * 1. 控制信息和共享指针：创建和开启之后很少变化，其他线程（写入、唤醒、监控）频繁读取
+     * 2. 执行状态：本线程每执行一次任务都会写入，其他线程读取
+     * 3. 空转信息、批量任务和统计信息：仅本线程写入，统计信息在获取的时候被其他线程读取
+     * 4. 休眠和唤醒：其他线程写入任务之后通知
+     */
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<CBool> done_ {true};   // 线程状态标记
+    std::atomic<CBool> is_init_ {false};                               // 标记初始化状态
     CInt type_ = 0;                                                    // 用于区分线程类型（主线程、辅助线程）
-    CULong total_task_num_ = 0;                                        // 处理的任务的数字
-
-    UAtomicQueue<UTask>* pool_task_queue_;                             // 用于存放线程池中的普通任务
+    UPoolTaskQueue<UTask>* pool_task_queue_;                           // 用于存放线程池中的普通任务
     UAtomicPriorityQueue<UTask>* pool_priority_task_queue_;            // 用于存放线程池中的包含优先级任务的队列，仅辅助线程可以执行
     UThreadPoolConfigPtr config_ = nullptr;                            // 配置参数信息
-
+    UThreadCounter* pool_counter_;                                     // 线程池中，所有线程共享的计数信息
     std::thread thread_;                                               // 线程类
-    std::mutex mutex_;
-    std::condition_variable cv_;
+    UEventCount* park_event_ = &event_;                                // 休眠时等待的事件。secondary 线程共用 pool 中的事件
+
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<CBool> is_running_ {false};    // 是否正在执行
+    std::atomic<CULong> total_task_num_ {0};                           // 处理的任务的数字，仅本线程写入
+    std::atomic<CULong> batch_num_ {0};                                // 批量执行的批次数，仅本线程写入
+
+    alignas(CGRAPH_CACHE_LINE_SIZE) CInt cur_empty_epoch_ = 0;         // 当前空转的轮数信息
+    CBool is_idle_ = false;                                            // 是否处于空闲状态（从上一次没有获取到任务开始）
+    CBool is_spinning_ = false;                                        // 是否占用了自旋名额
+    CLong avg_idle_ns_ = CGRAPH_ADAPTIVE_MAX_SPIN_NS / 4;              // 平均空闲时长，单位为ns，仅自适应策略使用
+    std::chrono::steady_clock::time_point idle_start_;                 // 本轮空闲开始的时间
+    UTaskArr batch_tasks_;                                             // 批量执行的任务，每一批都复用，避免循环中申请内存
+    std::atomic<std::int64_t> start_ns_ {0};                           // 本次开启线程的时间，单位为ns
+    std::atomic<CULong> pool_pop_num_ {0};                             // 从 pool 队列中获取的任务个数，仅本线程写入
+    std::atomic<CULong> park_num_ {0};                                 // 休眠的次数，仅本线程写入
+    std::atomic<CULong> wakeup_num_ {0};                               // 休眠中被唤醒的次数，仅本线程写入
+    std::atomic<std::uint64_t> parked_ns_ {0};                         // 休眠的总时长，仅本线程写入
+    std::atomic<std::uint64_t> alive_ns_ {0};                          // 之前开启过的总时长，在线程停止之后累计
+    std::unique_ptr<std::atomic<CULong>[]> latency_buckets_;           // 按照分类标签，依次记录等待时长和执行时长的直方图，仅开启耗时统计的时候申请
+
+    alignas(CGRAPH_CACHE_LINE_SIZE) UEventCount event_;                // 用于线程的休眠和唤醒
 };
 
 CGRAPH_NAMESPACE_END
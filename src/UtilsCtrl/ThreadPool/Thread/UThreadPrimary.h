@@ -11,6 +11,9 @@
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <iterator>
+#include <algorithm>
 
 #include "UThreadBase.h"
 
@@ -30,8 +33,14 @@ protected:
         CGRAPH_ASSERT_INIT(false)
         CGRAPH_ASSERT_NOT_NULL(config_)
 
+        done_ = true;    // 被回收的线程，可以重新 init
+        is_retired_.store(false, std::memory_order_relaxed);
+        markStart();
         is_init_ = true;
         buildStealTargets();
+        reserveBatchTasks();
+        primary_queue_.reserve(CGRAPH_WORK_STEALING_RESERVE_SIZE);    // 通道队列使用较少，按需申请
+        secondary_queue_.reserve(CGRAPH_WORK_STEALING_RESERVE_SIZE);
         thread_ = std::thread(&UThreadPrimary::run, this);
         setSchedParam();
         setAffinity(index_);
@@ -44,20 +53,24 @@ protected:
      * @param index
      * @param poolTaskQueue
      * @param poolThreads
+     * @param poolCounter
      * @param config
      */
     CStatus setThreadPoolInfo(int index,
-                              UAtomicQueue<UTask>* poolTaskQueue,
+                              UPoolTaskQueue<UTask>* poolTaskQueue,
                               std::vector<UThreadPrimary *>* poolThreads,
+                              UThreadCounter* poolCounter,
                               UThreadPoolConfigPtr config) {
         CGRAPH_FUNCTION_BEGIN
         CGRAPH_ASSERT_INIT(false)    // 初始化之前，设置参数
-        CGRAPH_ASSERT_NOT_NULL(poolTaskQueue, poolThreads, config)
+        CGRAPH_ASSERT_NOT_NULL(poolTaskQueue, poolThreads, poolCounter, config)
 
         this->index_ = index;
         this->pool_task_queue_ = poolTaskQueue;
         this->pool_threads_ = poolThreads;
+        this->pool_counter_ = poolCounter;
         this->config_ = config;
+        prepareLatency();
         CGRAPH_FUNCTION_END
     }
 
@@ -83,14 +96,32 @@ protected:
             CGRAPH_RETURN_ERROR_STATUS("primary thread is null")
         }
 
+        current() = this;    // 记录当前线程对应的 primary 线程，用于本线程内部提交任务的时候，快速定位
+        CGRAPH_TRACE_THREAD_NAME("primary-" + std::to_string(index_))
+        CGRAPH_TRACE(THREAD_START, index_, 1)
         loopProcess();
+        CGRAPH_TRACE(THREAD_EXIT, index_, 1)
+        current() = nullptr;
         CGRAPH_FUNCTION_END
     }
 
 
+    /**
+     * 获取当前线程对应的 primary 线程。非 primary 线程中调用，返回 nullptr
+     * @return
+     */
+    static UThreadPrimary*& current() {
+        static thread_local UThreadPrimary* cur = nullptr;
+        return cur;
+    }
+
+
     CVoid processTask() override {
         UTask task;
-        if (popTask(task) || stealTask(task) || popPoolTask(task)) {
+        if (popLaneTask(task, UTaskLane::URGENT) || popLaneTask(task, UTaskLane::HIGH)
+            || popExternalTask(task) || popTask(task) || stealTask(task) || popPoolTask(task)
+            || popLaneTask(task, UTaskLane::BACKGROUND)) {
+            finishIdle();
             runTask(task);
         } else {
             fatWait();
@@ -99,9 +130,13 @@ protected:
 
 
     CVoid processTasks() override {
-        UTaskArr tasks;
-        if (popTask(tasks) || stealTask(tasks) || popPoolTask(tasks)) {
+        UTaskArr& tasks = batch_tasks_;
+        if (popLaneTask(tasks, UTaskLane::URGENT) || popLaneTask(tasks, UTaskLane::HIGH)
+            || popExternalTask(tasks) || popTask(tasks) || stealTask(tasks) || popPoolTask(tasks)
+            || popLaneTask(tasks, UTaskLane::BACKGROUND)) {
             // 尝试从主线程中获取/盗取批量task，如果成功，则依次执行
+            finishIdle();
+            addLocalCount(batch_num_, 1);
             runTasks(tasks);
         } else {
             fatWait();
@@ -110,17 +145,67 @@ protected:
 
 
     /**
-     * 如果总是进入无task的状态，则开始休眠
-     * 休眠一定时间后，然后恢复执行状态，避免出现异常情况导致无法唤醒
+     * 如果总是进入无task的状态，则根据等待策略自旋之后，开始休眠，直到有新的任务写入
+     * 先登记为等待状态，再检查一次是否有任务，保证在检查和休眠之间写入的任务，不会被错过
      */
     CVoid fatWait() {
-        cur_empty_epoch_++;
-        CGRAPH_YIELD();
-        if (cur_empty_epoch_ >= config_->primary_thread_busy_epoch_) {
-            CGRAPH_UNIQUE_LOCK lk(mutex_);
-            cv_.wait_for(lk, std::chrono::milliseconds(config_->primary_thread_empty_interval_));
-            cur_empty_epoch_ = 0;
+        if (spinWait()) {
+            return;
+        }
+
+        if (steal_skipped_) {
+            /**
+             * 本轮因为退避跳过了盗取，则休眠之前，先完整的盗取一次
+             * 防止相邻线程中还有任务的时候，当前线程进入休眠
+             */
+            steal_backoff_left_ = 0;
+            return;
+        }
+
+        auto key = event_.prepareWait();
+        pool_counter_->idle_num_.fetch_add(1, std::memory_order_seq_cst);
+        if (!done_.load(std::memory_order_acquire) || hasTask()) {
+            event_.cancelWait();
+        } else {
+            parkWait(key, config_->primary_thread_empty_interval_);
+        }
+        pool_counter_->idle_num_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+
+    /**
+     * 获取当前线程中，普通任务的大致个数。用于分发任务时，选择较空闲的线程
+     * @return
+     */
+    CSize getTaskSize() const {
+        return primary_queue_.size() + secondary_queue_.size();
+    }
+
+
+    CVoid collectStats(UThreadStats& stats) const override {
+        UThreadBase::collectStats(stats);
+        stats.index_ = index_;
+        stats.steal_task_num_ = steal_task_num_.load(std::memory_order_relaxed);
+        stats.steal_attempt_num_ = steal_attempt_num_.load(std::memory_order_relaxed);
+        stats.steal_success_num_ = steal_success_num_.load(std::memory_order_relaxed);
+        for (CInt i = 0; i < CGRAPH_STEAL_DISTANCE_SIZE; i++) {
+            stats.steal_distance_num_[i] = steal_distance_num_[i].load(std::memory_order_relaxed);
         }
+        stats.queue_size_ = getTaskSize() + urgent_queue_.size() + high_queue_.size() + background_queue_.size();
+
+        // 本地获取的次数最多，不单独计数，通过其他来源的个数推算。已经获取但还未执行完的任务，可能导致推算值略小
+        CULong otherNum = stats.pool_pop_num_ + stats.steal_task_num_;
+        stats.local_pop_num_ = stats.task_num_ > otherNum ? stats.task_num_ - otherNum : 0;
+    }
+
+
+    /**
+     * 判断当前线程是否有可以执行的任务
+     * @return
+     */
+    CBool hasTask() {
+        return !primary_queue_.empty() || !secondary_queue_.empty() || !pool_task_queue_->empty()
+               || !urgent_queue_.empty() || !high_queue_.empty() || !background_queue_.empty();
     }
 
 
@@ -134,8 +219,64 @@ protected:
                  || secondary_queue_.tryPush(std::move(task)))) {
             CGRAPH_YIELD();
         }
-        cur_empty_epoch_ = 0;
-        cv_.notify_one();
+        CGRAPH_TRACE(ENQUEUE, index_, 1)
+        event_.notify();
+        checkRetired();
+    }
+
+
+    /**
+     * 当前线程执行的任务中，提交的子任务直接写入本地双端队列的底部，无锁
+     * 下一次从本地获取的时候，优先执行最新写入的任务（LIFO），此时相关数据大概率还在缓存中
+     * 同时唤醒一个可以盗取当前线程任务的空闲线程，防止当前任务阻塞等待子任务结果的时候，子任务无法被执行
+     * @param task
+     * @notice 仅允许当前线程调用
+     */
+    CVoid pushLocalTask(UTask&& task) {
+        primary_queue_.pushLocal(std::move(task));
+        CGRAPH_TRACE(ENQUEUE, index_, 1)
+        wakeupNeighbor();
+    }
+
+
+    /**
+     * 写入非 NORMAL 通道的任务。当前线程中提交的任务，无锁写入，并唤醒相邻线程来盗取
+     * 先增加通道的任务计数，再写入任务，保证计数不小于实际的任务个数
+     * @param task
+     * @param lane
+     */
+    CVoid pushLaneTask(UTask&& task, UTaskLane lane) {
+        auto& queue = laneQueue(lane);
+        pool_counter_->lane_task_num_[(CInt)lane].fetch_add(1, std::memory_order_acq_rel);
+        CGRAPH_TRACE(ENQUEUE, index_, 1)
+        if (current() == this) {
+            queue.pushLocal(std::move(task));
+            wakeupNeighbor();
+        } else {
+            queue.push(std::move(task));
+            event_.notify();
+            checkRetired();
+        }
+    }
+
+
+    /**
+     * 批量写入任务，仅加锁一次，并且仅唤醒一次当前线程
+     * @tparam Iterator
+     * @param begin
+     * @param end
+     * @return
+     */
+    template<typename Iterator>
+    CVoid pushTasks(Iterator begin, Iterator end) {
+        if (begin == end) {
+            return;
+        }
+
+        CGRAPH_TRACE(ENQUEUE, index_, std::distance(begin, end))
+        primary_queue_.pushBulk(begin, end);
+        event_.notify();
+        checkRetired();
     }
 
 
@@ -148,13 +289,212 @@ protected:
      */
     CVoid pushTask(UTask&& task, CBool enable, CBool lockable) {
         secondary_queue_.push(std::move(task), enable, lockable);    // 通过 second 写入，主要是方便其他的thread 进行steal操作
+        CGRAPH_TRACE(ENQUEUE, index_, 1)
         if (enable && !lockable) {
-            cur_empty_epoch_ = 0;
-            cv_.notify_one();
+            event_.notify();
+            checkRetired();
+        }
+    }
+
+
+    /**
+     * 唤醒一个可以盗取当前线程任务的空闲 primary 线程，按照拓扑距离由近到远尝试
+     * 这些线程都在忙碌的时候，不额外唤醒，由它们空闲之后盗取
+     */
+    CVoid wakeupNeighbor() {
+        const CInt primaryNum = pool_counter_->primary_num_.load(std::memory_order_relaxed);
+        for (CInt thief : thieves_) {
+            if (thief < primaryNum && (*pool_threads_)[thief]->wakeup()) {
+                break;
+            }
         }
     }
 
 
+    /**
+     * 回收当前线程：停止执行之后，将剩余的任务转移到 pool 的通用队列中
+     * 先标记为已回收，再停止和转移。和外部写入之后的 checkRetired() 配合，保证任务不会遗留在被回收的线程中
+     * @return
+     * @notice 不可以在当前线程中调用
+     */
+    CSize retire() {
+        is_retired_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        reset();
+        return drainTasks();
+    }
+
+
+    /**
+     * 外部写入任务之后调用（需要在 event_.notify() 的 seq_cst fence 之后）
+     * 如果写入的时候，当前线程已经被回收，则由写入方将任务转移到 pool 的通用队列中
+     */
+    CVoid checkRetired() {
+        if (unlikely(is_retired_.load(std::memory_order_relaxed))) {
+            drainTasks();
+        }
+    }
+
+
+    /**
+     * 将所有队列中的任务，转移到 pool 的通用队列中，并唤醒相应个数的 primary 线程
+     * 仅通过盗取的方式获取任务，可以和其他线程的写入、盗取同时进行。通道中的任务，转移后按照普通任务执行
+     * @return 转移的任务个数
+     */
+    CSize drainTasks() {
+        CSize result = 0;
+        for (CInt lane = 0; lane < CGRAPH_TASK_LANE_SIZE; lane++) {
+            result += drainQueue(laneQueue((UTaskLane)lane), (UTaskLane)lane);
+        }
+        result += drainQueue(secondary_queue_, UTaskLane::NORMAL);
+
+        CInt primaryNum = pool_counter_->primary_num_.load(std::memory_order_relaxed);
+        for (CInt i = 0; i < primaryNum && (CSize)i < result; i++) {
+            (*pool_threads_)[i]->wakeup();
+        }
+        return result;
+    }
+
+
+    /**
+     * 将单个队列中的任务，转移到 pool 的通用队列中
+     * inbox 的锁被其他线程持有的时候，可能盗取失败。重试一定次数之后放弃，由持有锁的写入方在写入后转移
+     * @param queue
+     * @param lane
+     * @return
+     */
+    CSize drainQueue(UWorkStealingQueue<UTask>& queue, UTaskLane lane) {
+        CSize result = 0;
+        UTask task;
+        for (CInt retry = 0; !queue.empty() && retry < CGRAPH_RETIRE_DRAIN_RETRY_TIMES; ) {
+            if (queue.trySteal(task)) {
+                if (UTaskLane::NORMAL != lane) {
+                    pool_counter_->lane_task_num_[(CInt)lane].fetch_sub(1, std::memory_order_acq_rel);
+                }
+                pool_task_queue_->push(std::move(task));
+                if (config_->elastic_enable_) {
+                    pool_counter_->pool_push_num_.fetch_add(1, std::memory_order_relaxed);
+                }
+                result++;
+            } else {
+                retry++;
+                CGRAPH_YIELD();
+            }
+        }
+        return result;
+    }
+
+
+    /**
+     * 从非 NORMAL 通道中获取任务。先从本地获取，再从盗取目标的相同通道中盗取
+     * 整个线程池中，对应通道没有任务的时候，仅有一次原子读的开销
+     * @param task
+     * @param lane
+     * @return
+     */
+    CBool popLaneTask(UTaskRef task, UTaskLane lane) {
+        auto& laneNum = pool_counter_->lane_task_num_[(CInt)lane];
+        if (likely(laneNum.load(std::memory_order_acquire) <= 0)) {
+            return false;
+        }
+
+        CBool result = laneQueue(lane).tryPop(task);
+        if (result) {
+            CGRAPH_TRACE(DEQUEUE, index_, 1)
+        }
+        for (CSize i = 0; !result && i < steal_targets_.size(); i++) {
+            auto* target = (*pool_threads_)[steal_targets_[i]];
+            result = target && target->laneQueue(lane).trySteal(task);
+            if (result) {
+                addLocalCount(steal_task_num_, 1);
+                CGRAPH_TRACE(STEAL, steal_targets_[i], 1)
+            }
+        }
+
+        if (result) {
+            laneNum.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        return result;
+    }
+
+
+    /**
+     * 从非 NORMAL 通道中获取任务，放入批量任务中
+     * @param tasks
+     * @param lane
+     * @return
+     */
+    CBool popLaneTask(UTaskArrRef tasks, UTaskLane lane) {
+        UTask task;
+        CBool result = popLaneTask(task, lane);
+        if (result) {
+            tasks.emplace_back(std::move(task));
+        }
+        return result;
+    }
+
+
+    /**
+     * 获取通道对应的队列。NORMAL 通道，对应 primary_queue_
+     * @param lane
+     * @return
+     */
+    UWorkStealingQueue<UTask>& laneQueue(UTaskLane lane) {
+        switch (lane) {
+            case UTaskLane::URGENT: return urgent_queue_;
+            case UTaskLane::HIGH: return high_queue_;
+            case UTaskLane::BACKGROUND: return background_queue_;
+            default: return primary_queue_;
+        }
+    }
+
+
+    /**
+     * 每获取一定次数的任务，优先获取一次外部写入的任务（pool 队列中的任务，和其他线程写入当前线程的任务）
+     * 防止递归提交的场景中，本地任务源源不断，导致外部任务一直得不到执行
+     * @param task
+     * @return
+     */
+    CBool popExternalTask(UTaskRef task) {
+        if (likely(++fair_tick_ < CGRAPH_PRIMARY_FAIR_INTERVAL)) {
+            return false;
+        }
+
+        fair_tick_ = 0;
+        if (popPoolTask(task)) {
+            return true;
+        }
+
+        CBool result = primary_queue_.tryPopExternal(task);
+        if (result) {
+            CGRAPH_TRACE(DEQUEUE, index_, 1)
+        }
+        return result;
+    }
+
+
+    /**
+     * 批量获取外部写入的任务
+     * @param tasks
+     * @return
+     */
+    CBool popExternalTask(UTaskArrRef tasks) {
+        if (likely(++fair_tick_ < CGRAPH_PRIMARY_FAIR_INTERVAL)) {
+            return false;
+        }
+
+        fair_tick_ = 0;
+        CBool result = popPoolTask(tasks);
+        UTask task;
+        if (!result && primary_queue_.tryPopExternal(task)) {
+            tasks.emplace_back(std::move(task));
+            CGRAPH_TRACE(DEQUEUE, index_, 1)
+            result = true;
+        }
+        return result;
+    }
+
+
     /**
      * 从本地弹出一个任务
      * @param task
@@ -162,6 +502,9 @@ protected:
      */
     CBool popTask(UTaskRef task) {
         auto result = primary_queue_.tryPop(task) || secondary_queue_.tryPop(task);
+        if (result) {
+            CGRAPH_TRACE(DEQUEUE, index_, 1)
+        }
         return result;
     }
 
@@ -178,6 +521,9 @@ protected:
             // 如果凑齐了，就不需要了。没凑齐的话，就继续
             result |= (secondary_queue_.tryPop(tasks, leftSize));
         }
+        if (result) {
+            CGRAPH_TRACE(DEQUEUE, index_, tasks.size())
+        }
         return result;
     }
 
@@ -188,25 +534,33 @@ protected:
      * @return
      */
     CBool stealTask(UTaskRef task) {
-        if (unlikely(pool_threads_->size() < (CSize)(config_->default_thread_size_))) {
-            /**
-             * 线程池还未初始化完毕的时候，无法进行steal。
-             * 确保程序安全运行。
-             */
-            return false;
+        refreshStealTargets();
+
+        if (config_->steal_half_enable_) {
+            CBool result = stealHalfTask();
+            if (result) {
+                task = std::move(steal_buffer_.front());
+                spreadStolenTask(1);
+                addLocalCount(steal_task_num_, 1);
+            }
+            return result;
         }
 
         /**
          * 窃取的时候，仅从相邻的primary线程中窃取
          * 待窃取相邻的数量，不能超过默认primary线程数
          */
+        addLocalCount(steal_attempt_num_, 1);
         CBool result = false;
-        for (auto& target : steal_targets_) {
+        CSize probeSize = calcStealProbeSize();
+        CSize pos = 0;
+        for (; pos < probeSize; pos++) {
             /**
             * 从线程中周围的thread中，窃取任务。
             * 如果成功，则返回true，并且执行任务。
              * steal 的时候，先从第二个队列里偷，从而降低触碰锁的概率
             */
+            auto target = steal_targets_[pos];
             if (likely((*pool_threads_)[target])
                 && (((*pool_threads_)[target])->secondary_queue_.trySteal(task)
                     || ((*pool_threads_)[target])->primary_queue_.trySteal(task))) {
@@ -215,6 +569,11 @@ protected:
             }
         }
 
+        recordSteal(result, pos);
+        if (result) {
+            addLocalCount(steal_task_num_, 1);
+            CGRAPH_TRACE(STEAL, steal_targets_[pos], 1)
+        }
         return result;
     }
 
@@ -225,12 +584,27 @@ protected:
      * @return
      */
     CBool stealTask(UTaskArrRef tasks) {
-        if (unlikely(pool_threads_->size() != (CSize)(config_->default_thread_size_))) {
-            return false;
+        refreshStealTargets();
+
+        if (config_->steal_half_enable_) {
+            CBool result = stealHalfTask();
+            if (result) {
+                CSize keepSize = (std::min)(steal_buffer_.size(), (CSize)config_->max_steal_batch_size_);
+                keepSize = (0 == keepSize) ? 1 : keepSize;
+                std::move(steal_buffer_.begin(), steal_buffer_.begin() + keepSize, std::back_inserter(tasks));
+                spreadStolenTask(keepSize);
+                addLocalCount(steal_task_num_, keepSize);
+            }
+            return result;
         }
 
+        addLocalCount(steal_attempt_num_, 1);
+        const CSize size = tasks.size();
         CBool result = false;
-        for (auto& target : steal_targets_) {
+        CSize probeSize = calcStealProbeSize();
+        CSize pos = 0;
+        for (; pos < probeSize; pos++) {
+            auto target = steal_targets_[pos];
             if (likely((*pool_threads_)[target])) {
                 result = ((*pool_threads_)[target])->secondary_queue_.trySteal(tasks, config_->max_steal_batch_size_);
                 auto leftSize = config_->max_steal_batch_size_ - tasks.size();
@@ -250,30 +624,246 @@ protected:
             }
         }
 
+        recordSteal(result, pos);
+        if (result) {
+            addLocalCount(steal_task_num_, tasks.size() - size);
+            CGRAPH_TRACE(STEAL, steal_targets_[pos], tasks.size() - size)
+        }
+        return result;
+    }
+
+
+    /**
+     * 折半盗取：从随机的目标开始，依次尝试盗取目标队列中一半的任务，避免多个空闲线程总是盗取同一个目标
+     * 距离相同的目标中随机选择起点，距离较近的目标仍然优先盗取
+     * 连续失败的时候，跳过的盗取轮数指数增长（不超过 CGRAPH_MAX_STEAL_BACKOFF），成功之后重置
+     * 盗取到的任务，暂存在 steal_buffer_ 中
+     * @return
+     */
+    CBool stealHalfTask() {
+        if (steal_backoff_left_ > 0) {
+            steal_backoff_left_--;
+            steal_skipped_ = true;
+            return false;
+        }
+
+        steal_skipped_ = false;
+        CSize probeSize = calcStealProbeSize();
+        if (0 == probeSize) {
+            return false;
+        }
+
+        addLocalCount(steal_attempt_num_, 1);
+        CBool result = false;
+        CSize pos = 0;
+        for (CSize begin = 0, end = 0; begin < probeSize && !result; begin = end) {
+            end = begin;
+            while (end < probeSize && steal_distances_[end] == steal_distances_[begin]) {
+                end++;
+            }
+
+            CSize groupSize = end - begin;
+            CSize start = CGRAPH_FAST_RANDOM() % groupSize;
+            for (CSize i = 0; i < groupSize && !result; i++) {
+                pos = begin + (start + i) % groupSize;
+                auto* target = (*pool_threads_)[steal_targets_[pos]];
+                result = target && (target->secondary_queue_.tryStealHalf(steal_buffer_)
+                                    || target->primary_queue_.tryStealHalf(steal_buffer_));
+            }
+        }
+
+        recordSteal(result, pos);
+        if (result) {
+            CGRAPH_TRACE(STEAL, steal_targets_[pos], steal_buffer_.size())
+            steal_backoff_ = 0;
+        } else {
+            steal_backoff_ = (0 == steal_backoff_) ? 1
+                             : (steal_backoff_ * 2 > CGRAPH_MAX_STEAL_BACKOFF ? CGRAPH_MAX_STEAL_BACKOFF : steal_backoff_ * 2);
+            steal_backoff_left_ = steal_backoff_;
+        }
         return result;
     }
 
 
+    /**
+     * 本轮需要尝试的盗取目标个数。连续失败 CGRAPH_REMOTE_STEAL_FAIL_TIMES 轮之后，才会尝试其他 NUMA 节点上的目标
+     * @return
+     */
+    CSize calcStealProbeSize() const {
+        return steal_fail_times_ >= CGRAPH_REMOTE_STEAL_FAIL_TIMES ? steal_targets_.size() : local_steal_size_;
+    }
+
+
+    /**
+     * 记录盗取的结果
+     * @param result
+     * @param pos 盗取成功的时候，对应目标在 steal_targets_ 中的位置
+     */
+    CVoid recordSteal(CBool result, CSize pos) {
+        if (result) {
+            addLocalCount(steal_success_num_, 1);
+            addLocalCount(steal_distance_num_[(CInt)steal_distances_[pos]], 1);
+            steal_fail_times_ = 0;
+        } else if (steal_fail_times_ < CGRAPH_REMOTE_STEAL_FAIL_TIMES) {
+            steal_fail_times_++;
+        }
+    }
+
+
+    /**
+     * 将折半盗取到的任务中，从 begin 开始的部分写入本地队列，并唤醒相邻线程
+     * 防止盗取到的任务，全部由当前线程串行执行
+     * @param begin
+     */
+    CVoid spreadStolenTask(CSize begin) {
+        for (CSize i = begin; i < steal_buffer_.size(); i++) {
+            primary_queue_.pushLocal(std::move(steal_buffer_[i]));
+        }
+        if (steal_buffer_.size() > begin) {
+            wakeupNeighbor();
+        }
+        steal_buffer_.clear();
+    }
+
+
+    /**
+     * 主线程个数发生变化之后，重新构造盗取目标
+     * 盗取目标仅在当前线程中读写，因此重新构造的时候，不会和其他线程的盗取冲突
+     * 被回收的线程对象不会被释放，仍在旧的盗取目标中的时候，也可以安全访问
+     */
+    CVoid refreshStealTargets() {
+        if (unlikely(pool_counter_->primary_num_.load(std::memory_order_acquire) != steal_primary_num_)) {
+            buildStealTargets();
+        }
+    }
+
+
     /**
      * 构造 steal 范围的 target，避免每次盗取的时候，重复计算
+     * 开启绑定cpu模式的时候，按照拓扑距离排序：同一物理核的超线程、共享末级缓存、同一 NUMA 节点、其他 NUMA 节点
+     * 距离相同的时候，按照 index 相邻的顺序。未开启绑定的时候，距离均视为相同
+     * 同时记录盗取范围中包含当前线程的其他线程，用于 wakeupNeighbor()
      * @return
      */
     CVoid buildStealTargets() {
+        steal_primary_num_ = pool_counter_->primary_num_.load(std::memory_order_acquire);
+        const CInt threadSize = steal_primary_num_;
+        const CInt stealRange = config_->calcStealRange(threadSize);
+        std::vector<CInt> cpus;
+        if (config_->bind_cpu_enable_) {
+            cpus = UCpuTopology::get().calcBindCpus(config_->bind_cpu_policy_, config_->bind_cpu_list_);
+        }
+
+        const auto& candidates = calcStealCandidates(cpus, index_, threadSize);
         steal_targets_.clear();
-        for (int i = 0; i < config_->calcStealRange(); i++) {
-            auto target = (index_ + i + 1) % config_->default_thread_size_;
-            steal_targets_.push_back(target);
+        steal_distances_.clear();
+        local_steal_size_ = 0;
+        for (int i = 0; i < stealRange && i < (int)candidates.size(); i++) {
+            steal_distances_.push_back(candidates[i].first);
+            steal_targets_.push_back(candidates[i].second);
+            local_steal_size_ += (UStealDistance::REMOTE_NODE != candidates[i].first) ? 1 : 0;
         }
         steal_targets_.shrink_to_fit();
+        steal_distances_.shrink_to_fit();
+
+        // 距离相同的时候，优先唤醒更早尝试盗取当前线程的
+        std::vector<std::pair<std::pair<UStealDistance, CInt>, CInt>> thieves;
+        for (const auto& candidate : candidates) {
+            const auto& peerCandidates = calcStealCandidates(cpus, candidate.second, threadSize);
+            for (int i = 0; i < stealRange && i < (int)peerCandidates.size(); i++) {
+                if (index_ == peerCandidates[i].second) {
+                    thieves.emplace_back(std::make_pair(candidate.first, i), candidate.second);
+                    break;
+                }
+            }
+        }
+        std::stable_sort(thieves.begin(), thieves.end());
+        thieves_.clear();
+        for (const auto& thief : thieves) {
+            thieves_.push_back(thief.second);
+        }
+        thieves_.shrink_to_fit();
+    }
+
+
+    /**
+     * 计算 index 对应的线程，其他所有线程作为盗取目标的顺序
+     * @param cpus 主线程依次绑定的cpu，为空表示未开启绑定
+     * @param index
+     * @param threadSize
+     * @return 按照拓扑距离由近到远排序的 <距离, 目标>
+     */
+    std::vector<std::pair<UStealDistance, CInt>> calcStealCandidates(const std::vector<CInt>& cpus,
+                                                                     CInt index, CInt threadSize) const {
+        std::vector<std::pair<UStealDistance, CInt>> candidates;
+        for (int i = 1; i < threadSize; i++) {
+            auto target = (index + i) % threadSize;
+            candidates.emplace_back(calcStealDistance(cpus, index, target), target);
+        }
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const std::pair<UStealDistance, CInt>& a, const std::pair<UStealDistance, CInt>& b) {
+                             return a.first < b.first;
+                         });
+        return candidates;
+    }
+
+
+    /**
+     * 计算两个线程之间的拓扑距离
+     * @param cpus 主线程依次绑定的cpu，为空表示未开启绑定
+     * @param index
+     * @param target
+     * @return
+     */
+    UStealDistance calcStealDistance(const std::vector<CInt>& cpus, CInt index, CInt target) const {
+        if (cpus.empty()) {
+            return UStealDistance::SAME_NODE;
+        }
+
+        const auto& topology = UCpuTopology::get();
+        const UCpuInfo* cur = topology.findCpu(cpus[index % cpus.size()]);
+        const UCpuInfo* other = topology.findCpu(cpus[target % cpus.size()]);
+        if (nullptr == cur || nullptr == other) {
+            return UStealDistance::SAME_NODE;
+        }
+
+        if (cur->core_id_ == other->core_id_) {
+            return UStealDistance::SMT_SIBLING;
+        } else if (cur->llc_id_ == other->llc_id_) {
+            return UStealDistance::SHARED_CACHE;
+        } else if (cur->node_id_ == other->node_id_) {
+            return UStealDistance::SAME_NODE;
+        }
+        return UStealDistance::REMOTE_NODE;
     }
 
 private:
-    CInt index_;                                                   // 线程index
-    CInt cur_empty_epoch_ = 0;                                     // 当前空转的轮数信息
+    /** 写入任务的其他线程读取，很少变化。队列内部按照读写的线程，分别放在不同的缓存行中 */
+    alignas(CGRAPH_CACHE_LINE_SIZE) CInt index_;                  // 线程index
+    std::vector<UThreadPrimary *>* pool_threads_;                  // 用于存放线程池中的线程信息
+    std::atomic<CBool> is_retired_ {false};                        // 是否已经被回收
     UWorkStealingQueue<UTask> primary_queue_;                      // 内部队列信息
     UWorkStealingQueue<UTask> secondary_queue_;                    // 第二个队列，用于减少触锁概率，提升性能
-    std::vector<UThreadPrimary *>* pool_threads_;                  // 用于存放线程池中的线程信息
-    std::vector<CInt> steal_targets_;                              // 被偷的目标信息
+    UWorkStealingQueue<UTask> urgent_queue_;                       // URGENT 通道的队列
+    UWorkStealingQueue<UTask> high_queue_;                         // HIGH 通道的队列
+    UWorkStealingQueue<UTask> background_queue_;                   // BACKGROUND 通道的队列，其他任务都执行完之后才执行
+
+    /** 仅本线程频繁读写。盗取次数的统计信息，其他线程很少读取 */
+    alignas(CGRAPH_CACHE_LINE_SIZE) CInt fair_tick_ = 0;          // 距离上一次优先获取外部任务的轮数
+    std::vector<CInt> steal_targets_;                              // 被偷的目标信息，按照拓扑距离由近到远排序
+    std::vector<UStealDistance> steal_distances_;                  // 每个被偷目标和当前线程之间的拓扑距离
+    CSize local_steal_size_ = 0;                                   // 非其他 NUMA 节点的被偷目标个数，排在 steal_targets_ 的前面
+    std::vector<CInt> thieves_;                                    // 盗取目标中包含当前线程的其他线程，按照拓扑距离由近到远排序
+    CInt steal_fail_times_ = 0;                                    // 连续盗取失败的轮数
+    CInt steal_primary_num_ = 0;                                   // 构造盗取目标时的主线程个数
+    UTaskArr steal_buffer_;                                        // 折半盗取时，暂存盗取到的任务
+    CInt steal_backoff_ = 0;                                       // 折半盗取连续失败时，当前的退避轮数
+    CInt steal_backoff_left_ = 0;                                  // 折半盗取时，剩余需要跳过的盗取轮数
+    CBool steal_skipped_ = false;                                  // 最近一轮是否因为退避，跳过了盗取
+    std::atomic<CULong> steal_task_num_ {0};                       // 通过盗取获取并执行的任务个数，仅本线程写入
+    std::atomic<CULong> steal_attempt_num_ {0};                    // 盗取尝试的次数，仅本线程写入
+    std::atomic<CULong> steal_success_num_ {0};                    // 盗取成功的次数，仅本线程写入
+    std::atomic<CULong> steal_distance_num_[CGRAPH_STEAL_DISTANCE_SIZE] {};    // 按照拓扑距离，分别记录盗取成功的次数
 
     friend class UThreadPool;
     friend class CAllocator;
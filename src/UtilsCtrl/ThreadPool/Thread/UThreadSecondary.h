@@ -28,9 +28,12 @@ protected:
         CGRAPH_ASSERT_NOT_NULL(config_)
 
         cur_ttl_ = config_->secondary_thread_ttl_;
+        reserveBatchTasks();
+        markStart();
         is_init_ = true;
         thread_ = std::thread(&UThreadSecondary::run, this);
         setSchedParam();
+        setAffinity(CGRAPH_SECONDARY_THREAD_COMMON_ID);
         CGRAPH_FUNCTION_END
     }
 
@@ -39,19 +42,24 @@ protected:
      * 设置pool的信息
      * @param poolTaskQueue
      * @param poolPriorityTaskQueue
+     * @param poolCounter
      * @param config
      * @return
      */
-    CStatus setThreadPoolInfo(UAtomicQueue<UTask>* poolTaskQueue,
+    CStatus setThreadPoolInfo(UPoolTaskQueue<UTask>* poolTaskQueue,
                               UAtomicPriorityQueue<UTask>* poolPriorityTaskQueue,
+                              UThreadCounter* poolCounter,
                               UThreadPoolConfigPtr config) {
         CGRAPH_FUNCTION_BEGIN
         CGRAPH_ASSERT_INIT(false)    // 初始化之前，设置参数
-        CGRAPH_ASSERT_NOT_NULL(poolTaskQueue, poolPriorityTaskQueue, config)
+        CGRAPH_ASSERT_NOT_NULL(poolTaskQueue, poolPriorityTaskQueue, poolCounter, config)
 
         this->pool_task_queue_ = poolTaskQueue;
         this->pool_priority_task_queue_ = poolPriorityTaskQueue;
+        this->pool_counter_ = poolCounter;
         this->config_ = config;
+        this->park_event_ = &poolCounter->secondary_event_;
+        prepareLatency();
         CGRAPH_FUNCTION_END
     }
 
@@ -60,7 +68,10 @@ protected:
         CGRAPH_FUNCTION_BEGIN
         CGRAPH_ASSERT_INIT(true)
 
+        CGRAPH_TRACE_THREAD_NAME("secondary")
+        CGRAPH_TRACE(THREAD_START, CGRAPH_SECONDARY_THREAD_COMMON_ID, 1)
         loopProcess();
+        CGRAPH_TRACE(THREAD_EXIT, CGRAPH_SECONDARY_THREAD_COMMON_ID, 1)
         CGRAPH_FUNCTION_END
     }
 
@@ -68,35 +79,53 @@ protected:
     CVoid processTask() override {
         UTask task;
         if (popPoolTask(task)) {
+            finishIdle();
             runTask(task);
-        } else {
-            // 如果单次无法获取，则稍加等待
+        } else if (!spinWait()) {
+            // 如果自旋之后仍无法获取，则稍加等待
             waitRunTask(config_->queue_emtpy_interval_);
         }
     }
 
 
     CVoid processTasks() override {
-        UTaskArr tasks;
+        UTaskArr& tasks = batch_tasks_;
         if (popPoolTask(tasks)) {
+            finishIdle();
+            addLocalCount(batch_num_, 1);
             runTasks(tasks);
-        } else {
+        } else if (!spinWait()) {
             waitRunTask(config_->queue_emtpy_interval_);
         }
     }
 
 
     /**
-     * 有等待的执行任务
+     * 有等待的执行任务。休眠直到有新的普通任务或者优先级任务写入，或者超时
+     * 先登记为等待状态，再检查一次是否有任务，保证在检查和休眠之间写入的任务，不会被错过
+     * 所有 secondary 线程在同一个事件上休眠，写入任务之后，每通知一次唤醒其中一个
      * @param ms
      * @return
      * @notice 目的是降低cpu的占用率
      */
     CVoid waitRunTask(CMSec ms) {
-        auto task = this->pool_task_queue_->popWithTimeout(ms);
-        if (nullptr != task) {
-            runTask(*task);
+        auto key = park_event_->prepareWait();
+        pool_counter_->secondary_idle_num_.fetch_add(1, std::memory_order_seq_cst);
+        if (!done_.load(std::memory_order_acquire) || hasTask()) {
+            park_event_->cancelWait();
+        } else {
+            parkWait(key, ms);
         }
+        pool_counter_->secondary_idle_num_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+
+    /**
+     * 判断线程池中是否有可以执行的任务
+     * @return
+     */
+    CBool hasTask() {
+        return !pool_task_queue_->empty() || !pool_priority_task_queue_->empty();
     }
 
 
@@ -0,0 +1,215 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: UCpuQuota.h
+@Time: 2026/10/17 14:05
+@Desc: 当前进程可以使用的cpu个数，用于容器中自动设置线程个数
+ * 1. cpuset 限制：通过 sched_getaffinity 获取，容器的 cpuset 会体现在其中
+ * 2. cpu 配额限制：读取 cgroup v2 的 cpu.max，或 cgroup v1 的 cpu.cfs_quota_us / cpu.cfs_period_us，并向上取整
+ * 3. 取两者中较小的值。非 linux 系统中，返回 hardware_concurrency
+***************************/
+
+#ifndef CGRAPH_UCPUQUOTA_H
+#define CGRAPH_UCPUQUOTA_H
+
+#include <string>
+#include <cstdlib>
+#include <sstream>
+#include <fstream>
+    #if defined(__linux__) && !defined(__ANDROID__)
+#include <sched.h>
+    #endif
+
+#include "../UThreadObject.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+class UCpuQuota : public UThreadObject {
+public:
+    /**
+     * 计算当前进程可以使用的cpu个数。每次调用的时候，都会重新读取
+     * @return 至少为1
+     */
+    static CInt calcCpuLimit() {
+        CInt result = calcCpusetSize();
+        CInt quota = calcQuotaSize();
+        if (quota > 0 && quota < result) {
+            result = quota;
+        }
+        return result > 0 ? result : 1;
+    }
+
+
+    /**
+     * 获取 cpuset 中cpu的个数
+     * @return
+     */
+    static CInt calcCpusetSize() {
+        CInt result = CGRAPH_CPU_NUM;
+    #if defined(__linux__) && !defined(__ANDROID__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (0 == sched_getaffinity(0, sizeof(cpu_set_t), &mask)) {
+            result = CPU_COUNT(&mask);
+        }
+    #endif
+        return result;
+    }
+
+
+    /**
+     * 获取 cgroup 中cpu配额对应的cpu个数（向上取整）。各级 cgroup 中，取最小的配额
+     * @return 没有配额限制，或读取失败的时候，返回 0
+     */
+    static CInt calcQuotaSize() {
+        CInt result = 0;
+    #if defined(__linux__) && !defined(__ANDROID__)
+        result = calcQuotaSize("/proc/self/cgroup", "/sys/fs/cgroup");
+    #endif
+        return result;
+    }
+
+
+    /**
+     * 根据指定的 cgroup 信息文件和挂载点，获取配额对应的cpu个数。主要用于在测试中，读取构造的目录
+     * @param cgroupFile 格式和 /proc/self/cgroup 一致
+     * @param cgroupRoot cgroup 的挂载点，v1 的各个 controller 挂载在其下的子目录中
+     * @return 没有配额限制，或读取失败的时候，返回 0
+     */
+    static CInt calcQuotaSize(const std::string& cgroupFile, const std::string& cgroupRoot) {
+        CInt result = 0;
+        std::ifstream file(cgroupFile);
+        std::string line;
+        while (file.is_open() && std::getline(file, line)) {
+            // 每行的格式为 "hierarchy-id:controller-list:path"
+            CSize first = line.find(':');
+            CSize second = (std::string::npos == first) ? std::string::npos : line.find(':', first + 1);
+            if (std::string::npos == second) {
+                continue;
+            }
+
+            const std::string controllers = line.substr(first + 1, second - first - 1);
+            const std::string path = line.substr(second + 1);
+            CInt quota = 0;
+            if (controllers.empty()) {
+                quota = walkQuota(cgroupRoot, path, false);
+            } else if (hasController(controllers, "cpu")) {
+                quota = walkQuota(cgroupRoot + "/cpu,cpuacct", path, true);
+                quota = (quota > 0) ? quota : walkQuota(cgroupRoot + "/cpu", path, true);
+            }
+
+            if (quota > 0 && (0 == result || quota < result)) {
+                result = quota;
+            }
+        }
+        return result;
+    }
+
+private:
+    /**
+     * 从 cgroup 路径开始，逐级向上读取配额，直到挂载点
+     * 容器中，cgroup 路径可能在挂载点下不存在（cgroup namespace），此时仅读取挂载点
+     * @param mount
+     * @param path
+     * @param isV1
+     * @return
+     */
+    static CInt walkQuota(const std::string& mount, std::string path, CBool isV1) {
+        if (!isDirectory(mount + path)) {
+            path.clear();
+        }
+
+        CInt result = 0;
+        while (true) {
+            const std::string dir = mount + path;
+            CInt quota = isV1 ? readV1Quota(dir) : readV2Quota(dir);
+            if (quota > 0 && (0 == result || quota < result)) {
+                result = quota;
+            }
+
+            CSize pos = path.find_last_of('/');
+            if (path.empty() || std::string::npos == pos) {
+                break;
+            }
+            path = path.substr(0, pos);
+        }
+        return result;
+    }
+
+
+    /**
+     * 读取 cgroup v2 的 cpu.max，格式为 "quota period" 或 "max period"
+     * @param dir
+     * @return
+     */
+    static CInt readV2Quota(const std::string& dir) {
+        std::ifstream file(dir + "/cpu.max");
+        std::string quota;
+        long long period = 0;
+        if (!(file >> quota >> period) || "max" == quota || period <= 0) {
+            return 0;
+        }
+        return calcCeil(std::atoll(quota.c_str()), period);
+    }
+
+
+    /**
+     * 读取 cgroup v1 的 cpu.cfs_quota_us 和 cpu.cfs_period_us。quota 为 -1 表示不限制
+     * @param dir
+     * @return
+     */
+    static CInt readV1Quota(const std::string& dir) {
+        std::ifstream quotaFile(dir + "/cpu.cfs_quota_us");
+        std::ifstream periodFile(dir + "/cpu.cfs_period_us");
+        long long quota = 0;
+        long long period = 0;
+        if (!(quotaFile >> quota) || !(periodFile >> period) || period <= 0) {
+            return 0;
+        }
+        return calcCeil(quota, period);
+    }
+
+
+    /**
+     * 配额对应的cpu个数，向上取整
+     * @param quota
+     * @param period
+     * @return
+     */
+    static CInt calcCeil(long long quota, long long period) {
+        return quota > 0 ? (CInt)((quota + period - 1) / period) : 0;
+    }
+
+
+    /**
+     * 判断 controller 列表（逗号分隔）中，是否包含 name
+     * @param controllers
+     * @param name
+     * @return
+     */
+    static CBool hasController(const std::string& controllers, const std::string& name) {
+        std::stringstream ss(controllers);
+        std::string cur;
+        while (std::getline(ss, cur, ',')) {
+            if (cur == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    /**
+     * 判断是否为有效的 cgroup 目录
+     * @param path
+     * @return
+     */
+    static CBool isDirectory(const std::string& path) {
+        std::ifstream file(path + "/cgroup.procs");
+        return file.is_open();
+    }
+};
+
+CGRAPH_NAMESPACE_END
+
+#endif //CGRAPH_UCPUQUOTA_H
@@ -0,0 +1,340 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: UCpuTopology.h
+@Time: 2026/10/17 10:20
+@Desc: cpu拓扑信息，用于线程绑定cpu
+ * 1. linux 系统中，从 /sys/devices/system/cpu 和 /sys/devices/system/node 中读取超线程、末级缓存和 NUMA 节点信息
+ * 2. 仅记录当前进程允许使用（cpuset）的cpu
+ * 3. 其他系统，或者读取失败的时候，每个cpu视为一个独立的物理核
+***************************/
+
+#ifndef CGRAPH_UCPUTOPOLOGY_H
+#define CGRAPH_UCPUTOPOLOGY_H
+
+#include <map>
+#include <tuple>
+#include <cctype>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+    #if defined(__linux__) && !defined(__ANDROID__)
+#include <sched.h>
+#include <dirent.h>
+#include <pthread.h>
+    #endif
+
+#include "../UThreadObject.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+/** 单个逻辑cpu的拓扑信息 */
+struct UCpuInfo : public CStruct {
+    CInt cpu_id_ = 0;                  // 逻辑cpu编号
+    CInt core_id_ = 0;                 // 物理核编号（在整个系统中唯一，同一物理核上的超线程相同）
+    CInt smt_index_ = 0;               // 在物理核中的序号，0 表示物理核上的第一个超线程
+    CInt package_id_ = 0;              // 所在的cpu插槽编号
+    CInt llc_id_ = 0;                  // 共享的末级缓存（一般为L3）编号，取共享该缓存的最小cpu编号
+    CInt node_id_ = 0;                 // 所在的 NUMA 节点编号
+};
+
+class UCpuTopology : public UThreadObject {
+public:
+    /**
+     * 获取当前进程的cpu拓扑信息。第一次调用的时候读取，之后不再变化
+     * @return
+     */
+    static const UCpuTopology& get() {
+        static UCpuTopology topology;
+        return topology;
+    }
+
+
+    /**
+     * 获取当前进程可以使用的所有cpu，按照cpu编号排序
+     * @return
+     */
+    const std::vector<UCpuInfo>& getCpuList() const {
+        return cpus_;
+    }
+
+
+    /**
+     * 查找cpu的拓扑信息
+     * @param cpuId
+     * @return 不在当前进程可用范围内的时候，返回 nullptr
+     */
+    const UCpuInfo* findCpu(CInt cpuId) const {
+        auto iter = std::lower_bound(cpus_.begin(), cpus_.end(), cpuId,
+                                     [](const UCpuInfo& info, CInt id) { return info.cpu_id_ < id; });
+        return (iter != cpus_.end() && iter->cpu_id_ == cpuId) ? &(*iter) : nullptr;
+    }
+
+
+    /**
+     * 根据绑定策略，计算线程依次绑定的cpu。第 i 个主线程，绑定在第 (i % size) 个cpu上
+     * @param policy
+     * @param explicitCpus 仅 EXPLICIT 策略下生效。不在当前进程可用范围内的cpu会被忽略，全部无效的时候，按照 COMPACT 处理
+     * @return
+     */
+    std::vector<CInt> calcBindCpus(UCpuBindPolicy policy, const std::vector<CInt>& explicitCpus) const {
+        std::vector<CInt> result;
+        if (UCpuBindPolicy::EXPLICIT == policy) {
+            for (CInt cpu : explicitCpus) {
+                if (findCpu(cpu)) {
+                    result.push_back(cpu);
+                }
+            }
+            if (!result.empty()) {
+                return result;
+            }
+            policy = UCpuBindPolicy::COMPACT;
+        }
+
+        std::vector<UCpuInfo> ordered = cpus_;
+        switch (policy) {
+            case UCpuBindPolicy::SCATTER: {
+                /** 每个 NUMA 节点内部，先分散到不同的物理核上，再使用超线程。然后各节点之间轮流选择 */
+                std::sort(ordered.begin(), ordered.end(), [](const UCpuInfo& a, const UCpuInfo& b) {
+                    return std::make_tuple(a.node_id_, a.smt_index_, a.llc_id_, a.core_id_, a.cpu_id_)
+                           < std::make_tuple(b.node_id_, b.smt_index_, b.llc_id_, b.core_id_, b.cpu_id_);
+                });
+                std::map<CInt, std::vector<CInt>> nodeCpus;
+                for (const auto& info : ordered) {
+                    nodeCpus[info.node_id_].push_back(info.cpu_id_);
+                }
+                for (CSize i = 0; result.size() < ordered.size(); i++) {
+                    for (const auto& cur : nodeCpus) {
+                        if (i < cur.second.size()) {
+                            result.push_back(cur.second[i]);
+                        }
+                    }
+                }
+                return result;
+            }
+            case UCpuBindPolicy::PHYSICAL_CORE:
+                /** 先每个物理核使用一个超线程，物理核都使用之后，再使用其余的超线程。每一轮中，相邻的物理核共享缓存 */
+                std::sort(ordered.begin(), ordered.end(), [](const UCpuInfo& a, const UCpuInfo& b) {
+                    return std::make_tuple(a.smt_index_, a.node_id_, a.llc_id_, a.core_id_, a.cpu_id_)
+                           < std::make_tuple(b.smt_index_, b.node_id_, b.llc_id_, b.core_id_, b.cpu_id_);
+                });
+                break;
+            default:
+                /** COMPACT：同一物理核的超线程相邻，然后依次是共享末级缓存的物理核、同一 NUMA 节点中的物理核 */
+                std::sort(ordered.begin(), ordered.end(), [](const UCpuInfo& a, const UCpuInfo& b) {
+                    return std::make_tuple(a.node_id_, a.llc_id_, a.core_id_, a.smt_index_, a.cpu_id_)
+                           < std::make_tuple(b.node_id_, b.llc_id_, b.core_id_, b.smt_index_, b.cpu_id_);
+                });
+                break;
+        }
+
+        for (const auto& info : ordered) {
+            result.push_back(info.cpu_id_);
+        }
+        return result;
+    }
+
+
+    /**
+     * 将线程绑定到 cpus 中的任意cpu上，仅针对linux系统
+     * @param handle
+     * @param cpus
+     * @return 系统错误码，0 表示成功
+     */
+    static CInt bindThread(std::thread::native_handle_type handle, const std::vector<CInt>& cpus) {
+        CInt ret = 0;
+    #if defined(__linux__) && !defined(__ANDROID__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        for (CInt cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &mask);
+            }
+        }
+        ret = pthread_setaffinity_np(handle, sizeof(cpu_set_t), &mask);
+    #else
+        (void)handle;
+        (void)cpus;
+    #endif
+        return ret;
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(UCpuTopology)
+
+private:
+    explicit UCpuTopology() {
+        load();
+    }
+
+
+    /**
+     * 读取拓扑信息
+     */
+    CVoid load() {
+    #if defined(__linux__) && !defined(__ANDROID__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (0 == sched_getaffinity(0, sizeof(cpu_set_t), &mask)) {
+            for (CInt cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &mask)) {
+                    UCpuInfo info;
+                    info.cpu_id_ = cpu;
+                    cpus_.push_back(info);
+                }
+            }
+        }
+    #endif
+        if (cpus_.empty()) {
+            for (CInt cpu = 0; cpu < (std::max)(CGRAPH_CPU_NUM, 1); cpu++) {
+                UCpuInfo info;
+                info.cpu_id_ = cpu;
+                cpus_.push_back(info);
+            }
+        }
+
+        std::map<CInt, CInt> cpuNode = loadNodeInfo();
+        std::map<std::pair<CInt, CInt>, CInt> coreIds;    // (插槽, 插槽内物理核) -> 全局物理核编号
+        std::map<CInt, CInt> coreSmtSize;
+        for (auto& info : cpus_) {
+            const std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(info.cpu_id_);
+            info.package_id_ = readInt(path + "/topology/physical_package_id", 0);
+            CInt localCore = readInt(path + "/topology/core_id", info.cpu_id_);
+            auto key = std::make_pair(info.package_id_, localCore);
+            if (coreIds.find(key) == coreIds.end()) {
+                CInt coreId = (CInt)coreIds.size();
+                coreIds[key] = coreId;
+            }
+            info.core_id_ = coreIds[key];
+            info.smt_index_ = coreSmtSize[info.core_id_]++;    // cpus_ 按照编号排序，编号最小的为第一个超线程
+            info.llc_id_ = loadLlcId(path, -1 - info.package_id_);    // 读取失败的时候，同一插槽视为共享缓存
+            info.node_id_ = cpuNode.count(info.cpu_id_) > 0 ? cpuNode[info.cpu_id_] : 0;
+        }
+    }
+
+
+    /**
+     * 获取末级缓存的编号。依次读取每一级缓存，取级别最高的非指令缓存
+     * @param cpuPath
+     * @param defaultId 读取失败的时候，返回的默认值
+     * @return
+     */
+    static CInt loadLlcId(const std::string& cpuPath, CInt defaultId) {
+        CInt result = defaultId;
+        CInt maxLevel = 0;
+        for (CInt index = 0; ; index++) {
+            const std::string path = cpuPath + "/cache/index" + std::to_string(index);
+            CInt level = readInt(path + "/level", -1);
+            if (level < 0) {
+                break;
+            }
+
+            std::string type = readLine(path + "/type");
+            std::vector<CInt> shared = parseCpuList(readLine(path + "/shared_cpu_list"));
+            if (level > maxLevel && "Instruction" != type && !shared.empty()) {
+                maxLevel = level;
+                result = *std::min_element(shared.begin(), shared.end());
+            }
+        }
+        return result;
+    }
+
+
+    /**
+     * 读取每个cpu所在的 NUMA 节点
+     * @return
+     */
+    static std::map<CInt, CInt> loadNodeInfo() {
+        std::map<CInt, CInt> result;
+    #if defined(__linux__) && !defined(__ANDROID__)
+        const std::string root = "/sys/devices/system/node";
+        DIR* dir = opendir(root.c_str());
+        if (nullptr == dir) {
+            return result;
+        }
+
+        struct dirent* entry = nullptr;
+        while (nullptr != (entry = readdir(dir))) {
+            const std::string name = entry->d_name;
+            if (name.size() <= 4 || 0 != name.compare(0, 4, "node")
+                || !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+                continue;
+            }
+
+            CInt node = std::stoi(name.substr(4));
+            for (CInt cpu : parseCpuList(readLine(root + "/" + name + "/cpulist"))) {
+                result[cpu] = node;
+            }
+        }
+        closedir(dir);
+    #endif
+        return result;
+    }
+
+
+    /**
+     * 解析类似 "0-3,8,10-11" 格式的cpu列表
+     * @param str
+     * @return
+     */
+    static std::vector<CInt> parseCpuList(const std::string& str) {
+        std::vector<CInt> result;
+        CSize pos = 0;
+        while (pos < str.size()) {
+            CSize end = str.find(',', pos);
+            end = (std::string::npos == end) ? str.size() : end;
+            const std::string range = str.substr(pos, end - pos);
+            CSize dash = range.find('-');
+            try {
+                CInt first = std::stoi(range.substr(0, dash));
+                CInt last = (std::string::npos == dash) ? first : std::stoi(range.substr(dash + 1));
+                for (CInt cpu = first; cpu <= last; cpu++) {
+                    result.push_back(cpu);
+                }
+            } catch (...) {
+                // 格式不正确的部分，直接忽略
+            }
+            pos = end + 1;
+        }
+        return result;
+    }
+
+
+    /**
+     * 读取文件的第一行
+     * @param path
+     * @return 读取失败的时候，返回空字符串
+     */
+    static std::string readLine(const std::string& path) {
+        std::string line;
+        std::ifstream file(path);
+        if (file.is_open()) {
+            std::getline(file, line);
+        }
+        return line;
+    }
+
+
+    /**
+     * 读取文件中的整数
+     * @param path
+     * @param defaultValue 读取失败的时候，返回的默认值
+     * @return
+     */
+    static CInt readInt(const std::string& path, CInt defaultValue) {
+        CInt value = defaultValue;
+        std::ifstream file(path);
+        if (!(file.is_open() && (file >> value))) {
+            value = defaultValue;
+        }
+        return value;
+    }
+
+private:
+    std::vector<UCpuInfo> cpus_;                                // 当前进程可以使用的cpu，按照编号排序
+};
+
+CGRAPH_NAMESPACE_END
+
+#endif //CGRAPH_UCPUTOPOLOGY_H
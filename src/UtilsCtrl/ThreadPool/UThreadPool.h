@@ -12,17 +12,22 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <atomic>
 #include <future>
 #include <thread>
 #include <algorithm>
 #include <memory>
 #include <functional>
+#include <iterator>
 
 #include "UThreadObject.h"
 #include "UThreadPoolConfig.h"
+#include "UThreadPoolStats.h"
+#include "UThreadPoolTrace.h"
 #include "Queue/UQueueInclude.h"
 #include "Thread/UThreadInclude.h"
 #include "Task/UTaskInclude.h"
+#include "Topology/UCpuQuota.h"
 
 CGRAPH_NAMESPACE_BEGIN
 
@@ -47,7 +52,8 @@ public:
      * 析构函数
      */
     ~UThreadPool() override {
-        this->config_.monitor_enable_ = false;    // 在析构的时候，才释放监控线程。先释放监控线程，再释放其他的线程
+        monitor_running_ = false;    // 在析构的时候，才释放监控线程。先释放监控线程，再释放其他的线程
+        scale_event_.notifyAll();
         if (monitor_thread_.joinable()) {
             monitor_thread_.join();
         }
@@ -74,7 +80,12 @@ public:
      * @return
      */
     UThreadPoolConfig getConfig() const {
-        return config_;
+        UThreadPoolConfig config = config_;
+        if (is_init_) {
+            config.default_thread_size_ = thread_counter_.primary_num_.load(std::memory_order_acquire);
+            config.max_thread_size_ = max_thread_limit_.load(std::memory_order_acquire);
+        }
+        return config;
     }
 
     /**
@@ -83,24 +94,40 @@ public:
      */
     CStatus init() final {
         CGRAPH_FUNCTION_BEGIN
+        CGRAPH_LOCK_GUARD resizeLock(resize_mutex_);    // 和监控线程中调整线程的操作互斥
         if (is_init_) {
             CGRAPH_FUNCTION_END
         }
 
-        if (config_.monitor_enable_) {
-            // 默认不开启监控线程
+        if (config_.auto_size_enable_) {
+            auto_cpu_num_ = UCpuQuota::calcCpuLimit();
+            config_.calcAutoSize(auto_cpu_num_);
+        }
+        max_thread_limit_.store(config_.max_thread_size_, std::memory_order_release);
+
+        if (config_.isMonitorRequired() && !monitor_thread_.joinable()) {
+            // 默认不开启监控线程。开启自动设置线程个数、弹性伸缩或需要补充预留辅助线程的时候，也通过监控线程执行
+            monitor_running_ = true;
             monitor_thread_ = std::thread(&UThreadPool::monitor, this);
+            bindMonitorThread();
         }
-        thread_record_map_.clear();
-        thread_record_map_[(CSize)std::hash<std::thread::id>{}(std::this_thread::get_id())] = CGRAPH_MAIN_THREAD_ID;
+        recordThread(std::this_thread::get_id(), CGRAPH_MAIN_THREAD_ID);
         task_queue_.setup();
-        primary_threads_.reserve(config_.default_thread_size_);
-        for (int i = 0; i < config_.default_thread_size_; i++) {
+        priority_task_queue_.setAgingInterval(config_.priority_aging_interval_);
+
+        /**
+         * 按照最大线程数，一次性创建所有的 primary 线程对象，仅开启前 default_thread_size_ 个
+         * 运行时调整主线程个数的时候，primary_threads_ 不再变化，其他线程可以安全的访问
+         */
+        const int slotSize = std::max(config_.max_thread_size_, config_.default_thread_size_);
+        primary_threads_.reserve(slotSize);
+        for (int i = 0; i < slotSize; i++) {
             auto* pt = CGRAPH_SAFE_MALLOC_COBJECT(UThreadPrimary);    // 创建核心线程数
-            pt->setThreadPoolInfo(i, &task_queue_, &primary_threads_, &config_);
+            pt->setThreadPoolInfo(i, &task_queue_, &primary_threads_, &thread_counter_, &config_);
             // 记录线程和匹配id信息
             primary_threads_.emplace_back(pt);
         }
+        thread_counter_.primary_num_.store(config_.default_thread_size_, std::memory_order_release);
 
         /**
          * 等待所有thread 设置完毕之后，再进行 init()，
@@ -109,7 +136,7 @@ public:
          */
         for (int i = 0; i < config_.default_thread_size_; i++) {
             status += primary_threads_[i]->init();
-            thread_record_map_[(CSize)std::hash<std::thread::id>{}(primary_threads_[i]->thread_.get_id())] = i;
+            recordThread(primary_threads_[i]->thread_.get_id(), i);
         }
         CGRAPH_FUNCTION_CHECK_STATUS
 
@@ -117,8 +144,9 @@ public:
          * 策略更新：
          * 初始化的时候，也可以创建n个辅助线程。目的是为了配合仅使用 pool中 priority_queue 的场景
          * 一般情况下，建议为0。
+         * 预留的辅助线程也在此时一起创建，休眠等待，提交优先级任务的时候仅需唤醒
          */
-        status = createSecondaryThread(config_.secondary_thread_size_);
+        status = createSecondaryThread(config_.secondary_thread_size_ + config_.secondary_reserve_size_);
         CGRAPH_FUNCTION_CHECK_STATUS
 
         is_init_ = true;
@@ -133,9 +161,24 @@ public:
      * @return
      */
     template<typename FunctionType>
-    auto commit(const FunctionType& func,
+    auto commit(FunctionType&& func,
                 CIndex index = CGRAPH_DEFAULT_TASK_STRATEGY)
-    -> std::future<decltype(std::declval<FunctionType>()())>;
+    -> std::future<UTaskResultType<FunctionType>>;
+
+    /**
+     * 提交任务信息，返回线程池内部的 UFuture
+     * 共享状态在线程本地的缓存中复用，稳定运行时不需要申请内存。适合高频提交并等待结果的场景
+     * @tparam FunctionType
+     * @param func
+     * @param index
+     * @return
+     * @notice UFuture 不可拷贝，也不支持 share()。转换为 std::future 的时候，会额外申请一次内存
+     * 其他提交方式，对应 commitFastWithTid/commitFastWithPriority/commitFastWithLane/commitFastWithTag/commitFastBulk
+     */
+    template<typename FunctionType>
+    auto commitFast(FunctionType&& func,
+                    CIndex index = CGRAPH_DEFAULT_TASK_STRATEGY)
+    -> UFuture<UTaskResultType<FunctionType>>;
 
     /**
      * 向特定的线程id中，提交任务信息
@@ -147,8 +190,8 @@ public:
      * @return
      */
     template<typename FunctionType>
-    auto commitWithTid(const FunctionType& func, CIndex tid, CBool enable, CBool lockable)
-    -> std::future<decltype(std::declval<FunctionType>()())>;
+    auto commitWithTid(FunctionType&& func, CIndex tid, CBool enable, CBool lockable)
+    -> std::future<UTaskResultType<FunctionType>>;
 
     /**
      * 根据优先级，执行任务
@@ -159,9 +202,106 @@ public:
      * @notice 建议，priority 范围在 [-100, 100] 之间
      */
     template<typename FunctionType>
-    auto commitWithPriority(const FunctionType& func,
+    auto commitWithPriority(FunctionType&& func,
                             int priority)
-    -> std::future<decltype(std::declval<FunctionType>()())>;
+    -> std::future<UTaskResultType<FunctionType>>;
+
+    /**
+     * 向主线程的特定通道中，提交任务信息
+     * @tparam FunctionType
+     * @param func
+     * @param lane 任务通道。URGENT/HIGH 通道中的任务，优先于普通任务执行；BACKGROUND 通道中的任务，在空闲的时候执行
+     * @return
+     */
+    template<typename FunctionType>
+    auto commitWithLane(FunctionType&& func, UTaskLane lane)
+    -> std::future<UTaskResultType<FunctionType>>;
+
+    /**
+     * 提交带分类标签的任务信息。开启耗时统计的时候，按照标签分别记录任务的等待时长和执行时长
+     * @tparam FunctionType
+     * @param func
+     * @param tag 分类标签，取值范围 [0, CGRAPH_TASK_TAG_SIZE)，超出范围的按照默认标签统计
+     * @param index
+     * @return
+     */
+    template<typename FunctionType>
+    auto commitWithTag(FunctionType&& func, CInt tag,
+                       CIndex index = CGRAPH_DEFAULT_TASK_STRATEGY)
+    -> std::future<UTaskResultType<FunctionType>>;
+
+    /**
+     * 批量提交任务信息。多个任务会被均分到各个线程的队列中，每个队列仅加锁一次
+     * @tparam Iterator
+     * @param begin
+     * @param end
+     * @return
+     * @notice [begin, end) 中的函数会被拷贝。如果需要 move，可以传入 std::make_move_iterator
+     */
+    template<typename Iterator>
+    auto commitBulk(Iterator begin, Iterator end)
+    -> std::vector<std::future<decltype((*begin)())>>;
+
+    /**
+     * 向特定的线程id中，提交任务信息，返回 UFuture
+     * @tparam FunctionType
+     * @param func
+     * @param tid
+     * @param enable
+     * @param lockable
+     * @return
+     */
+    template<typename FunctionType>
+    auto commitFastWithTid(FunctionType&& func, CIndex tid, CBool enable, CBool lockable)
+    -> UFuture<UTaskResultType<FunctionType>>;
+
+    /**
+     * 根据优先级，执行任务，返回 UFuture
+     * @tparam FunctionType
+     * @param func
+     * @param priority
+     * @return
+     */
+    template<typename FunctionType>
+    auto commitFastWithPriority(FunctionType&& func,
+                                int priority)
+    -> UFuture<UTaskResultType<FunctionType>>;
+
+    /**
+     * 向主线程的特定通道中，提交任务信息，返回 UFuture
+     * @tparam FunctionType
+     * @param func
+     * @param lane
+     * @return
+     */
+    template<typename FunctionType>
+    auto commitFastWithLane(FunctionType&& func, UTaskLane lane)
+    -> UFuture<UTaskResultType<FunctionType>>;
+
+    /**
+     * 提交带分类标签的任务信息，返回 UFuture
+     * @tparam FunctionType
+     * @param func
+     * @param tag
+     * @param index
+     * @return
+     */
+    template<typename FunctionType>
+    auto commitFastWithTag(FunctionType&& func, CInt tag,
+                           CIndex index = CGRAPH_DEFAULT_TASK_STRATEGY)
+    -> UFuture<UTaskResultType<FunctionType>>;
+
+    /**
+     * 批量提交任务信息，返回 UFuture 的列表
+     * @tparam Iterator
+     * @param begin
+     * @param end
+     * @return
+     * @notice [begin, end) 中的函数会被拷贝
+     */
+    template<typename Iterator>
+    auto commitFastBulk(Iterator begin, Iterator end)
+    -> std::vector<UFuture<UTaskResultType<decltype(*begin)>>>;
 
     /**
      * 异步执行任务
@@ -173,6 +313,16 @@ public:
     CVoid execute(FunctionType&& task,
                   CIndex index = CGRAPH_DEFAULT_TASK_STRATEGY);
 
+    /**
+     * 批量异步执行任务
+     * @tparam Iterator
+     * @param begin
+     * @param end
+     * @return
+     */
+    template<typename Iterator>
+    CVoid executeBulk(Iterator begin, Iterator end);
+
     /**
      * 异步写入特定thread id，执行信息
      * @tparam FunctionType
@@ -185,56 +335,106 @@ public:
     template<typename FunctionType>
     CVoid executeWithTid(FunctionType&& task, CIndex tid, CBool enable, CBool lockable);
 
+    /**
+     * 根据优先级，异步执行任务
+     * @tparam FunctionType
+     * @param task
+     * @param priority
+     * @return
+     */
+    template<typename FunctionType>
+    CVoid executeWithPriority(FunctionType&& task, int priority);
+
+    /**
+     * 异步写入主线程的特定通道，执行信息
+     * @tparam FunctionType
+     * @param task
+     * @param lane
+     * @return
+     */
+    template<typename FunctionType>
+    CVoid executeWithLane(FunctionType&& task, UTaskLane lane);
+
+    /**
+     * 异步执行带分类标签的任务
+     * @tparam FunctionType
+     * @param task
+     * @param tag
+     * @param index
+     * @return
+     */
+    template<typename FunctionType>
+    CVoid executeWithTag(FunctionType&& task, CInt tag,
+                         CIndex index = CGRAPH_DEFAULT_TASK_STRATEGY);
+
     /**
      * 执行任务组信息
      * 取taskGroup内部ttl和入参ttl的最小值，为计算ttl标准
      * @param taskGroup
      * @param ttl
      * @return
+     * @notice 任务会被拷贝到线程池中执行，taskGroup 不变，可以重复执行。包含不可拷贝的任务的时候，返回错误信息
      */
     CStatus submit(const UTaskGroup& taskGroup,
                    CMSec ttl = CGRAPH_MAX_BLOCK_TTL) {
         CGRAPH_FUNCTION_BEGIN
         CGRAPH_ASSERT_INIT(true)
 
-        std::vector<std::future<CVoid>> futures;
-        futures.reserve(taskGroup.getSize());
-        for (const auto& task : taskGroup.task_arr_) {
-            futures.emplace_back(commit(task));
-        }
+        UTaskArr tasks;
+        std::vector<UFuture<CVoid>> futures;
+        status = taskGroup.copyTasks(tasks, futures);
+        CGRAPH_FUNCTION_CHECK_STATUS
 
-        // 计算最终运行时间信息
-        auto deadline = std::chrono::steady_clock::now()
-                        + std::chrono::milliseconds(std::min(taskGroup.getTtl(), ttl));
+        status = runTaskGroup(taskGroup, tasks, futures, ttl);
+        CGRAPH_FUNCTION_END
+    }
 
-        for (auto& fut : futures) {
-            const auto& futStatus = fut.wait_until(deadline);
-            switch (futStatus) {
-                case std::future_status::ready: break;    // 正常情况，直接返回了
-                case std::future_status::timeout: status += CStatus("thread status timeout"); break;
-                case std::future_status::deferred: status += CStatus("thread status deferred"); break;
-                default: status += CStatus("thread status unknown");
-            }
-        }
+    /**
+     * 执行临时的任务组信息
+     * @param taskGroup
+     * @param ttl
+     * @return
+     * @notice 任务会被 move 到线程池中，不会发生拷贝。执行之后 taskGroup 被清空
+     */
+    CStatus submit(UTaskGroup&& taskGroup,
+                   CMSec ttl = CGRAPH_MAX_BLOCK_TTL) {
+        CGRAPH_FUNCTION_BEGIN
+        CGRAPH_ASSERT_INIT(true)
 
-        if (taskGroup.on_finished_) {
-            taskGroup.on_finished_(status);
-        }
+        UTaskArr tasks;
+        std::vector<UFuture<CVoid>> futures;
+        taskGroup.takeTasks(tasks, futures);
 
+        status = runTaskGroup(taskGroup, tasks, futures, ttl);
         CGRAPH_FUNCTION_END
     }
 
     /**
      * 针对单个任务的情况，复用任务组信息，实现单个任务直接执行
-     * @param task
+     * @tparam FunctionType
+     * @param func
      * @param ttl
      * @param onFinished
      * @return
      */
-    CStatus submit(CGRAPH_DEFAULT_CONST_FUNCTION_REF func,
+    template<typename FunctionType,
+             c_enable_if_t<!std::is_same<typename std::decay<FunctionType>::type, UTaskGroup>::value, int> = 0>
+    CStatus submit(FunctionType&& func,
                    CMSec ttl = CGRAPH_MAX_BLOCK_TTL,
                    CGRAPH_CALLBACK_CONST_FUNCTION_REF onFinished = nullptr) {
-        return submit(UTaskGroup(func, ttl, onFinished));
+        return submit(UTaskGroup(std::forward<FunctionType>(func), ttl, onFinished));
+    }
+
+    /**
+     * 获取当前线程的index信息。当前线程是本线程池中的 primary 线程的时候，无需查表
+     * @return
+     */
+    CIndex getThreadIndex() {
+        UThreadPrimaryPtr localThread = getLocalThread();
+        if (localThread) {
+            return localThread->index_;
+        }
+        return getThreadIndex((CSize)std::hash<std::thread::id>{}(std::this_thread::get_id()));
     }
 
     /**
@@ -245,6 +445,7 @@ public:
      */
     CIndex getThreadIndex(CSize tid) {
         int index = CGRAPH_SECONDARY_THREAD_COMMON_ID;
+        CGRAPH_LOCK_GUARD lock(record_mutex_);
         auto result = thread_record_map_.find(tid);
         if (result != thread_record_map_.end()) {
             index = result->second;
@@ -259,13 +460,23 @@ public:
      */
     CStatus destroy() final {
         CGRAPH_FUNCTION_BEGIN
+        CGRAPH_LOCK_GUARD resizeLock(resize_mutex_);
         if (!is_init_) {
             CGRAPH_FUNCTION_END
         }
 
-        // primary 线程是普通指针，需要delete
+        /**
+         * 先标记为未初始化，再释放线程
+         * 监控线程在 resize_mutex_ 中确认 is_init_ 之后，才会调整线程，所以在这之后不会再创建或释放线程
+         */
+        is_init_ = false;
+        primary_resized_ = false;
+
+        // primary 线程是普通指针，需要delete。未开启或已经被回收的线程，不需要 destroy
         for (auto &pt : primary_threads_) {
-            status += pt->destroy();
+            if (pt->is_init_) {
+                status += pt->destroy();
+            }
         }
         CGRAPH_FUNCTION_CHECK_STATUS
 
@@ -276,20 +487,39 @@ public:
          * destroy 和 delete 分开之后，不会出现此问题。
          * 感谢 Ryan大佬(https://github.com/ryanhuang) 提供的帮助
          */
-        for (auto &pt : primary_threads_) {
-            CGRAPH_DELETE_PTR(pt)
+        {
+            CGRAPH_LOCK_GUARD lock(st_mutex_);    // 和 getStats() 互斥。线程已经结束，这里不会等待任务执行
+            for (auto &pt : primary_threads_) {
+                CGRAPH_DELETE_PTR(pt)
+            }
+            primary_threads_.clear();
         }
-        primary_threads_.clear();
+        thread_counter_.primary_num_.store(0, std::memory_order_release);
 
-        // secondary 线程是智能指针，不需要delete
+        // secondary 线程是智能指针，不需要delete。先在锁中取出，再在锁外等待线程结束，避免执行中的任务唤醒辅助线程时死锁
         task_queue_.reset();
-        for (auto &st : secondary_threads_) {
+        std::list<std::unique_ptr<UThreadSecondary>> secondaryThreads;
+        {
+            CGRAPH_LOCK_GUARD lock(st_mutex_);
+            secondaryThreads.swap(secondary_threads_);
+            thread_counter_.secondary_num_.store(0, std::memory_order_release);
+        }
+        for (auto &st : secondaryThreads) {
             status += st->destroy();
         }
+        secondaryThreads.clear();
         CGRAPH_FUNCTION_CHECK_STATUS
-        secondary_threads_.clear();
-        thread_record_map_.clear();
-        is_init_ = false;
+        {
+            CGRAPH_LOCK_GUARD lock(st_mutex_);
+            exited_stats_ = UThreadStats();
+            exited_latency_.clear();
+            secondary_create_num_ = 0;
+            secondary_exit_num_ = 0;
+        }
+        {
+            CGRAPH_LOCK_GUARD lock(record_mutex_);
+            thread_record_map_.clear();
+        }
 
         CGRAPH_FUNCTION_END
     }
@@ -310,16 +540,20 @@ public:
     CStatus createSecondaryThread(CInt size) {
         CGRAPH_FUNCTION_BEGIN
 
-        int leftSize = (int)(config_.max_thread_size_ - config_.default_thread_size_ - secondary_threads_.size());
-        int realSize = std::min(size, leftSize);    // 使用 realSize 来确保所有的线程数量之和，不会超过设定max值
-
         CGRAPH_LOCK_GUARD lock(st_mutex_);
+        int leftSize = (int)(max_thread_limit_.load(std::memory_order_acquire) - getPrimaryThreadSize() - secondary_threads_.size());
+        int realSize = std::min(size, leftSize);    // 使用 realSize 来确保所有的线程数量之和，不会超过设定max值
         for (int i = 0; i < realSize; i++) {
             auto ptr = CGRAPH_MAKE_UNIQUE_COBJECT(UThreadSecondary)
-            ptr->setThreadPoolInfo(&task_queue_, &priority_task_queue_, &config_);
+            ptr->setThreadPoolInfo(&task_queue_, &priority_task_queue_, &thread_counter_, &config_);
             status += ptr->init();
             secondary_threads_.emplace_back(std::move(ptr));
         }
+        secondary_create_num_ += (std::max)(realSize, 0);
+        if (realSize > 0) {
+            CGRAPH_TRACE(SCALE_UP, realSize, realSize)
+        }
+        thread_counter_.secondary_num_.store((CInt)secondary_threads_.size(), std::memory_order_release);
 
         CGRAPH_FUNCTION_END
     }
@@ -332,25 +566,154 @@ public:
     CStatus releaseSecondaryThread(CInt size) {
         CGRAPH_FUNCTION_BEGIN
 
-        // 先将所有已经结束的，给删掉
-        CGRAPH_LOCK_GUARD lock(st_mutex_);
-        for (auto iter = secondary_threads_.begin(); iter != secondary_threads_.end(); ) {
-            !(*iter)->done_ ? secondary_threads_.erase(iter++) : iter++;
+        // 先将所有已经被标记结束的取出来，在锁外等待结束（可能仍在执行任务）
+        std::list<std::unique_ptr<UThreadSecondary>> releasedThreads;
+        CSize leftSize = 0;
+        {
+            CGRAPH_LOCK_GUARD lock(st_mutex_);
+            for (auto iter = secondary_threads_.begin(); iter != secondary_threads_.end(); ) {
+                if (!(*iter)->done_) {
+                    releasedThreads.splice(releasedThreads.end(), secondary_threads_, iter++);
+                } else {
+                    iter++;
+                }
+            }
+            thread_counter_.secondary_num_.store((CInt)secondary_threads_.size(), std::memory_order_release);
+
+            // 再标记几个需要删除的信息
+            leftSize = secondary_threads_.size();
+            if (size <= (CInt)leftSize) {
+                CGRAPH_TRACE(SCALE_DOWN, size, size)
+                CInt markSize = size;
+                for (auto iter = secondary_threads_.begin();
+                     iter != secondary_threads_.end() && markSize-- > 0; ) {
+                    (*iter)->done_ = false;
+                    iter++;
+                }
+            }
         }
+        joinSecondaryThreads(releasedThreads);
 
-        CGRAPH_RETURN_ERROR_STATUS_BY_CONDITION((size > (CInt)secondary_threads_.size()),    \
+        CGRAPH_RETURN_ERROR_STATUS_BY_CONDITION((size > (CInt)leftSize),    \
                                             "cannot release [" + std::to_string(size) + "] secondary thread,"    \
-                                            + "only [" + std::to_string(secondary_threads_.size()) + "] left.")
+                                            + "only [" + std::to_string(leftSize) + "] left.")
+        CGRAPH_FUNCTION_END
+    }
+
+    /**
+     * 调整运行中的 primary 线程个数，不需要 destroy/init 线程池
+     * 增加的时候，开启新的线程之后，才对外可见；减少的时候，先停止向待回收的线程分发任务，
+     * 再依次停止待回收的线程，并将其中剩余的任务转移到 pool 的通用队列中，不会丢失任务
+     * 其他线程在下一次盗取的时候，重新构造盗取目标
+     * @param size 取值范围为 [1, max(max_thread_size_, default_thread_size_)]，以 init 时的配置为准
+     * @return
+     * @notice 不可以在待回收的 primary 线程中调用
+     * @notice 开启自动设置线程个数的时候，手动调整之后，监控线程不再根据cpu个数调整主线程个数（仍然会调整最大线程个数）
+     */
+    CStatus resizePrimaryThread(CInt size) {
+        CGRAPH_FUNCTION_BEGIN
+        CGRAPH_LOCK_GUARD lock(resize_mutex_);
+        CGRAPH_ASSERT_INIT(true)
+        CGRAPH_RETURN_ERROR_STATUS_BY_CONDITION((size <= 0 || size > (CInt)primary_threads_.size()),    \
+                                                "primary thread size should be in [1, "    \
+                                                + std::to_string(primary_threads_.size()) + "]")
+        UThreadPrimaryPtr localThread = getLocalThread();
+        CGRAPH_RETURN_ERROR_STATUS_BY_CONDITION((localThread && localThread->index_ >= size),    \
+                                                "cannot retire the primary thread which calls resize")
+
+        primary_resized_ = true;
+        status = adjustPrimaryThread(size);
+        CGRAPH_FUNCTION_END
+    }
+
+    /**
+     * 获取运行中的 primary 线程个数
+     * @return
+     */
+    CInt getPrimaryThreadSize() const {
+        return thread_counter_.primary_num_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * 调整运行中的 primary 线程个数。需要在 resize_mutex_ 中调用
+     * @param size 取值范围为 [1, primary_threads_.size()]
+     * @return
+     */
+    CStatus adjustPrimaryThread(CInt size) {
+        CGRAPH_FUNCTION_BEGIN
+        const CInt curSize = getPrimaryThreadSize();
+        for (CInt i = curSize; i < size; i++) {
+            status += primary_threads_[i]->init();
+            recordThread(primary_threads_[i]->thread_.get_id(), i);
+        }
+        CGRAPH_FUNCTION_CHECK_STATUS
+        thread_counter_.primary_num_.store(size, std::memory_order_release);
+        CGRAPH_TRACE(RESIZE_PRIMARY, size, 1)
 
-        // 再标记几个需要删除的信息
-        for (auto iter = secondary_threads_.begin();
-             iter != secondary_threads_.end() && size-- > 0; ) {
-            (*iter)->done_ = false;
-            iter++;
+        for (CInt i = curSize - 1; i >= size; i--) {
+            auto* pt = primary_threads_[i];
+            eraseThread(pt->thread_.get_id());
+            pt->retire();
         }
         CGRAPH_FUNCTION_END
     }
 
+    /**
+     * 获取线程池的统计信息快照
+     * 各线程的计数仅由本线程写入（relaxed），在这里读取并汇总，不影响执行任务的效率
+     * @return
+     * @notice 队列长度需要加锁获取，不建议高频调用
+     */
+    UThreadPoolStats getStats() {
+        UThreadPoolStats stats;
+        {
+            /**
+             * destroy() 在 st_mutex_ 中释放 primary 线程对象，这里加锁之后，再确认是否初始化
+             * 不使用 resize_mutex_：destroy() 和 resize 在 resize_mutex_ 中等待线程结束，任务中获取统计信息的时候会死锁
+             */
+            CGRAPH_LOCK_GUARD lock(st_mutex_);
+            if (!is_init_) {
+                return stats;
+            }
+
+            // 被回收的线程，保留之前的统计信息
+            for (auto* pt : primary_threads_) {
+                UThreadStats cur;
+                pt->collectStats(cur);
+                if (cur.is_active_ || cur.alive_ns_ > 0) {
+                    stats.primary_stats_.emplace_back(cur);
+                }
+            }
+
+            stats.secondary_stats_.resize(secondary_threads_.size());
+            CSize i = 0;
+            for (auto& st : secondary_threads_) {
+                st->collectStats(stats.secondary_stats_[i++]);
+            }
+            stats.exited_stats_ = exited_stats_;
+            stats.secondary_create_num_ = secondary_create_num_;
+            stats.secondary_exit_num_ = secondary_exit_num_;
+
+            if (config_.latency_enable_) {
+                // 直方图的内存在开启线程之前申请，之后仅累加计数，不需要和执行任务的线程同步
+                stats.latency_stats_.resize(CGRAPH_TASK_TAG_SIZE);
+                for (auto* pt : primary_threads_) {
+                    pt->collectLatency(stats.latency_stats_);
+                }
+                for (auto& st : secondary_threads_) {
+                    st->collectLatency(stats.latency_stats_);
+                }
+                for (CSize j = 0; j < exited_latency_.size(); j++) {
+                    stats.latency_stats_[j].merge(exited_latency_[j]);
+                }
+            }
+        }
+
+        stats.pool_queue_size_ = task_queue_.size();
+        stats.priority_queue_size_ = priority_task_queue_.size();
+        return stats;
+    }
+
     /**
      * 通知所有thread 开启
      * @return
@@ -360,9 +723,7 @@ public:
             pt->wakeup();
         }
 
-        for (auto& st : secondary_threads_) {
-            st->wakeup();
-        }
+        thread_counter_.secondary_event_.notifyAll();
     }
 
 protected:
@@ -374,10 +735,7 @@ protected:
     virtual CIndex dispatch(CIndex origIndex) {
         CIndex realIndex = 0;
         if (CGRAPH_DEFAULT_TASK_STRATEGY == origIndex) {
-            realIndex = cur_index_++;
-            if (cur_index_ >= config_.max_thread_size_ || cur_index_ < 0) {
-                cur_index_ = 0;
-            }
+            realIndex = selectThread();
         } else {
             realIndex = origIndex;
         }
@@ -385,52 +743,572 @@ protected:
         return realIndex;    // 交到上游去判断，走哪个线程
     }
 
+    /**
+     * 随机选择两个 primary 线程，返回其中任务较少的一个（power of two choices）
+     * 两个线程中的任务个数都超过阈值的时候，写入 pool 的通用队列，由空闲的线程获取
+     * @return
+     */
+    CIndex selectThread() {
+        const CInt size = getPrimaryThreadSize();
+        if (unlikely(size <= 0)) {
+            return CGRAPH_POOL_TASK_STRATEGY;
+        }
+
+        const CUInt rand = CGRAPH_FAST_RANDOM();
+        const CIndex first = (CIndex)(rand % size);
+        const CIndex second = (size > 1) ? (CIndex)((first + 1 + (rand >> 16) % (size - 1)) % size) : first;
+        const CSize firstSize = primary_threads_[first]->getTaskSize();
+        const CSize secondSize = primary_threads_[second]->getTaskSize();
+        if ((std::min)(firstSize, secondSize) > (CSize)config_.dispatch_queue_threshold_) {
+            return CGRAPH_POOL_TASK_STRATEGY;
+        }
+
+        return firstSize <= secondSize ? first : second;
+    }
+
+    /**
+     * 如果当前线程是本线程池中的 primary 线程，则返回对应的线程，否则返回 nullptr
+     * @return
+     */
+    UThreadPrimaryPtr getLocalThread() const {
+        UThreadPrimaryPtr cur = UThreadPrimary::current();
+        return (cur && cur->pool_threads_ == &primary_threads_) ? cur : nullptr;
+    }
+
+    /**
+     * 选择 executeWithTid 写入的 primary 线程，返回 nullptr 表示写入 pool 的通用队列
+     * 加锁之后、解锁之前的写入，和加锁的写入保持在同一个线程（或者 pool 的通用队列）中，和主线程个数的调整无关。已经被回收的线程，解锁之后转移任务
+     * 加锁的写入进入通用队列之后，即使对应的线程被重新开启，同一组的写入也不能写入该线程：没有持有锁的写入会和其他线程竞争，解锁会释放其他线程持有的锁
+     * 其余情况下，仅写入正在运行的 primary 线程
+     * @param tid
+     * @param enable
+     * @param lockable
+     * @return
+     */
+    UThreadPrimaryPtr selectTidThread(CIndex tid, CBool enable, CBool lockable) {
+        if (unlikely(tid < 0 || tid >= (CIndex)primary_threads_.size())) {
+            return nullptr;
+        }
+
+        UThreadPrimaryPtr thread = primary_threads_[tid];
+        auto& lockedThreads = getLockedThreads();
+        auto iter = std::find_if(lockedThreads.begin(), lockedThreads.end(),
+                                 [thread](const std::pair<UThreadPrimaryPtr, CBool>& cur) {
+                                     return cur.first == thread;
+                                 });
+        if (iter != lockedThreads.end()) {
+            UThreadPrimaryPtr result = iter->second ? thread : nullptr;
+            if (enable && !lockable) {
+                lockedThreads.erase(iter);
+            }
+            return result;
+        }
+
+        CBool isRunning = tid < getPrimaryThreadSize();
+        if (enable && lockable) {
+            lockedThreads.emplace_back(thread, isRunning);
+        }
+        return isRunning ? thread : nullptr;
+    }
+
+    /**
+     * 当前线程中，通过 executeWithTid 加锁并且还没有解锁的 primary 线程，以及是否真正写入（加锁）了该线程
+     * @return
+     */
+    static std::vector<std::pair<UThreadPrimaryPtr, CBool>>& getLockedThreads() {
+        static thread_local std::vector<std::pair<UThreadPrimaryPtr, CBool>> threads;
+        return threads;
+    }
+
+    /**
+     * 执行任务组中的任务，并且等待执行结束或者超时
+     * @param taskGroup
+     * @param tasks
+     * @param futures 和 tasks 一一对应
+     * @param ttl
+     * @return
+     */
+    CStatus runTaskGroup(const UTaskGroup& taskGroup, UTaskArrRef tasks,
+                         std::vector<UFuture<CVoid>>& futures, CMSec ttl) {
+        CGRAPH_FUNCTION_BEGIN
+        dispatchBulk(tasks);
+
+        // 计算最终运行时间信息
+        auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::milliseconds(std::min(taskGroup.getTtl(), ttl));
+
+        for (auto& fut : futures) {
+            const auto& futStatus = fut.wait_until(deadline);
+            switch (futStatus) {
+                case std::future_status::ready: break;    // 正常情况，直接返回了
+                case std::future_status::timeout: status += CStatus("thread status timeout"); break;
+                case std::future_status::deferred: status += CStatus("thread status deferred"); break;
+                default: status += CStatus("thread status unknown");
+            }
+        }
+
+        if (taskGroup.on_finished_) {
+            taskGroup.on_finished_(status);
+        }
+        CGRAPH_FUNCTION_END
+    }
+
+    /**
+     * 将一批任务，按照 round-robin 的方式均分到各个线程中
+     * 每个线程（或 pool 的通用队列），仅写入一次
+     * @param tasks
+     * @return
+     */
+    CVoid dispatchBulk(UTaskArrRef tasks) {
+        const CSize total = tasks.size();
+        const CSize primarySize = (CSize)getPrimaryThreadSize();
+        const CSize slotSize = (CSize)std::max((CSize)max_thread_limit_.load(std::memory_order_acquire), primarySize);
+        if (0 == total || 0 == slotSize) {
+            return;
+        }
+
+        const CSize avgSize = total / slotSize;
+        const CSize extraSize = total % slotSize;
+        const CSize startIndex = cur_index_.fetch_add((CUInt)extraSize, std::memory_order_relaxed) % slotSize;
+        if (unlikely(config_.latency_enable_)) {
+            for (auto& task : tasks) {
+                task.stamp(CGRAPH_DEFAULT_TASK_TAG);
+            }
+        }
+
+        /**
+         * 前面的部分，依次分配给各个 primary 线程
+         * 超出 primary 线程范围的部分，合并在一起，最后一次性写入 pool 的通用队列中
+         */
+        auto cur = tasks.begin();
+        CSize poolSize = 0;
+        for (CSize i = 0; i < slotSize; i++) {
+            CSize realIndex = (startIndex + i) % slotSize;
+            CSize size = avgSize + (i < extraSize ? 1 : 0);
+            if (realIndex < primarySize) {
+                primary_threads_[realIndex]->pushTasks(cur, cur + size);
+                cur += size;
+            } else {
+                poolSize += size;
+            }
+        }
+
+        if (poolSize > 0) {
+            task_queue_.pushBulk(cur, tasks.end());
+            CGRAPH_TRACE(ENQUEUE, CGRAPH_POOL_TASK_STRATEGY, poolSize)
+            notifyScale(poolSize);
+            wakeupIdleThread(poolSize);
+        }
+    }
+
+    /**
+     * 写入 pool 的通用队列之后，优先唤醒休眠中的 primary 线程，不足的部分唤醒 secondary 线程
+     * 没有休眠线程的时候，仅有原子读的开销
+     * @param size 最多唤醒的线程个数
+     * @return
+     */
+    CVoid wakeupIdleThread(CSize size) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (thread_counter_.idle_num_.load(std::memory_order_relaxed) > 0) {
+            const CInt primarySize = getPrimaryThreadSize();
+            for (CInt i = 0; i < primarySize && size > 0; i++) {
+                if (primary_threads_[i]->event_.notify()) {
+                    size--;
+                }
+            }
+        }
+
+        wakeupSecondaryThread(size);
+    }
+
+
+    /**
+     * 唤醒休眠中的 secondary 线程。写入优先级任务之后，仅可以唤醒 secondary 线程
+     * 所有 secondary 线程在同一个事件上休眠，每次通知唤醒一个，不加锁，也不遍历辅助线程
+     * @param size 最多唤醒的线程个数
+     * @return
+     */
+    CVoid wakeupSecondaryThread(CSize size) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const CInt idleSize = thread_counter_.secondary_idle_num_.load(std::memory_order_relaxed);
+        for (CSize i = 0; i < size && (CInt)i < idleSize; i++) {
+            if (!thread_counter_.secondary_event_.notify()) {
+                break;
+            }
+        }
+    }
+
+    /**
+     * 开启绑定cpu模式的时候，监控线程仅在绑定策略用到的cpu上运行
+     */
+    CVoid bindMonitorThread() {
+        if (!config_.bind_cpu_enable_) {
+            return;
+        }
+
+        auto cpus = UCpuTopology::get().calcBindCpus(config_.bind_cpu_policy_, config_.bind_cpu_list_);
+        int ret = cpus.empty() ? 0 : UCpuTopology::bindThread(monitor_thread_.native_handle(), cpus);
+        if (0 != ret) {
+            CGRAPH_ECHO("warning : set monitor thread affinity failed, system error code is [%d]", ret);
+        }
+    }
+
     /**
      * 监控线程执行函数，主要是判断是否需要增加线程，或销毁线程
      * 增/删 操作，仅针对secondary类型线程生效
+     * 开启弹性伸缩的时候，由写入事件触发，按照毫秒级的间隔调整辅助线程；否则，每隔 monitor_span_ 秒检查一次
      */
     CVoid monitor() {
-        while (config_.monitor_enable_) {
-            while (config_.monitor_enable_ && !is_init_) {
-                // 如果没有init，则一直处于空跑状态
-                CGRAPH_SLEEP_SECOND(1)
+        CGRAPH_TRACE_THREAD_NAME("monitor")
+        auto checkTime = std::chrono::steady_clock::now();
+        while (monitor_running_) {
+            while (monitor_running_ && !is_init_) {
+                // 如果没有init，则一直处于空跑状态。析构的时候会被唤醒；开启弹性伸缩的时候，需要在 init 之后尽快开始采样
+                auto key = scale_event_.prepareWait();
+                if (monitor_running_) {
+                    scale_event_.commitWait(key, config_.elastic_enable_ ? config_.elastic_interval_ : CGRAPH_ELASTIC_IDLE_INTERVAL);
+                } else {
+                    scale_event_.cancelWait();
+                }
+            }
+
+            if (config_.elastic_enable_) {
+                waitScaleEvent();
+                fillReserve();
+                scaleSecondaryThread();
+
+                // 自动设置线程个数的检查，仍然每隔 monitor_span_ 秒执行一次
+                auto now = std::chrono::steady_clock::now();
+                if (now - checkTime < std::chrono::seconds(config_.monitor_span_)) {
+                    continue;
+                }
+                checkTime = now;
+            } else {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(config_.monitor_span_);
+                while (monitor_running_ && is_init_ && std::chrono::steady_clock::now() < deadline) {
+                    waitMonitorEvent(CGRAPH_ELASTIC_IDLE_INTERVAL);    // 保证可以快速退出，并及时补充预留的辅助线程
+                    fillReserve();
+                }
+            }
+
+            if (config_.auto_size_enable_) {
+                updateAutoSize();
+            }
+
+            if (!config_.monitor_enable_ || config_.elastic_enable_) {
+                continue;
             }
 
-            auto span = config_.monitor_span_;
-            while (config_.monitor_enable_ && is_init_ && span--) {
-                CGRAPH_SLEEP_SECOND(1)    // 保证可以快速退出
+            // 和 destroy() 互斥，避免在 primary 线程被释放的时候访问
+            CGRAPH_LOCK_GUARD resizeLock(resize_mutex_);
+            if (!is_init_) {
+                continue;
             }
 
             // 如果 primary线程都在执行，则表示忙碌
-            bool busy = !primary_threads_.empty() && std::all_of(primary_threads_.begin(), primary_threads_.end(),
-                                                                 [](UThreadPrimaryPtr ptr) { return ptr && ptr->is_running_; });
+            const CInt primarySize = getPrimaryThreadSize();
+            bool busy = primarySize > 0 && std::all_of(primary_threads_.begin(), primary_threads_.begin() + primarySize,
+                                                       [](UThreadPrimaryPtr ptr) { return ptr && ptr->is_running_; });
 
-            CGRAPH_LOCK_GUARD lock(st_mutex_);
-            // 如果忙碌或者priority_task_queue_中有任务，则需要添加 secondary线程
+            // 如果忙碌或者priority_task_queue_中有任务，则需要添加 secondary线程。createSecondaryThread 内部加锁
             if (busy || !priority_task_queue_.empty()) {
                 createSecondaryThread(1);
             }
 
-            // 判断 secondary 线程是否需要退出
-            for (auto iter = secondary_threads_.begin(); iter != secondary_threads_.end(); ) {
-                (*iter)->freeze() ? secondary_threads_.erase(iter++) : iter++;
+            // 判断 secondary 线程是否需要退出，至少保留预留的辅助线程。在锁中取出，在锁外等待结束
+            std::list<std::unique_ptr<UThreadSecondary>> releasedThreads;
+            {
+                CGRAPH_LOCK_GUARD lock(st_mutex_);
+                for (auto iter = secondary_threads_.begin(); iter != secondary_threads_.end(); ) {
+                    if ((*iter)->freeze() && secondary_threads_.size() > (CSize)config_.secondary_reserve_size_) {
+                        releasedThreads.splice(releasedThreads.end(), secondary_threads_, iter++);
+                        CGRAPH_TRACE(SCALE_DOWN, 1, 1)
+                    } else {
+                        iter++;
+                    }
+                }
+                thread_counter_.secondary_num_.store((CInt)secondary_threads_.size(), std::memory_order_release);
+            }
+            joinSecondaryThreads(releasedThreads);
+        }
+    }
+
+    /**
+     * 弹性伸缩时，等待下一次采样
+     * 有积压任务或多余辅助线程的时候，按照 elastic_interval_ 采样；否则休眠，直到有任务写入 pool 队列
+     */
+    CVoid waitScaleEvent() {
+        if (scale_active_) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(config_.elastic_interval_));
+            return;
+        }
+
+        waitMonitorEvent(CGRAPH_ELASTIC_IDLE_INTERVAL);
+
+        // 从休眠中恢复，重新开始计算出队速度，避免将休眠的时长计入等待时间
+        scale_sample_time_ = std::chrono::steady_clock::now();
+        scale_progress_time_ = scale_sample_time_;
+        scale_pop_num_ = thread_counter_.pool_pop_num_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 监控线程休眠，直到有任务写入 pool 队列（仅弹性伸缩时通知）、需要补充预留的辅助线程，或者超时
+     * @param ms
+     */
+    CVoid waitMonitorEvent(CMSec ms) {
+        auto key = scale_event_.prepareWait();
+        if (!monitor_running_ || reserve_pending_.load(std::memory_order_relaxed)
+            || (config_.elastic_enable_ && calcBacklog() > 0)) {
+            scale_event_.cancelWait();
+        } else {
+            scale_event_.commitWait(key, ms);
+        }
+    }
+
+    /**
+     * 补充预留的辅助线程，使空闲的辅助线程个数不少于 secondary_reserve_size_
+     * 仅在监控线程中执行，创建线程的开销不在提交任务的路径上
+     */
+    CVoid fillReserve() {
+        reserve_pending_.store(false, std::memory_order_relaxed);
+        if (config_.secondary_reserve_size_ <= 0) {
+            return;
+        }
+
+        CGRAPH_LOCK_GUARD resizeLock(resize_mutex_);    // 和 destroy() 互斥，确认线程池仍在运行之后，再创建辅助线程
+        if (!is_init_) {
+            return;
+        }
+
+        CInt parkedSize = 0;
+        {
+            CGRAPH_LOCK_GUARD lock(st_mutex_);
+            for (auto& st : secondary_threads_) {
+                parkedSize += (st->done_ && !st->is_running_) ? 1 : 0;
+            }
+        }
+        if (parkedSize < config_.secondary_reserve_size_) {
+            createSecondaryThread(config_.secondary_reserve_size_ - parkedSize);
+        }
+    }
+
+    /**
+     * 唤醒辅助线程之后调用。空闲的辅助线程少于预留个数的时候，通知监控线程在后台补充
+     */
+    CVoid requestReserve() {
+        if (config_.secondary_reserve_size_ > 0
+            && thread_counter_.secondary_idle_num_.load(std::memory_order_relaxed) < config_.secondary_reserve_size_) {
+            reserve_pending_.store(true, std::memory_order_relaxed);
+            scale_event_.notify();
+        }
+    }
+
+    /**
+     * 根据 pool 队列中积压的任务个数和估算的等待时间，调整辅助线程个数
+     * 扩容：等待时间超过 elastic_wait_threshold_ 时，按照积压任务个数，一次增加多个辅助线程
+     * 缩容：连续 elastic_shrink_delay_ 没有积压任务之后，回收一半空闲的多余辅助线程。扩缩容条件不同，避免来回抖动
+     * 在 resize_mutex_ 中执行，和 destroy() 互斥
+     */
+    CVoid scaleSecondaryThread() {
+        CGRAPH_LOCK_GUARD resizeLock(resize_mutex_);
+        if (!is_init_) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        CSize popNum = thread_counter_.pool_pop_num_.load(std::memory_order_relaxed);
+        CSize backlog = calcBacklog();
+        CSize popSize = popNum - scale_pop_num_;
+        CMSec waitTime = 0;
+        if (0 == backlog) {
+            scale_progress_time_ = now;
+        } else if (popSize > 0) {
+            // 按照上一个采样周期内的出队速度，估算积压任务的等待时间
+            auto span = std::chrono::duration_cast<std::chrono::microseconds>(now - scale_sample_time_).count();
+            waitTime = (CMSec)(backlog * span / popSize / 1000);
+            scale_progress_time_ = now;
+        } else {
+            // 一个采样周期内没有任务出队，则等待时间为最近一次出队到现在的时长
+            waitTime = (CMSec)std::chrono::duration_cast<std::chrono::milliseconds>(now - scale_progress_time_).count();
+        }
+        scale_pop_num_ = popNum;
+        scale_sample_time_ = now;
+
+        if (backlog > 0) {
+            scale_calm_time_ = now;
+            if (waitTime >= config_.elastic_wait_threshold_) {
+                CInt needSize = (CInt)((backlog + config_.elastic_backlog_per_thread_ - 1) / config_.elastic_backlog_per_thread_)
+                                - thread_counter_.secondary_idle_num_.load(std::memory_order_relaxed);
+                if (needSize > 0) {
+                    createSecondaryThread(needSize);
+                }
+                wakeupSecondaryThread(backlog);
+            }
+        }
+
+        std::list<std::unique_ptr<UThreadSecondary>> releasedThreads;
+        {
+            CGRAPH_LOCK_GUARD lock(st_mutex_);
+            CInt extraSize = (CInt)secondary_threads_.size() - config_.secondary_thread_size_ - config_.secondary_reserve_size_;
+            if (extraSize > 0 && now - scale_calm_time_ >= std::chrono::milliseconds(config_.elastic_shrink_delay_)) {
+                CInt releaseSize = (extraSize + 1) / 2;
+                for (auto iter = secondary_threads_.begin(); iter != secondary_threads_.end() && releaseSize > 0; ) {
+                    if (!(*iter)->is_running_) {
+                        releasedThreads.splice(releasedThreads.end(), secondary_threads_, iter++);
+                        releaseSize--;
+                        extraSize--;
+                    } else {
+                        iter++;
+                    }
+                }
+                if (!releasedThreads.empty()) {
+                    CGRAPH_TRACE(SCALE_DOWN, releasedThreads.size(), releasedThreads.size())
+                }
+                scale_calm_time_ = now;
+            }
+            thread_counter_.secondary_num_.store((CInt)secondary_threads_.size(), std::memory_order_release);
+            scale_active_ = backlog > 0 || extraSize > 0;
+        }
+        joinSecondaryThreads(releasedThreads);
+    }
+
+    /**
+     * 计算 pool 队列（含优先级队列）中积压的任务个数
+     * @return
+     */
+    CSize calcBacklog() const {
+        CSize popNum = thread_counter_.pool_pop_num_.load(std::memory_order_relaxed);
+        CSize pushNum = thread_counter_.pool_push_num_.load(std::memory_order_relaxed);
+        return pushNum > popNum ? pushNum - popNum : 0;    // 先读出队个数，写入和出队的计数之间没有同步，仅为估算值
+    }
+
+    /**
+     * 任务写入 pool 队列之后调用。开启弹性伸缩的时候，记录写入个数，并唤醒休眠中的弹性伸缩控制器
+     * @param size
+     */
+    CVoid notifyScale(CSize size) {
+        if (config_.elastic_enable_) {
+            thread_counter_.pool_push_num_.fetch_add(size, std::memory_order_relaxed);
+            scale_event_.notify();
+        }
+    }
+
+    /**
+     * 重新检查可用的cpu个数（cgroup 配额或 cpuset 可能在运行时变化），并调整主线程个数和最大线程个数
+     * 主线程个数不超过 init 时创建的 primary 线程对象个数。手动调整过主线程个数之后，仅调整最大线程个数
+     */
+    CVoid updateAutoSize() {
+        CInt cpuNum = UCpuQuota::calcCpuLimit();
+        CGRAPH_LOCK_GUARD resizeLock(resize_mutex_);
+        if (!is_init_ || cpuNum == auto_cpu_num_) {
+            return;
+        }
+
+        auto_cpu_num_ = cpuNum;
+        max_thread_limit_.store(config_.calcAutoMaxSize(cpuNum), std::memory_order_release);
+        if (!primary_resized_) {
+            adjustPrimaryThread(std::min(cpuNum, (CInt)primary_threads_.size()));
+        }
+    }
+
+    /**
+     * 记录线程id和线程index的对应关系
+     * @param id
+     * @param index
+     */
+    CVoid recordThread(const std::thread::id& id, CIndex index) {
+        CGRAPH_LOCK_GUARD lock(record_mutex_);
+        thread_record_map_[(CSize)std::hash<std::thread::id>{}(id)] = index;
+    }
+
+    /**
+     * 删除线程id的记录信息
+     * @param id
+     */
+    CVoid eraseThread(const std::thread::id& id) {
+        CGRAPH_LOCK_GUARD lock(record_mutex_);
+        thread_record_map_.erase((CSize)std::hash<std::thread::id>{}(id));
+    }
+
+    /**
+     * 等待已经从 secondary_threads_ 中取出的辅助线程结束，再累计其统计信息
+     * 需要在 st_mutex_ 之外调用：待回收的线程可能仍在执行任务，任务中提交的新任务可能需要获取 st_mutex_
+     * @param threads 执行之后被清空
+     */
+    CVoid joinSecondaryThreads(std::list<std::unique_ptr<UThreadSecondary>>& threads) {
+        if (threads.empty()) {
+            return;
+        }
+
+        for (auto& st : threads) {
+            st->reset();    // 等待线程结束之后，统计信息不再变化
+        }
+        {
+            CGRAPH_LOCK_GUARD lock(st_mutex_);
+            for (auto& st : threads) {
+                recordExitedThread(*st);
             }
         }
+        threads.clear();
+    }
+
+    /**
+     * 累计已经结束的辅助线程的统计信息。需要在 st_mutex_ 中调用
+     * @param st
+     */
+    CVoid recordExitedThread(const UThreadSecondary& st) {
+        UThreadStats stats;
+        st.collectStats(stats);
+        exited_stats_.merge(stats);
+        secondary_exit_num_++;
+        if (config_.latency_enable_) {
+            exited_latency_.resize(CGRAPH_TASK_TAG_SIZE);
+            st.collectLatency(exited_latency_);
+        }
+    }
+
+    /**
+     * 开启耗时统计的时候，记录任务写入队列的时间和分类标签
+     * @param task
+     * @param tag
+     */
+    CVoid stampTask(UTask& task, CInt tag = CGRAPH_DEFAULT_TASK_TAG) const {
+        if (unlikely(config_.latency_enable_)) {
+            task.stamp(tag);
+        }
     }
 
     CGRAPH_NO_ALLOWED_COPY(UThreadPool)
 
 private:
-    CBool is_init_ { false };                                                       // 是否初始化
-    CInt cur_index_ = 0;                                                            // 记录放入的线程数
-    UAtomicQueue<UTask> task_queue_;                                                // 用于存放普通任务
+    std::atomic<CBool> is_init_ { false };                                          // 是否初始化，监控线程中无锁读取
+    std::atomic<CUInt> cur_index_ {0};                                              // 批量分发任务时，下一次开始的位置
+    UPoolTaskQueue<UTask> task_queue_;                                              // 用于存放普通任务
+    UThreadCounter thread_counter_;                                                 // 所有线程共享的计数信息（休眠、自旋的线程个数）
     UAtomicPriorityQueue<UTask> priority_task_queue_;                               // 运行时间较长的任务队列，仅在辅助线程中执行
     std::vector<UThreadPrimaryPtr> primary_threads_;                                // 记录所有的主线程
     std::list<std::unique_ptr<UThreadSecondary>> secondary_threads_;                // 用于记录所有的辅助线程
     UThreadPoolConfig config_;                                                      // 线程池设置值
     std::thread monitor_thread_;                                                    // 监控线程
+    std::atomic<CBool> monitor_running_ {false};                                    // 监控线程是否继续执行
+    CInt auto_cpu_num_ = 0;                                                         // 自动设置线程个数时，最近一次检查到的可用cpu个数
+    std::atomic<CInt> max_thread_limit_ {0};                                        // 最大线程个数，提交任务时无锁读取。开启自动设置线程个数的时候，由监控线程更新
+    CBool primary_resized_ = false;                                                 // 是否手动调整过主线程个数，在 resize_mutex_ 中读写
+    UEventCount scale_event_;                                                       // 任务写入 pool 队列（弹性伸缩），或需要补充预留辅助线程时，唤醒监控线程
+    std::atomic<CBool> reserve_pending_ {false};                                    // 是否需要补充预留的辅助线程
+    CBool scale_active_ = false;                                                    // 是否有积压任务或多余的辅助线程，需要按照较短的间隔采样
+    CSize scale_pop_num_ = 0;                                                       // 上一次采样时，从 pool 队列中取出的任务总数
+    std::chrono::steady_clock::time_point scale_sample_time_;                       // 上一次采样的时间
+    std::chrono::steady_clock::time_point scale_progress_time_;                     // 最近一次有任务出队（或没有积压任务）的时间
+    std::chrono::steady_clock::time_point scale_calm_time_;                         // 最近一次有积压任务的时间，用于缩容
+    UThreadStats exited_stats_;                                                     // 已经释放的辅助线程的累计统计信息，在 st_mutex_ 中读写
+    CULong secondary_create_num_ = 0;                                               // 创建辅助线程的总个数，在 st_mutex_ 中读写
+    CULong secondary_exit_num_ = 0;                                                 // 释放辅助线程的总个数，在 st_mutex_ 中读写
+    std::vector<UTaskLatency> exited_latency_;                                      // 已经释放的辅助线程的累计耗时信息，在 st_mutex_ 中读写
     std::map<CSize, int> thread_record_map_;                                        // 线程记录的信息
-    std::mutex st_mutex_;                                                           // 辅助线程发生变动的时候，加的mutex信息
+    std::mutex st_mutex_;                                                           // 辅助线程发生变动，或者释放 primary 线程对象（和 getStats() 互斥）的时候，加的mutex信息
+    std::mutex resize_mutex_;                                                       // 调整主线程个数，或监控线程调整线程、和 destroy() 互斥的时候，加的mutex信息
+    std::mutex record_mutex_;                                                       // 保护 thread_record_map_
 };
 
 using UThreadPoolPtr = UThreadPool *;
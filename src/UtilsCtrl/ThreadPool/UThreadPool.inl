@@ -14,11 +14,11 @@
 CGRAPH_NAMESPACE_BEGIN
 
 template<typename FunctionType>
-auto UThreadPool::commit(const FunctionType& func, CIndex index)
--> std::future<decltype(std::declval<FunctionType>()())> {
-    using ResultType = decltype(std::declval<FunctionType>()());
+auto UThreadPool::commit(FunctionType&& func, CIndex index)
+-> std::future<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
 
-    std::packaged_task<ResultType()> task(func);
+    std::packaged_task<ResultType()> task(std::forward<FunctionType>(func));
     std::future<ResultType> result(task.get_future());
 
     execute(std::move(task), index);
@@ -27,57 +27,274 @@ auto UThreadPool::commit(const FunctionType& func, CIndex index)
 
 
 template<typename FunctionType>
-auto UThreadPool::commitWithTid(const FunctionType& func, CIndex tid, CBool enable, CBool lockable)
--> std::future<decltype(std::declval<FunctionType>()())> {
-    using ResultType = decltype(std::declval<FunctionType>()());
-    std::packaged_task<ResultType()> task(std::move(func));
+auto UThreadPool::commitFast(FunctionType&& func, CIndex index)
+-> UFuture<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
+    using TaskType = UPromiseTask<typename std::decay<FunctionType>::type, ResultType>;
+
+    UPromise<ResultType> promise;
+    UFuture<ResultType> result(promise.get_future());
+
+    execute(TaskType(std::forward<FunctionType>(func), std::move(promise)), index);
+    return result;
+}
+
+
+template<typename FunctionType>
+auto UThreadPool::commitWithTid(FunctionType&& func, CIndex tid, CBool enable, CBool lockable)
+-> std::future<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
+
+    std::packaged_task<ResultType()> task(std::forward<FunctionType>(func));
+    std::future<ResultType> result(task.get_future());
+
+    executeWithTid(std::move(task), tid, enable, lockable);
+    return result;
+}
+
+
+template<typename FunctionType>
+auto UThreadPool::commitWithPriority(FunctionType&& func, int priority)
+-> std::future<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
+
+    std::packaged_task<ResultType()> task(std::forward<FunctionType>(func));
+    std::future<ResultType> result(task.get_future());
+
+    executeWithPriority(std::move(task), priority);
+    return result;
+}
+
+
+template<typename FunctionType>
+auto UThreadPool::commitWithLane(FunctionType&& func, UTaskLane lane)
+-> std::future<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
+
+    std::packaged_task<ResultType()> task(std::forward<FunctionType>(func));
     std::future<ResultType> result(task.get_future());
 
-    execute(std::move(task), tid, enable, lockable);
+    executeWithLane(std::move(task), lane);
     return result;
 }
 
 
 template<typename FunctionType>
-auto UThreadPool::commitWithPriority(const FunctionType& func, int priority)
--> std::future<decltype(std::declval<FunctionType>()())> {
-    using ResultType = decltype(std::declval<FunctionType>()());
+auto UThreadPool::commitWithTag(FunctionType&& func, CInt tag, CIndex index)
+-> std::future<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
 
-    std::packaged_task<ResultType()> task(func);
+    std::packaged_task<ResultType()> task(std::forward<FunctionType>(func));
     std::future<ResultType> result(task.get_future());
 
-    if (secondary_threads_.empty()) {
-        createSecondaryThread(1);    // 如果没有开启辅助线程，则直接开启一个
+    executeWithTag(std::move(task), tag, index);
+    return result;
+}
+
+
+template<typename Iterator>
+auto UThreadPool::commitBulk(Iterator begin, Iterator end)
+-> std::vector<std::future<decltype((*begin)())>> {
+    using ResultType = decltype((*begin)());
+
+    UTaskArr tasks;
+    std::vector<std::future<ResultType>> results;
+    tasks.reserve(std::distance(begin, end));
+    results.reserve(tasks.capacity());
+    for (auto iter = begin; iter != end; ++iter) {
+        std::packaged_task<ResultType()> task(*iter);
+        results.emplace_back(task.get_future());
+        tasks.emplace_back(std::move(task));
     }
 
-    priority_task_queue_.push(std::move(task), priority);
+    dispatchBulk(tasks);
+    return results;
+}
+
+
+template<typename FunctionType>
+auto UThreadPool::commitFastWithTid(FunctionType&& func, CIndex tid, CBool enable, CBool lockable)
+-> UFuture<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
+    using TaskType = UPromiseTask<typename std::decay<FunctionType>::type, ResultType>;
+
+    UPromise<ResultType> promise;
+    UFuture<ResultType> result(promise.get_future());
+
+    executeWithTid(TaskType(std::forward<FunctionType>(func), std::move(promise)), tid, enable, lockable);
     return result;
 }
 
 
 template<typename FunctionType>
-CVoid UThreadPool::execute(FunctionType&& task, CIndex index) {
-    CIndex realIndex = dispatch(index);
-    if (realIndex >= 0 && realIndex < config_.default_thread_size_) {
-        primary_threads_[realIndex]->pushTask(std::forward<FunctionType>(task));
-    } else if (CGRAPH_LONG_TIME_TASK_STRATEGY == realIndex) {
-        priority_task_queue_.push(std::forward<FunctionType>(task), CGRAPH_LONG_TIME_TASK_STRATEGY);
-    } else {
-        task_queue_.push(std::forward<FunctionType>(task));
+auto UThreadPool::commitFastWithPriority(FunctionType&& func, int priority)
+-> UFuture<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
+    using TaskType = UPromiseTask<typename std::decay<FunctionType>::type, ResultType>;
+
+    UPromise<ResultType> promise;
+    UFuture<ResultType> result(promise.get_future());
+
+    executeWithPriority(TaskType(std::forward<FunctionType>(func), std::move(promise)), priority);
+    return result;
+}
+
+
+template<typename FunctionType>
+auto UThreadPool::commitFastWithLane(FunctionType&& func, UTaskLane lane)
+-> UFuture<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
+    using TaskType = UPromiseTask<typename std::decay<FunctionType>::type, ResultType>;
+
+    UPromise<ResultType> promise;
+    UFuture<ResultType> result(promise.get_future());
+
+    executeWithLane(TaskType(std::forward<FunctionType>(func), std::move(promise)), lane);
+    return result;
+}
+
+
+template<typename FunctionType>
+auto UThreadPool::commitFastWithTag(FunctionType&& func, CInt tag, CIndex index)
+-> UFuture<UTaskResultType<FunctionType>> {
+    using ResultType = UTaskResultType<FunctionType>;
+    using TaskType = UPromiseTask<typename std::decay<FunctionType>::type, ResultType>;
+
+    UPromise<ResultType> promise;
+    UFuture<ResultType> result(promise.get_future());
+
+    executeWithTag(TaskType(std::forward<FunctionType>(func), std::move(promise)), tag, index);
+    return result;
+}
+
+
+template<typename Iterator>
+auto UThreadPool::commitFastBulk(Iterator begin, Iterator end)
+-> std::vector<UFuture<UTaskResultType<decltype(*begin)>>> {
+    using ResultType = UTaskResultType<decltype(*begin)>;
+    using TaskType = UPromiseTask<typename std::decay<decltype(*begin)>::type, ResultType>;
+
+    UTaskArr tasks;
+    std::vector<UFuture<ResultType>> results;
+    tasks.reserve(std::distance(begin, end));
+    results.reserve(tasks.capacity());
+    for (auto iter = begin; iter != end; ++iter) {
+        UPromise<ResultType> promise;
+        results.emplace_back(promise.get_future());
+        tasks.emplace_back(TaskType(*iter, std::move(promise)));
     }
+
+    dispatchBulk(tasks);
+    return results;
+}
+
+
+template<typename FunctionType>
+CVoid UThreadPool::execute(FunctionType&& task, CIndex index) {
+    executeWithTag(std::forward<FunctionType>(task), CGRAPH_DEFAULT_TASK_TAG, index);
 }
 
 
 template<typename FunctionType>
 CVoid UThreadPool::executeWithTid(FunctionType&& task, CIndex tid, CBool enable, CBool lockable) {
-    if (likely(tid >= 0 && tid < config_.default_thread_size_)) {
-        primary_threads_[tid]->pushTask(std::forward<FunctionType>(task), enable, lockable);
+    UTask curTask(std::forward<FunctionType>(task));
+    stampTask(curTask);
+    UThreadPrimaryPtr thread = selectTidThread(tid, enable, lockable);
+    if (likely(thread)) {
+        thread->pushTask(std::move(curTask), enable, lockable);
     } else {
         // 如果超出主线程的范围，则默认写入 pool 通用的任务队列中
-        task_queue_.push(std::forward<FunctionType>(task));
+        task_queue_.push(std::move(curTask));
+        CGRAPH_TRACE(ENQUEUE, CGRAPH_POOL_TASK_STRATEGY, 1)
+        notifyScale(1);
+        wakeupIdleThread(1);
     }
 }
 
+
+template<typename FunctionType>
+CVoid UThreadPool::executeWithPriority(FunctionType&& task, int priority) {
+    UTask curTask(std::forward<FunctionType>(task));
+    stampTask(curTask);
+
+    if (unlikely(thread_counter_.secondary_num_.load(std::memory_order_acquire) <= 0)) {
+        /**
+         * 没有辅助线程的时候，写入通用队列，防止任务一直无法被执行
+         * 不在提交的路径上创建线程，辅助线程由监控线程在后台补充
+         */
+        execute(std::move(curTask), CGRAPH_POOL_TASK_STRATEGY);
+    } else {
+        priority_task_queue_.push(std::move(curTask), priority);
+        CGRAPH_TRACE(ENQUEUE, CGRAPH_LONG_TIME_TASK_STRATEGY, 1)
+        notifyScale(1);
+        wakeupSecondaryThread(1);
+    }
+    requestReserve();
+}
+
+
+template<typename FunctionType>
+CVoid UThreadPool::executeWithLane(FunctionType&& task, UTaskLane lane) {
+    const CInt primarySize = getPrimaryThreadSize();
+    if (UTaskLane::NORMAL == lane || unlikely(primarySize <= 0)) {
+        execute(std::forward<FunctionType>(task));
+        return;
+    }
+
+    // 优先写入当前的 primary 线程，否则随机选择一个 primary 线程
+    UThreadPrimaryPtr thread = getLocalThread();
+    if (nullptr == thread) {
+        thread = primary_threads_[CGRAPH_FAST_RANDOM() % primarySize];
+    }
+    UTask curTask(std::forward<FunctionType>(task));
+    stampTask(curTask);
+    thread->pushLaneTask(std::move(curTask), lane);
+}
+
+
+template<typename FunctionType>
+CVoid UThreadPool::executeWithTag(FunctionType&& task, CInt tag, CIndex index) {
+    UTask curTask(std::forward<FunctionType>(task));
+    stampTask(curTask, tag);
+
+    UThreadPrimaryPtr localThread = nullptr;
+    if (CGRAPH_DEFAULT_TASK_STRATEGY == index && (localThread = getLocalThread())) {
+        // 在 primary 线程中提交的任务，直接写入当前线程的本地队列中
+        localThread->pushLocalTask(std::move(curTask));
+        return;
+    }
+
+    CIndex realIndex = dispatch(index);
+    if (realIndex >= 0 && realIndex < getPrimaryThreadSize()) {
+        primary_threads_[realIndex]->pushTask(std::move(curTask));
+    } else if (CGRAPH_LONG_TIME_TASK_STRATEGY == realIndex
+               && likely(thread_counter_.secondary_num_.load(std::memory_order_acquire) > 0)) {
+        // 长时间任务仅在辅助线程中执行。没有辅助线程的时候，写入通用队列
+        priority_task_queue_.push(std::move(curTask), CGRAPH_LONG_TIME_TASK_STRATEGY);
+        CGRAPH_TRACE(ENQUEUE, CGRAPH_LONG_TIME_TASK_STRATEGY, 1)
+        notifyScale(1);
+        wakeupSecondaryThread(1);
+        requestReserve();
+    } else {
+        task_queue_.push(std::move(curTask));
+        CGRAPH_TRACE(ENQUEUE, CGRAPH_POOL_TASK_STRATEGY, 1)
+        notifyScale(1);
+        wakeupIdleThread(1);
+    }
+}
+
+
+template<typename Iterator>
+CVoid UThreadPool::executeBulk(Iterator begin, Iterator end) {
+    UTaskArr tasks;
+    tasks.reserve(std::distance(begin, end));
+    for (auto iter = begin; iter != end; ++iter) {
+        tasks.emplace_back(*iter);
+    }
+
+    dispatchBulk(tasks);
+}
+
 CGRAPH_NAMESPACE_END
 
 #endif    // CGRAPH_UTHREADPOOL_INL
@@ -9,6 +9,7 @@
 #ifndef CGRAPH_UTHREADPOOLCONFIG_H
 #define CGRAPH_UTHREADPOOLCONFIG_H
 
+#include <vector>
 #include <algorithm>
 
 #include "UThreadObject.h"
@@ -20,6 +21,7 @@ struct UThreadPoolConfig : public CStruct {
     /** 具体值含义，参考UThreadPoolDefine.h文件 */
     CInt default_thread_size_ = CGRAPH_DEFAULT_THREAD_SIZE;
     CInt secondary_thread_size_ = CGRAPH_SECONDARY_THREAD_SIZE;
+    CInt secondary_reserve_size_ = CGRAPH_SECONDARY_RESERVE_SIZE;
     CInt max_thread_size_ = CGRAPH_MAX_THREAD_SIZE;
     CInt max_task_steal_range_ = CGRAPH_MAX_TASK_STEAL_RANGE;
     CInt max_local_batch_size_ = CGRAPH_MAX_LOCAL_BATCH_SIZE;
@@ -27,20 +29,34 @@ struct UThreadPoolConfig : public CStruct {
     CInt max_steal_batch_size_ = CGRAPH_MAX_STEAL_BATCH_SIZE;
     CInt primary_thread_busy_epoch_ = CGRAPH_PRIMARY_THREAD_BUSY_EPOCH;
     CMSec primary_thread_empty_interval_ = CGRAPH_PRIMARY_THREAD_EMPTY_INTERVAL;
+    UThreadWaitStrategy wait_strategy_ = CGRAPH_WAIT_STRATEGY;
+    CInt max_spin_thread_size_ = CGRAPH_MAX_SPIN_THREAD_SIZE;
     CSec secondary_thread_ttl_ = CGRAPH_SECONDARY_THREAD_TTL;
     CSec monitor_span_ = CGRAPH_MONITOR_SPAN;
+    CMSec elastic_interval_ = CGRAPH_ELASTIC_INTERVAL;
+    CMSec elastic_wait_threshold_ = CGRAPH_ELASTIC_WAIT_THRESHOLD;
+    CInt elastic_backlog_per_thread_ = CGRAPH_ELASTIC_BACKLOG_PER_THREAD;
+    CMSec elastic_shrink_delay_ = CGRAPH_ELASTIC_SHRINK_DELAY;
     CMSec queue_emtpy_interval_ = CGRAPH_QUEUE_EMPTY_INTERVAL;
+    CMSec priority_aging_interval_ = CGRAPH_PRIORITY_AGING_INTERVAL;
+    CInt dispatch_queue_threshold_ = CGRAPH_DISPATCH_QUEUE_THRESHOLD;
     CInt primary_thread_policy_ = CGRAPH_PRIMARY_THREAD_POLICY;
     CInt secondary_thread_policy_ = CGRAPH_SECONDARY_THREAD_POLICY;
     CInt primary_thread_priority_ = CGRAPH_PRIMARY_THREAD_PRIORITY;
     CInt secondary_thread_priority_ = CGRAPH_SECONDARY_THREAD_PRIORITY;
     CBool bind_cpu_enable_ = CGRAPH_BIND_CPU_ENABLE;
+    UCpuBindPolicy bind_cpu_policy_ = CGRAPH_BIND_CPU_POLICY;
+    std::vector<CInt> bind_cpu_list_;                        // 仅在 EXPLICIT 策略下生效，第 i 个主线程绑定在第 (i % size) 个cpu上
     CBool batch_task_enable_ = CGRAPH_BATCH_TASK_ENABLE;
+    CBool steal_half_enable_ = CGRAPH_STEAL_HALF_ENABLE;
     CBool monitor_enable_ = CGRAPH_MONITOR_ENABLE;
+    CBool auto_size_enable_ = CGRAPH_AUTO_SIZE_ENABLE;
+    CBool elastic_enable_ = CGRAPH_ELASTIC_ENABLE;
+    CBool latency_enable_ = CGRAPH_LATENCY_ENABLE;
 
     CStatus check() const {
         CGRAPH_FUNCTION_BEGIN
-        if (default_thread_size_ < 0 || secondary_thread_size_ < 0) {
+        if (default_thread_size_ < 0 || secondary_thread_size_ < 0 || secondary_reserve_size_ < 0) {
             CGRAPH_RETURN_ERROR_STATUS("thread size cannot less than 0")
         }
 
@@ -50,24 +66,76 @@ struct UThreadPoolConfig : public CStruct {
             + std::to_string(secondary_thread_size_)  + "]");
         }
 
-        if (monitor_enable_ && monitor_span_ <= 0) {
+        if (dispatch_queue_threshold_ < 0) {
+            CGRAPH_RETURN_ERROR_STATUS("dispatch queue threshold cannot less than 0")
+        }
+
+        if (priority_aging_interval_ < 0) {
+            CGRAPH_RETURN_ERROR_STATUS("priority aging interval cannot less than 0")
+        }
+
+        if (max_spin_thread_size_ < 0) {
+            CGRAPH_RETURN_ERROR_STATUS("max spin thread size cannot less than 0")
+        }
+
+        if (bind_cpu_enable_ && UCpuBindPolicy::EXPLICIT == bind_cpu_policy_
+            && (bind_cpu_list_.empty() || std::any_of(bind_cpu_list_.begin(), bind_cpu_list_.end(),
+                                                      [](CInt cpu) { return cpu < 0; }))) {
+            CGRAPH_RETURN_ERROR_STATUS("bind cpu list cannot be empty or contain negative cpu")
+        }
+
+        if ((monitor_enable_ || auto_size_enable_) && monitor_span_ <= 0) {
             CGRAPH_RETURN_ERROR_STATUS("monitor span cannot less than 0")
         }
+
+        if (elastic_enable_ && (elastic_interval_ <= 0 || elastic_wait_threshold_ < 0
+                                || elastic_backlog_per_thread_ <= 0 || elastic_shrink_delay_ < 0)) {
+            CGRAPH_RETURN_ERROR_STATUS("elastic interval and backlog per thread should be positive, wait threshold and shrink delay cannot less than 0")
+        }
         CGRAPH_FUNCTION_END
     }
 
 protected:
     /**
-     * 计算可盗取的范围，盗取范围不能超过默认线程数-1
+     * 根据可用的cpu个数，设置线程个数。主线程个数和cpu个数相同
+     * @param cpuNum
+     */
+    CVoid calcAutoSize(CInt cpuNum) {
+        default_thread_size_ = cpuNum;
+        max_thread_size_ = calcAutoMaxSize(cpuNum);
+    }
+
+    /**
+     * 根据可用的cpu个数，计算最大线程个数。为cpu个数的2倍，并且至少可以容纳默认的主线程和辅助线程
+     * @param cpuNum
+     * @return
+     */
+    CInt calcAutoMaxSize(CInt cpuNum) const {
+        return (std::max)(cpuNum * 2, default_thread_size_ + secondary_thread_size_);
+    }
+
+    /**
+     * 是否需要开启监控线程。有空间创建预留的辅助线程的时候，也需要通过监控线程在后台补充
+     * @return
+     */
+    CBool isMonitorRequired() const {
+        return monitor_enable_ || auto_size_enable_ || elastic_enable_
+               || (secondary_reserve_size_ > 0 && max_thread_size_ > default_thread_size_ + secondary_thread_size_);
+    }
+
+    /**
+     * 计算可盗取的范围，盗取范围不能超过主线程数-1
+     * @param threadSize 当前的主线程个数
      * @return
      */
-    int calcStealRange() const {
-        int range = (std::min)(this->max_task_steal_range_, this->default_thread_size_ - 1);
+    int calcStealRange(int threadSize) const {
+        int range = (std::min)(this->max_task_steal_range_, threadSize - 1);
         return range;
     }
 
     friend class UThreadPrimary;
     friend class UThreadSecondary;
+    friend class UThreadPool;
 };
 
 using UThreadPoolConfigPtr = UThreadPoolConfig *;
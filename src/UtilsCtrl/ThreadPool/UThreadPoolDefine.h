@@ -17,8 +17,45 @@
 
 #include "../UtilsDefine.h"
 
+/** UTask 内部直接存放函数体的空间大小（单位：字节），超过此大小的函数体，会在堆上申请 */
+    #ifndef _CGRAPH_TASK_INLINE_SIZE_
+#define _CGRAPH_TASK_INLINE_SIZE_ 48
+    #endif
+
 CGRAPH_NAMESPACE_BEGIN
 
+/** 线程中没有任务时，等待新任务的策略 */
+enum class UThreadWaitStrategy {
+    SPIN = 1,                 // 通过 cpu pause 指令持续自旋，不休眠。延迟最低，但会占满cpu
+    YIELD = 2,                // 先通过 yield 空转若干轮，再休眠
+    BLOCK = 3,                // 直接休眠，最节省cpu
+    ADAPTIVE = 4,             // 根据最近任务到达的时间间隔，自适应调整自旋时长，超时后休眠
+};
+
+/** 主线程中任务所在的通道，数值越小越优先执行 */
+enum class UTaskLane {
+    URGENT = 0,               // 延迟敏感的任务，优先于其他所有通道执行
+    HIGH = 1,                 // 高优先级任务，优先于普通任务执行
+    NORMAL = 2,               // 普通任务，默认通道
+    BACKGROUND = 3,           // 后台任务，仅在其他通道、盗取目标和通用队列都为空的时候执行
+};
+
+/** 开启绑定cpu模式时，主线程和cpu的对应策略 */
+enum class UCpuBindPolicy {
+    COMPACT = 1,              // 紧凑绑定：相邻的线程，优先绑定在同一物理核的超线程、共享末级缓存的物理核上
+    SCATTER = 2,              // 分散绑定：线程在各 NUMA 节点之间轮流分布，节点内优先绑定在不同的物理核上
+    PHYSICAL_CORE = 3,        // 每个物理核一个线程：物理核都被使用之后，才会绑定在其余超线程上
+    EXPLICIT = 4,             // 按照配置中指定的cpu列表，依次绑定
+};
+
+/** 盗取目标和当前线程之间的拓扑距离，数值越小越优先盗取 */
+enum class UStealDistance {
+    SMT_SIBLING = 0,          // 同一物理核上的超线程
+    SHARED_CACHE = 1,         // 共享末级缓存的物理核
+    SAME_NODE = 2,            // 同一 NUMA 节点。未开启绑定cpu的时候，均视为此距离
+    REMOTE_NODE = 3,          // 其他 NUMA 节点，仅在连续盗取失败之后尝试
+};
+
 static const CInt CGRAPH_CPU_NUM = (CInt)std::thread::hardware_concurrency();
 static const CInt CGRAPH_THREAD_TYPE_PRIMARY = 1;
 static const CInt CGRAPH_THREAD_TYPE_SECONDARY = 2;
@@ -36,8 +73,33 @@ static const CInt CGRAPH_THREAD_MIN_PRIORITY = 0;
 static const CInt CGRAPH_THREAD_MAX_PRIORITY = 99;                                          // 线程最高优先级
 static const CMSec CGRAPH_MAX_BLOCK_TTL = 1999999999;                                       // 最大阻塞时间，单位为ms
 static const CUInt CGRAPH_DEFAULT_RINGBUFFER_SIZE = 64;                                     // 默认环形队列的大小
+static const CLong CGRAPH_DEFAULT_WORK_STEALING_CAPACITY = 256;                            // 默认盗取队列的初始容量，不足时自动扩容
+static const CSize CGRAPH_WORK_STEALING_RESERVE_SIZE = 64;                                 // 主线程的普通队列中，预先申请的节点个数
+static const CSize CGRAPH_DEFAULT_SEGMENT_SIZE = 256;                                      // 默认无锁分段队列中，每段的大小
+static const CSize CGRAPH_ATOMIC_QUEUE_INIT_SIZE = 64;                                     // 加锁队列中，环形缓冲区的初始大小，需要为2的幂次
+static const CSize CGRAPH_CACHE_LINE_SIZE = 64;                                            // 缓存行大小，用于隔离不同线程频繁写入的数据
 static const CIndex CGRAPH_MAIN_THREAD_ID = -1;                                             // 启动线程id标识（非上述主线程）
 static const CIndex CGRAPH_SECONDARY_THREAD_COMMON_ID = -2;                                 // 辅助线程统一id标识
+static const CSize CGRAPH_TASK_INLINE_SIZE = _CGRAPH_TASK_INLINE_SIZE_;                     // UTask 内部直接存放函数体的空间大小
+static const CInt CGRAPH_FUTURE_SPIN_TIMES = 64;                                            // UFuture 阻塞等待之前，自旋的最大次数
+static const CLong CGRAPH_FUTURE_SPIN_NS = 1000;                                            // UFuture 阻塞等待之前，自旋的最大时长（ns）
+static const CSize CGRAPH_FUTURE_STATE_CACHE_SIZE = 64;                                     // 每个线程中，缓存 UFuture 共享状态的最大个数
+static const CInt CGRAPH_PRIMARY_FAIR_INTERVAL = 61;                                         // 主线程每获取多少次任务，优先处理一次外部写入的任务，防止递归提交时外部任务饥饿
+static const CInt CGRAPH_TASK_LANE_SIZE = 4;                                                 // 主线程中任务通道的个数，和 UTaskLane 对应
+static const CInt CGRAPH_SPIN_PAUSE_TIMES = 32;                                              // 自旋等待时，每一轮执行 pause 指令的次数
+static const CLong CGRAPH_ADAPTIVE_MAX_SPIN_NS = 100000;                                     // 自适应等待策略中，最长的自旋时间，单位为ns。平均空闲时长超过此值，则直接休眠
+static const CInt CGRAPH_STEAL_DISTANCE_SIZE = 4;                                           // 盗取距离的个数，和 UStealDistance 对应
+static const CInt CGRAPH_REMOTE_STEAL_FAIL_TIMES = 4;                                        // 连续盗取失败多少轮之后，才从其他 NUMA 节点的线程中盗取
+static const CInt CGRAPH_RETIRE_DRAIN_RETRY_TIMES = 1024;                                    // 回收主线程时，转移剩余任务的最大失败重试次数
+static const CMSec CGRAPH_ELASTIC_IDLE_INTERVAL = 1000;                                      // 弹性伸缩控制器没有积压任务时，最长的等待时间，单位为ms
+static const CInt CGRAPH_MAX_STEAL_BACKOFF = 64;                                             // 折半盗取模式中，连续盗取失败后，最多跳过的盗取轮数
+static const CInt CGRAPH_TASK_TAG_SIZE = 8;                                                  // 任务分类标签的个数，耗时统计按照标签分别记录。超出范围的标签，按照默认标签统计
+static const CInt CGRAPH_DEFAULT_TASK_TAG = 0;                                               // 默认的任务分类标签
+static const CInt CGRAPH_LATENCY_SUB_BUCKET_BITS = 3;                                        // 耗时直方图中，每个2的幂次区间再细分为 2^3 个桶，相对误差不超过 12.5%
+static const CInt CGRAPH_LATENCY_MAX_BITS = 36;                                              // 耗时直方图记录的最大值为 2^36 ns（约68s），超过的按照最大值记录
+static const CInt CGRAPH_LATENCY_BUCKET_SIZE = (CGRAPH_LATENCY_MAX_BITS - CGRAPH_LATENCY_SUB_BUCKET_BITS + 1) << CGRAPH_LATENCY_SUB_BUCKET_BITS;    // 耗时直方图中桶的个数
+static const CSize CGRAPH_TRACE_BUFFER_SIZE = 16384;                                        // 开启 _CGRAPH_TRACE_ENABLE_ 后，每个线程中记录调度事件的环形缓冲区大小，需要为2的幂次。写满之后，覆盖最早的事件
+static const CSize CGRAPH_TRACE_MAX_BUFFER_SIZE = 256;                                     // 保留的环形缓冲区的最大个数。超过之后，优先复用已经退出的线程的缓冲区
 
 static const CInt CGRAPH_DEFAULT_TASK_STRATEGY = -1;                                         // 默认线程调度策略
 static const CInt CGRAPH_POOL_TASK_STRATEGY = -2;                                            // 固定用pool中的队列的调度策略
@@ -48,19 +110,33 @@ static const CInt CGRAPH_LONG_TIME_TASK_STRATEGY = -101;
  */
 static const CInt CGRAPH_DEFAULT_THREAD_SIZE = 8;                                            // 默认开启主线程个数
 static const CInt CGRAPH_SECONDARY_THREAD_SIZE = 0;                                          // 默认开启辅助线程个数
+static const CInt CGRAPH_SECONDARY_RESERVE_SIZE = 1;                                         // 预留的空闲辅助线程个数。由监控线程在后台补充，提交任务时仅需唤醒，不需要创建线程
 static const CInt CGRAPH_MAX_THREAD_SIZE = 8;                                                // 最大线程个数
 static const CInt CGRAPH_MAX_TASK_STEAL_RANGE = 7;                                           // 盗取机制相邻范围
 static const CBool CGRAPH_BATCH_TASK_ENABLE = false;                                         // 是否开启批量任务功能
 static const CInt CGRAPH_MAX_LOCAL_BATCH_SIZE = 2;                                           // 批量执行本地任务最大值
 static const CInt CGRAPH_MAX_POOL_BATCH_SIZE = 2;                                            // 批量执行通用任务最大值
 static const CInt CGRAPH_MAX_STEAL_BATCH_SIZE = 2;                                           // 批量盗取任务最大值
+static const CBool CGRAPH_STEAL_HALF_ENABLE = false;                                         // 是否开启折半盗取模式：随机选择起始目标，一次盗取目标队列中一半的任务，失败后指数退避
 static const CInt CGRAPH_PRIMARY_THREAD_BUSY_EPOCH = 5;                                      // 主线程进入wait状态的轮数，数值越大，理论性能越高，但空转可能性也越大
 static const CMSec CGRAPH_PRIMARY_THREAD_EMPTY_INTERVAL = 1000;                              // 主线程进入休眠状态的默认时间
+static const UThreadWaitStrategy CGRAPH_WAIT_STRATEGY = UThreadWaitStrategy::YIELD;         // 线程没有任务时的等待策略
+static const CInt CGRAPH_MAX_SPIN_THREAD_SIZE = 4;                                           // 同时自旋等待的最大线程个数，超过的线程直接休眠。YIELD 策略不受限制
 static const CSec CGRAPH_SECONDARY_THREAD_TTL = 10;                                          // 辅助线程ttl，单位为s
+static const CBool CGRAPH_AUTO_SIZE_ENABLE = false;                                          // 是否根据 cgroup cpu配额和 cpuset 自动设置线程个数。开启后，default/max thread size 由可用cpu个数计算
 static const CBool CGRAPH_MONITOR_ENABLE = false;                                            // 是否开启监控程序
 static const CSec CGRAPH_MONITOR_SPAN = 5;                                                   // 监控线程执行间隔，单位为s
+static const CBool CGRAPH_ELASTIC_ENABLE = false;                                            // 是否开启弹性伸缩。开启后，由写入事件触发，根据积压任务个数和等待时间调整辅助线程个数，不再按照 monitor_span_ 和 ttl 调整
+static const CMSec CGRAPH_ELASTIC_INTERVAL = 5;                                              // 弹性伸缩时，有积压任务或多余辅助线程的采样间隔，单位为ms
+static const CMSec CGRAPH_ELASTIC_WAIT_THRESHOLD = 2;                                        // 估算的任务等待时间超过此值，则增加辅助线程，单位为ms
+static const CInt CGRAPH_ELASTIC_BACKLOG_PER_THREAD = 16;                                    // 扩容时，每多少个积压任务，增加一个辅助线程
+static const CMSec CGRAPH_ELASTIC_SHRINK_DELAY = 1000;                                       // 连续此时长没有积压任务，才回收空闲的辅助线程，单位为ms
 static const CMSec CGRAPH_QUEUE_EMPTY_INTERVAL = 1000;                                       // 队列为空时，等待的时间。仅针对辅助线程，单位为ms
-static const CBool CGRAPH_BIND_CPU_ENABLE = false;                                           // 是否开启绑定cpu模式（仅针对主线程）
+static const CInt CGRAPH_DISPATCH_QUEUE_THRESHOLD = 32;                                       // 分发任务时，主线程中待执行任务超过此值视为繁忙。随机选择的两个主线程都繁忙时，写入通用队列
+static const CMSec CGRAPH_PRIORITY_AGING_INTERVAL = 0;                                       // 优先级任务每等待此时长，优先级提升1，防止低优先级任务饥饿。默认为0，表示不开启，单位为ms
+static const CBool CGRAPH_LATENCY_ENABLE = false;                                           // 是否开启任务耗时统计。开启后，按照任务分类标签，记录任务的等待时长和执行时长
+static const CBool CGRAPH_BIND_CPU_ENABLE = false;                                           // 是否开启绑定cpu模式。主线程绑定在单个cpu上，辅助线程和监控线程绑定在所有用到的cpu上
+static const UCpuBindPolicy CGRAPH_BIND_CPU_POLICY = UCpuBindPolicy::PHYSICAL_CORE;         // 绑定cpu的策略
 static const CInt CGRAPH_PRIMARY_THREAD_POLICY = CGRAPH_THREAD_SCHED_OTHER;                  // 主线程调度策略
 static const CInt CGRAPH_SECONDARY_THREAD_POLICY = CGRAPH_THREAD_SCHED_OTHER;                // 辅助线程调度策略
 static const CInt CGRAPH_PRIMARY_THREAD_PRIORITY = CGRAPH_THREAD_MIN_PRIORITY;               // 主线程调度优先级（取值范围0~99，配合调度策略一起使用，不建议不了解相关内容的童鞋做修改）
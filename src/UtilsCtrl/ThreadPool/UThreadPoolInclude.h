@@ -13,10 +13,15 @@
 #include "UThreadPool.h"
 #include "UThreadPoolDefine.h"
 #include "UThreadPoolConfig.h"
+#include "UThreadPoolStats.h"
+#include "UThreadPoolTrace.h"
 #include "Queue/UQueueInclude.h"
 #include "Task/UTaskInclude.h"
 #include "Thread/UThreadInclude.h"
 #include "Lock/ULockInclude.h"
 #include "Semaphore/USemaphore.h"
+#include "Semaphore/UEventCount.h"
+#include "Topology/UCpuTopology.h"
+#include "Topology/UCpuQuota.h"
 
 #endif //CGRAPH_UTHREADPOOLINCLUDE_H
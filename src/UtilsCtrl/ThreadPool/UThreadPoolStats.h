@@ -0,0 +1,224 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: UThreadPoolStats.h
+@Time: 2026/10/17 23:40
+@Desc: 线程池运行时的统计信息
+***************************/
+
+#ifndef CGRAPH_UTHREADPOOLSTATS_H
+#define CGRAPH_UTHREADPOOLSTATS_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "UThreadObject.h"
+#include "UThreadPoolDefine.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+/**
+ * 耗时直方图，单位为ns。按照2的幂次分段，每段再细分为 2^CGRAPH_LATENCY_SUB_BUCKET_BITS 个桶（参考 HdrHistogram）
+ * 小于 2^CGRAPH_LATENCY_SUB_BUCKET_BITS 的数值，每个数值一个桶
+ */
+struct ULatencyHistogram : public CStruct {
+    CULong buckets_[CGRAPH_LATENCY_BUCKET_SIZE] {};                    // 每个桶中记录的次数
+
+    /**
+     * 计算数值所在的桶
+     * @param ns
+     * @return
+     */
+    static CInt calcBucket(std::uint64_t ns) {
+        const std::uint64_t maxValue = ((std::uint64_t)1 << CGRAPH_LATENCY_MAX_BITS) - 1;
+        if (ns > maxValue) {
+            ns = maxValue;
+        }
+        if (ns < ((std::uint64_t)1 << CGRAPH_LATENCY_SUB_BUCKET_BITS)) {
+            return (CInt)ns;
+        }
+
+        const CInt exp = highestBit(ns);
+        const CInt shift = exp - CGRAPH_LATENCY_SUB_BUCKET_BITS;
+        return ((shift + 1) << CGRAPH_LATENCY_SUB_BUCKET_BITS)
+               + (CInt)((ns >> shift) - ((std::uint64_t)1 << CGRAPH_LATENCY_SUB_BUCKET_BITS));
+    }
+
+    /**
+     * 计算桶中可以记录的最大值
+     * @param bucket
+     * @return
+     */
+    static std::uint64_t calcBucketValue(CInt bucket) {
+        const CInt shift = (bucket >> CGRAPH_LATENCY_SUB_BUCKET_BITS) - 1;
+        if (shift < 0) {
+            return (std::uint64_t)bucket;
+        }
+
+        const std::uint64_t sub = (std::uint64_t)(bucket & ((1 << CGRAPH_LATENCY_SUB_BUCKET_BITS) - 1));
+        return ((((std::uint64_t)1 << CGRAPH_LATENCY_SUB_BUCKET_BITS) + sub + 1) << shift) - 1;
+    }
+
+    /**
+     * 获取记录的总次数
+     * @return
+     */
+    CULong getCount() const {
+        CULong count = 0;
+        for (CULong num : buckets_) {
+            count += num;
+        }
+        return count;
+    }
+
+    /**
+     * 计算分位数对应的耗时，返回所在桶的最大值
+     * @param percentile 取值范围 (0, 1]，如 0.5/0.99/0.999 分别对应 p50/p99/p999
+     * @return 没有记录的时候，返回0
+     */
+    std::uint64_t calcPercentile(CDouble percentile) const {
+        const CULong count = getCount();
+        if (0 == count) {
+            return 0;
+        }
+
+        CULong target = (CULong)std::ceil(percentile * (CDouble)count);
+        target = (std::max)((std::min)(target, count), (CULong)1);
+        CULong cur = 0;
+        for (CInt i = 0; i < CGRAPH_LATENCY_BUCKET_SIZE; i++) {
+            cur += buckets_[i];
+            if (cur >= target) {
+                return calcBucketValue(i);
+            }
+        }
+        return calcBucketValue(CGRAPH_LATENCY_BUCKET_SIZE - 1);
+    }
+
+    std::uint64_t calcP50() const {
+        return calcPercentile(0.5);
+    }
+
+    std::uint64_t calcP99() const {
+        return calcPercentile(0.99);
+    }
+
+    std::uint64_t calcP999() const {
+        return calcPercentile(0.999);
+    }
+
+    /**
+     * 累加其他直方图的记录
+     * @param histogram
+     * @return
+     */
+    ULatencyHistogram& merge(const ULatencyHistogram& histogram) {
+        for (CInt i = 0; i < CGRAPH_LATENCY_BUCKET_SIZE; i++) {
+            buckets_[i] += histogram.buckets_[i];
+        }
+        return *this;
+    }
+
+private:
+    static CInt highestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        CInt bit = 0;
+        while (value >>= 1) {
+            bit++;
+        }
+        return bit;
+#endif
+    }
+};
+
+
+/** 同一分类标签的任务，等待时长（写入队列到开始执行）和执行时长的直方图 */
+struct UTaskLatency : public CStruct {
+    ULatencyHistogram wait_;                                           // 等待时长
+    ULatencyHistogram run_;                                            // 执行时长
+
+    UTaskLatency& merge(const UTaskLatency& latency) {
+        wait_.merge(latency.wait_);
+        run_.merge(latency.run_);
+        return *this;
+    }
+};
+
+
+/** 单个线程的统计信息。各计数仅由对应的线程写入，获取的时候才汇总，数值之间不保证严格一致 */
+struct UThreadStats : public CStruct {
+    CIndex index_ = CGRAPH_SECONDARY_THREAD_COMMON_ID;                  // 线程index，辅助线程统一为 -2
+    CBool is_active_ = false;                                          // 是否正在运行（未被回收或释放）
+    CULong task_num_ = 0;                                              // 执行的任务个数
+    CULong local_pop_num_ = 0;                                         // 从本线程的队列（含通道）中获取的任务个数，通过其他来源的个数推算
+    CULong pool_pop_num_ = 0;                                          // 从 pool 队列（含优先级队列）中获取的任务个数
+    CULong steal_task_num_ = 0;                                        // 通过盗取获取并执行的任务个数，不含转存到本地队列中的任务
+    CULong steal_attempt_num_ = 0;                                     // 盗取尝试的次数
+    CULong steal_success_num_ = 0;                                     // 盗取成功的次数
+    CULong steal_distance_num_[CGRAPH_STEAL_DISTANCE_SIZE] {};         // 按照拓扑距离（UStealDistance），分别记录盗取成功的次数
+    CULong batch_num_ = 0;                                             // 批量执行的批次数，task_num_ / batch_num_ 为平均每批的任务个数
+    CULong park_num_ = 0;                                              // 休眠的次数
+    CULong wakeup_num_ = 0;                                            // 休眠中被唤醒的次数，其余为超时结束休眠
+    std::uint64_t parked_ns_ = 0;                                      // 休眠的总时长，单位为ns
+    std::uint64_t alive_ns_ = 0;                                       // 线程开启的总时长，单位为ns。减去 parked_ns_，为执行任务和自旋、查询任务的时长
+    CSize queue_size_ = 0;                                             // 本线程队列中，待执行任务的大致个数
+
+    /**
+     * 累加其他线程的统计信息
+     * @param stats
+     * @return
+     */
+    UThreadStats& merge(const UThreadStats& stats) {
+        task_num_ += stats.task_num_;
+        local_pop_num_ += stats.local_pop_num_;
+        pool_pop_num_ += stats.pool_pop_num_;
+        steal_task_num_ += stats.steal_task_num_;
+        steal_attempt_num_ += stats.steal_attempt_num_;
+        steal_success_num_ += stats.steal_success_num_;
+        for (CInt i = 0; i < CGRAPH_STEAL_DISTANCE_SIZE; i++) {
+            steal_distance_num_[i] += stats.steal_distance_num_[i];
+        }
+        batch_num_ += stats.batch_num_;
+        park_num_ += stats.park_num_;
+        wakeup_num_ += stats.wakeup_num_;
+        parked_ns_ += stats.parked_ns_;
+        alive_ns_ += stats.alive_ns_;
+        queue_size_ += stats.queue_size_;
+        return *this;
+    }
+};
+
+
+/** 线程池的统计信息快照，通过 UThreadPool::getStats() 获取 */
+struct UThreadPoolStats : public CStruct {
+    std::vector<UThreadStats> primary_stats_;                          // 开启过的 primary 线程，包含已经被回收的线程
+    std::vector<UThreadStats> secondary_stats_;                        // 当前的 secondary 线程
+    UThreadStats exited_stats_;                                        // 已经释放的 secondary 线程的累计信息
+    CSize pool_queue_size_ = 0;                                        // pool 通用队列中，待执行任务的大致个数
+    CSize priority_queue_size_ = 0;                                    // pool 优先级队列中，待执行任务的大致个数
+    CULong secondary_create_num_ = 0;                                  // 创建 secondary 线程的总个数
+    CULong secondary_exit_num_ = 0;                                    // 释放 secondary 线程的总个数
+    std::vector<UTaskLatency> latency_stats_;                          // 按照任务分类标签汇总的耗时信息（含已释放的线程），下标为标签。仅开启耗时统计的时候记录
+
+    /**
+     * 汇总所有线程（含已释放的线程）的统计信息
+     * @return
+     */
+    UThreadStats calcTotal() const {
+        UThreadStats total = exited_stats_;
+        for (const auto& stats : primary_stats_) {
+            total.merge(stats);
+        }
+        for (const auto& stats : secondary_stats_) {
+            total.merge(stats);
+        }
+        return total;
+    }
+};
+
+CGRAPH_NAMESPACE_END
+
+#endif //CGRAPH_UTHREADPOOLSTATS_H
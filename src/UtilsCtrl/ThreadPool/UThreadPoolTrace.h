@@ -0,0 +1,470 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: UThreadPoolTrace.h
+@Time: 2026/10/18 01:20
+@Desc: 线程池调度事件的记录，导出为 chrome trace 格式，可以在 chrome://tracing 或 perfetto 中查看
+***************************/
+
+#ifndef CGRAPH_UTHREADPOOLTRACE_H
+#define CGRAPH_UTHREADPOOLTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+    #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+    #endif
+
+#include "UThreadObject.h"
+#include "UThreadPoolDefine.h"
+
+CGRAPH_NAMESPACE_BEGIN
+
+/** 调度事件的类型 */
+enum class UTraceEvent {
+    ENQUEUE = 0,              // 写入任务。arg 为写入的 primary 线程 index，或 CGRAPH_POOL_TASK_STRATEGY / CGRAPH_LONG_TIME_TASK_STRATEGY
+    DEQUEUE = 1,              // 获取任务。arg 为任务所在的 primary 线程 index，或 CGRAPH_POOL_TASK_STRATEGY
+    STEAL = 2,                // 盗取任务。arg 为被盗取的 primary 线程 index
+    RUN_BEGIN = 3,            // 开始执行任务
+    RUN_END = 4,              // 任务执行结束
+    PARK = 5,                 // 开始休眠
+    UNPARK = 6,               // 休眠结束。arg 为1表示被唤醒，为0表示超时
+    THREAD_START = 7,         // 线程开启。arg 为线程 index，辅助线程为 CGRAPH_SECONDARY_THREAD_COMMON_ID
+    THREAD_EXIT = 8,          // 线程退出
+    SCALE_UP = 9,             // 监控线程（或调用方）增加辅助线程。arg 为增加的个数
+    SCALE_DOWN = 10,          // 监控线程（或调用方）减少辅助线程。arg 为减少的个数
+    RESIZE_PRIMARY = 11,      // 调整主线程个数。arg 为调整之后的个数
+};
+
+/**
+ * 单个线程中，记录调度事件的环形缓冲区。仅由所属的线程写入，导出的时候，由其他线程读取
+ * 写满之后覆盖最早的事件。读取的时候，通过 begin_ 判断哪些事件在读取的过程中被覆盖，并丢弃
+ */
+class UTraceBuffer : public CStruct {
+public:
+    /** 导出时使用的事件信息 */
+    struct Record {
+        std::uint64_t ticks_ = 0;
+        UTraceEvent event_ = UTraceEvent::ENQUEUE;
+        CInt arg_ = 0;
+        CUInt count_ = 0;
+    };
+
+    explicit UTraceBuffer(CInt id)
+        : slots_(new Slot[CGRAPH_TRACE_BUFFER_SIZE]) {
+        id_ = id;
+        name_ = "thread-" + std::to_string(id);
+    }
+
+    /**
+     * 记录一个事件。仅允许所属的线程调用
+     * @param ticks
+     * @param event
+     * @param arg
+     * @param count
+     */
+    CVoid push(std::uint64_t ticks, UTraceEvent event, CInt arg, CUInt count) {
+        const std::uint64_t cur = tail_.load(std::memory_order_relaxed);
+        begin_.store(cur + 1, std::memory_order_relaxed);    // 先标记 cur 对应的位置（即 cur - SIZE 的事件）即将被覆盖
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Slot& slot = slots_[cur & (CGRAPH_TRACE_BUFFER_SIZE - 1)];
+        slot.ticks_.store(ticks, std::memory_order_relaxed);
+        slot.info_.store(((std::uint64_t)(CUInt)event << 56)
+                         | ((std::uint64_t)(count & 0xFFFFFF) << 32)
+                         | (std::uint64_t)(std::uint32_t)arg, std::memory_order_relaxed);
+        tail_.store(cur + 1, std::memory_order_release);
+    }
+
+    /**
+     * 读取当前缓冲区中的事件，按照写入的顺序排列。可以在其他线程中调用
+     * @param fromTicks 仅保留不早于此时间的事件
+     * @return
+     */
+    std::vector<Record> snapshot(std::uint64_t fromTicks) const {
+        const std::uint64_t tail = tail_.load(std::memory_order_acquire);
+        std::uint64_t head = tail > CGRAPH_TRACE_BUFFER_SIZE ? tail - CGRAPH_TRACE_BUFFER_SIZE : 0;
+        std::vector<Record> records;
+        records.reserve((CSize)(tail - head));
+        for (std::uint64_t i = head; i < tail; i++) {
+            const Slot& slot = slots_[i & (CGRAPH_TRACE_BUFFER_SIZE - 1)];
+            Record record;
+            record.ticks_ = slot.ticks_.load(std::memory_order_relaxed);
+            const std::uint64_t info = slot.info_.load(std::memory_order_relaxed);
+            record.event_ = (UTraceEvent)(CInt)(info >> 56);
+            record.count_ = (CUInt)((info >> 32) & 0xFFFFFF);
+            record.arg_ = (CInt)(std::int32_t)(std::uint32_t)info;
+            records.emplace_back(record);
+        }
+
+        // 读取的过程中被覆盖的事件，内容不可信，直接丢弃
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t begin = begin_.load(std::memory_order_relaxed);
+        if (begin > CGRAPH_TRACE_BUFFER_SIZE && begin - CGRAPH_TRACE_BUFFER_SIZE > head) {
+            const CSize dropSize = (CSize)(std::min)(begin - CGRAPH_TRACE_BUFFER_SIZE - head, (std::uint64_t)records.size());
+            records.erase(records.begin(), records.begin() + dropSize);
+        }
+
+        CSize skipSize = 0;
+        while (skipSize < records.size() && records[skipSize].ticks_ < fromTicks) {
+            skipSize++;
+        }
+        records.erase(records.begin(), records.begin() + skipSize);
+        return records;
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(UTraceBuffer)
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> ticks_ {0};
+        std::atomic<std::uint64_t> info_ {0};                          // 高8位为事件类型，之后24位为个数，低32位为参数
+    };
+
+    std::unique_ptr<Slot[]> slots_;                                    // 环形缓冲区
+    std::atomic<std::uint64_t> tail_ {0};                              // 已经写入完成的事件个数
+    std::atomic<std::uint64_t> begin_ {0};                             // 已经开始写入的事件个数
+    std::atomic<CBool> active_ {true};                                 // 所属的线程是否还在运行
+    CInt id_ = 0;                                                      // 导出时对应的 tid
+    std::string name_;                                                 // 导出时的线程名称，在 UTraceRecorder 的 mutex_ 中读写
+
+    friend class UTraceRecorder;
+};
+
+
+/**
+ * 是否正在记录调度事件。放在模板的静态成员中，可以在头文件中定义，并且所有编译单元共用一份
+ * 记录事件之前先检查此标记，未开启的时候，不需要获取 UTraceRecorder 的实例
+ */
+template<typename T = CVoid>
+struct UTraceSwitch {
+    static std::atomic<CBool> enable_;
+};
+
+template<typename T>
+std::atomic<CBool> UTraceSwitch<T>::enable_ {false};
+
+
+/**
+ * 调度事件的记录器，进程中唯一
+ * 编译时开启 _CGRAPH_TRACE_ENABLE_，并且调用 start() 之后，才开始记录。未开启的时候，线程池中记录事件的代码不参与编译
+ * 每个线程第一次记录事件的时候，申请自己的环形缓冲区，之后记录事件不加锁
+ */
+class UTraceRecorder : public UThreadObject {
+public:
+    static UTraceRecorder& get() {
+        static UTraceRecorder recorder;
+        return recorder;
+    }
+
+    /**
+     * 开始记录。导出的时候，仅包含最近一次 start() 之后的事件
+     */
+    CVoid start() {
+        CGRAPH_LOCK_GUARD lock(mutex_);
+        base_ticks_ = currentTicks();
+        base_ns_ = currentNs();
+        UTraceSwitch<>::enable_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * 停止记录，已经记录的事件仍然可以导出
+     */
+    CVoid stop() {
+        UTraceSwitch<>::enable_.store(false, std::memory_order_release);
+    }
+
+    /**
+     * 判断是否正在记录
+     * @return
+     */
+    static CBool isEnable() {
+        return UTraceSwitch<>::enable_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 记录当前线程的一个事件
+     * @param event
+     * @param arg
+     * @param count
+     */
+    CVoid record(UTraceEvent event, CInt arg, CUInt count) {
+        if (likely(!isEnable())) {
+            return;
+        }
+
+        localBuffer()->push(currentTicks(), event, arg, count);
+    }
+
+    /**
+     * 设置当前线程在导出结果中的名称。还没有申请缓冲区的时候，先记录下来，申请的时候再设置
+     * @param name
+     */
+    CVoid setThreadName(const std::string& name) {
+        BufferHolder& holder = localHolder();
+        CGRAPH_LOCK_GUARD lock(mutex_);
+        holder.name_ = name;
+        if (holder.buffer_) {
+            holder.buffer_->name_ = name;
+        }
+    }
+
+    /**
+     * 将记录的事件，导出为 chrome trace 格式的 json 字符串
+     * @return
+     */
+    std::string dumpJson() {
+        std::vector<std::shared_ptr<UTraceBuffer>> buffers;
+        std::vector<std::string> names;
+        std::uint64_t baseTicks = 0;
+        std::int64_t baseNs = 0;
+        {
+            CGRAPH_LOCK_GUARD lock(mutex_);
+            buffers = buffers_;
+            for (const auto& buffer : buffers) {
+                names.emplace_back(buffer->name_);
+            }
+            baseTicks = base_ticks_;
+            baseNs = base_ns_;
+        }
+
+        // 按照开始记录到现在的时长，换算 ticks 和 ns 的比例。不支持读取 ticks 的平台上，ticks 即为 ns
+        const std::uint64_t nowTicks = currentTicks();
+        const std::int64_t nowNs = currentNs();
+        const CDouble nsPerTick = (nowTicks > baseTicks && nowNs > baseNs)
+                                  ? (CDouble)(nowNs - baseNs) / (CDouble)(nowTicks - baseTicks) : 1.0;
+
+        std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        json += R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"CThreadPool"}})";
+        char buf[256] = {0};
+        for (CSize i = 0; i < buffers.size(); i++) {
+            const CInt tid = buffers[i]->id_;
+            json += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid)
+                    + ",\"args\":{\"name\":\"" + escapeJson(names[i]) + "\"}}";
+
+            CInt runDepth = 0;
+            CInt parkDepth = 0;
+            for (const auto& record : buffers[i]->snapshot(baseTicks)) {
+                const CDouble ts = (CDouble)(std::int64_t)(record.ticks_ - baseTicks) * nsPerTick / 1000.0;
+                switch (record.event_) {
+                    case UTraceEvent::RUN_BEGIN:
+                        runDepth++;
+                        snprintf(buf, sizeof(buf), R"({"name":"run","ph":"B","pid":1,"tid":%d,"ts":%.3f})", tid, ts);
+                        break;
+                    case UTraceEvent::RUN_END:
+                        // 缓冲区被覆盖之后，开头可能有不成对的结束事件，直接跳过
+                        if (runDepth <= 0) { continue; }
+                        runDepth--;
+                        snprintf(buf, sizeof(buf), R"({"name":"run","ph":"E","pid":1,"tid":%d,"ts":%.3f})", tid, ts);
+                        break;
+                    case UTraceEvent::PARK:
+                        parkDepth++;
+                        snprintf(buf, sizeof(buf), R"({"name":"park","ph":"B","pid":1,"tid":%d,"ts":%.3f})", tid, ts);
+                        break;
+                    case UTraceEvent::UNPARK:
+                        if (parkDepth <= 0) { continue; }
+                        parkDepth--;
+                        snprintf(buf, sizeof(buf), R"({"name":"park","ph":"E","pid":1,"tid":%d,"ts":%.3f,"args":{"notified":%d}})",
+                                 tid, ts, record.arg_);
+                        break;
+                    default:
+                        snprintf(buf, sizeof(buf), R"({"name":"%s","ph":"i","s":"%s","pid":1,"tid":%d,"ts":%.3f,"args":{"%s":%d,"count":%u}})",
+                                 eventName(record.event_), isPoolEvent(record.event_) ? "p" : "t", tid, ts,
+                                 argName(record.event_), record.arg_, record.count_);
+                        break;
+                }
+                json += ",\n";
+                json += buf;
+            }
+        }
+        json += "\n]}\n";
+        return json;
+    }
+
+    /**
+     * 将记录的事件，写入文件中
+     * @param path
+     * @return
+     */
+    CStatus dump(const std::string& path) {
+        CGRAPH_FUNCTION_BEGIN
+        std::ofstream file(path, std::ios::out | std::ios::trunc);
+        CGRAPH_RETURN_ERROR_STATUS_BY_CONDITION(!file.is_open(), "open trace file [" + path + "] failed")
+
+        file << dumpJson();
+        CGRAPH_RETURN_ERROR_STATUS_BY_CONDITION(!file.good(), "write trace file [" + path + "] failed")
+        CGRAPH_FUNCTION_END
+    }
+
+    CGRAPH_NO_ALLOWED_COPY(UTraceRecorder)
+
+protected:
+    UTraceRecorder() = default;
+
+    /**
+     * 获取当前的时间戳。x86 平台上直接读取 tsc，开销低于 steady_clock
+     * @return
+     */
+    static std::uint64_t currentTicks() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        return __builtin_ia32_rdtsc();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#else
+        return (std::uint64_t)currentNs();
+#endif
+    }
+
+    static std::int64_t currentNs() {
+        return (std::int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** 线程中缓冲区的持有者。线程退出的时候，标记缓冲区不再写入，仍然保留其中的事件 */
+    struct BufferHolder {
+        std::shared_ptr<UTraceBuffer> buffer_;
+        std::string name_;
+
+        ~BufferHolder() {
+            if (buffer_) {
+                buffer_->active_.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    static BufferHolder& localHolder() {
+        static thread_local BufferHolder holder;
+        return holder;
+    }
+
+    /**
+     * 获取当前线程的缓冲区，第一次调用的时候注册
+     * @return
+     */
+    UTraceBuffer* localBuffer() {
+        BufferHolder& holder = localHolder();
+        if (likely(holder.buffer_)) {
+            return holder.buffer_.get();
+        }
+
+        CGRAPH_LOCK_GUARD lock(mutex_);
+        holder.buffer_ = std::make_shared<UTraceBuffer>(++buffer_id_);
+        if (!holder.name_.empty()) {
+            holder.buffer_->name_ = holder.name_;
+        }
+        if (buffers_.size() >= CGRAPH_TRACE_MAX_BUFFER_SIZE) {
+            // 缓冲区过多的时候（如辅助线程频繁创建和释放），丢弃最早退出的线程的缓冲区
+            for (auto iter = buffers_.begin(); iter != buffers_.end(); iter++) {
+                if (!(*iter)->active_.load(std::memory_order_acquire)) {
+                    buffers_.erase(iter);
+                    break;
+                }
+            }
+        }
+        buffers_.emplace_back(holder.buffer_);
+        return holder.buffer_.get();
+    }
+
+    /**
+     * 转义 json 字符串中的特殊字符。线程名称由外部设置，可能包含引号、反斜杠或控制字符
+     * @param str
+     * @return
+     */
+    static std::string escapeJson(const std::string& str) {
+        std::string result;
+        result.reserve(str.size());
+        for (char ch : str) {
+            switch (ch) {
+                case '"': result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\b': result += "\\b"; break;
+                case '\f': result += "\\f"; break;
+                case '\n': result += "\\n"; break;
+                case '\r': result += "\\r"; break;
+                case '\t': result += "\\t"; break;
+                default:
+                    if ((unsigned char)ch < 0x20) {
+                        char buf[8] = {0};
+                        snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)ch);
+                        result += buf;
+                    } else {
+                        result += ch;
+                    }
+                    break;
+            }
+        }
+        return result;
+    }
+
+    static const char* eventName(UTraceEvent event) {
+        switch (event) {
+            case UTraceEvent::ENQUEUE: return "enqueue";
+            case UTraceEvent::DEQUEUE: return "dequeue";
+            case UTraceEvent::STEAL: return "steal";
+            case UTraceEvent::THREAD_START: return "thread start";
+            case UTraceEvent::THREAD_EXIT: return "thread exit";
+            case UTraceEvent::SCALE_UP: return "scale up";
+            case UTraceEvent::SCALE_DOWN: return "scale down";
+            case UTraceEvent::RESIZE_PRIMARY: return "resize primary";
+            default: return "unknown";
+        }
+    }
+
+    static const char* argName(UTraceEvent event) {
+        switch (event) {
+            case UTraceEvent::ENQUEUE: return "target";
+            case UTraceEvent::DEQUEUE: return "source";
+            case UTraceEvent::STEAL: return "victim";
+            case UTraceEvent::THREAD_START:
+            case UTraceEvent::THREAD_EXIT: return "index";
+            default: return "size";
+        }
+    }
+
+    /**
+     * 监控的决策，影响整个线程池，导出为进程级别的事件
+     * @param event
+     * @return
+     */
+    static CBool isPoolEvent(UTraceEvent event) {
+        return UTraceEvent::SCALE_UP == event || UTraceEvent::SCALE_DOWN == event
+               || UTraceEvent::RESIZE_PRIMARY == event;
+    }
+
+private:
+    std::uint64_t base_ticks_ = 0;                                     // 开始记录时的 ticks，用于换算时间
+    std::int64_t base_ns_ = 0;                                         // 开始记录时的 ns
+    CInt buffer_id_ = 0;                                               // 已经注册的缓冲区个数，作为缓冲区的 id
+    std::vector<std::shared_ptr<UTraceBuffer>> buffers_;               // 所有线程的缓冲区
+    std::mutex mutex_;                                                 // 注册缓冲区、设置名称和导出的时候加锁
+};
+
+
+/**
+ * 开启 _CGRAPH_TRACE_ENABLE_ 的时候，记录调度事件；否则，不生成任何代码
+ * 未调用 start() 的时候，仅读取一次全局的标记
+ */
+#ifdef _CGRAPH_TRACE_ENABLE_
+    #define CGRAPH_TRACE(event, arg, count)                                                  \
+        if (unlikely(UTraceRecorder::isEnable())) {                                          \
+            UTraceRecorder::get().record(UTraceEvent::event, (CInt)(arg), (CUInt)(count));   \
+        }                                                                                    \
+
+    #define CGRAPH_TRACE_THREAD_NAME(name)                                                   \
+        UTraceRecorder::get().setThreadName(name);                                           \
+
+#else
+    #define CGRAPH_TRACE(event, arg, count)
+    #define CGRAPH_TRACE_THREAD_NAME(name)
+#endif
+
+CGRAPH_NAMESPACE_END
+
+#endif //CGRAPH_UTHREADPOOLTRACE_H
@@ -32,6 +32,15 @@ CGRAPH_NAMESPACE_BEGIN
     #define unlikely
 #endif
 
+/** 不常用的分支，单独放在不内联的函数中，避免影响常用路径的内联 */
+#if defined(__GNUC__) || defined(__clang__)
+    #define CGRAPH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+    #define CGRAPH_NOINLINE __declspec(noinline)
+#else
+    #define CGRAPH_NOINLINE
+#endif
+
 using CGRAPH_LOCK_GUARD = std::lock_guard<std::mutex>;
 using CGRAPH_UNIQUE_LOCK = std::unique_lock<std::mutex>;
 
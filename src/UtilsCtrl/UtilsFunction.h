@@ -17,6 +17,10 @@
 #include <algorithm>
 #include <thread>
 #include <chrono>
+#include <functional>
+    #if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+    #endif
 
 #include "../CBasic/CBasicInclude.h"
 
@@ -128,6 +132,51 @@ inline CVoid CGRAPH_YIELD() {
 #endif
 }
 
+
+/**
+ * 快速生成随机数（xorshift），每个线程独立计算，无需加锁
+ * 适用于任务分发、盗取等对随机质量要求不高的场景
+ * @return
+ */
+inline CUInt CGRAPH_FAST_RANDOM() {
+    static thread_local CUInt seed = (CUInt)std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+
+/**
+ * cpu 级别的短暂停顿，不让出时间片。用于自旋等待，降低自旋时的功耗和对超线程的影响
+ * @return
+ */
+inline CVoid CGRAPH_PAUSE() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+
+/**
+ * 预取内存到缓存中，仅作为提示，不影响执行结果。不支持的平台上，不做任何处理
+ * @param addr
+ * @return
+ */
+inline CVoid CGRAPH_PREFETCH(const CVoid* addr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr, 0, 3);
+#elif defined(_M_X64) || defined(_M_IX86)
+    _mm_prefetch((const char*)addr, _MM_HINT_T0);
+#else
+    (void)addr;
+#endif
+}
+
 CGRAPH_NAMESPACE_END
 
 #endif //CGRAPH_UTILSFUNCTION_H
@@ -0,0 +1,79 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-cpu-quota.cpp
+@Time: 2026/10/18 19:40
+@Desc: cgroup 配额的解析。读取 _Materials/CpuQuota 中构造的目录，覆盖 v2 多级配额、v1 配额、容器中路径不存在和没有配额限制的情况
+ * 每个目录中，cgroup 文件对应 /proc/self/cgroup，root 目录对应 /sys/fs/cgroup
+***************************/
+
+#include <string>
+
+#include "../_Materials/TestInclude.h"
+
+
+/**
+ * 获取构造的 cgroup 目录，按照当前源文件的位置查找，和执行时所在的目录无关
+ * @param name
+ * @return
+ */
+std::string getFixtureDir(const std::string& name) {
+    const std::string file = __FILE__;
+    return file.substr(0, file.find_last_of("/\\")) + "/../_Materials/CpuQuota/" + name;
+}
+
+
+/**
+ * 读取构造的目录中的配额
+ * @param name
+ * @return
+ */
+CInt calcFixtureQuota(const std::string& name) {
+    const std::string dir = getFixtureDir(name);
+    return UCpuQuota::calcQuotaSize(dir + "/cgroup", dir + "/root");
+}
+
+
+/**
+ * cgroup v2：各级 cpu.max 中取最小的配额，并向上取整。1.5 个cpu的配额，对应 2 个cpu
+ */
+CVoid test_functional_cpu_quota_v2_nested() {
+    CGRAPH_TEST_CHECK(2 == calcFixtureQuota("v2-nested"))
+}
+
+
+/**
+ * cgroup v2：容器中 cgroup 路径在挂载点下不存在（cgroup namespace）的时候，仅读取挂载点中的配额
+ */
+CVoid test_functional_cpu_quota_v2_namespace() {
+    CGRAPH_TEST_CHECK(2 == calcFixtureQuota("v2-namespace"))
+}
+
+
+/**
+ * cgroup v1：读取 cpu,cpuacct 下的 cpu.cfs_quota_us 和 cpu.cfs_period_us，-1 表示不限制，其余 controller 不影响结果
+ */
+CVoid test_functional_cpu_quota_v1() {
+    CGRAPH_TEST_CHECK(3 == calcFixtureQuota("v1"))
+}
+
+
+/**
+ * cpu.max 中为 max，或者目录不存在的时候，表示没有配额限制
+ */
+CVoid test_functional_cpu_quota_unlimited() {
+    CGRAPH_TEST_CHECK(0 == calcFixtureQuota("v2-max"))
+    CGRAPH_TEST_CHECK(0 == calcFixtureQuota("not-exist"))
+    CGRAPH_TEST_CHECK(UCpuQuota::calcCpuLimit() >= 1)
+}
+
+
+int main() {
+    test_functional_cpu_quota_v2_nested();
+    test_functional_cpu_quota_v2_namespace();
+    test_functional_cpu_quota_v1();
+    test_functional_cpu_quota_unlimited();
+
+    printf("[test] test-functional-cpu-quota finished\n");
+    return 0;
+}
@@ -0,0 +1,197 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-dispatch.cpp
+@Time: 2026/10/18 18:50
+@Desc: 任务的分发
+ * 1. 随机选择的两个主线程中，待执行任务都超过 dispatch_queue_threshold_ 的时候，写入通用队列
+ * 2. 批量写入的任务，在主线程和通用队列之间均分，每个任务恰好执行一次，多个线程同时写入的时候，均分的起始位置依次后移
+***************************/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "../_Materials/TestInclude.h"
+
+static const CInt TEST_THREAD_SIZE = 4;
+static const CInt TEST_MAX_THREAD_SIZE = 6;                   // 批量写入的时候，超出主线程个数的部分，写入通用队列
+static const CInt TEST_SUBMIT_THREAD_SIZE = 3;
+static const CInt TEST_BULK_TIMES = 20;                      // 每个线程批量写入的次数
+static const CMSec TEST_WAIT_TTL = 10000;
+
+
+/**
+ * 阻塞所有的主线程。返回之后，所有的主线程都在执行阻塞任务
+ * 通过加锁、解锁的方式写入，不加锁的写入会和线程自身的获取产生竞争
+ * @param pool
+ * @param release 设置为 true 之后，放开阻塞
+ */
+CVoid blockPrimaryThreads(UThreadPool& pool, std::atomic<CBool>& release) {
+    std::atomic<CInt> blocked {0};
+    for (CInt tid = 0; tid < TEST_THREAD_SIZE; tid++) {
+        pool.executeWithTid([] {}, tid, true, true);
+        pool.executeWithTid([&release, &blocked] {
+            blocked++;
+            while (!release) {
+                std::this_thread::yield();
+            }
+        }, tid, true, false);
+    }
+    CGRAPH_TEST_CHECK(waitUntil([&blocked] { return TEST_THREAD_SIZE == blocked; }, TEST_WAIT_TTL))
+}
+
+
+/**
+ * 主线程都在阻塞的时候，持续写入任务。每个主线程中的任务不超过阈值 + 1，其余的任务写入通用队列
+ * @param threshold
+ */
+CVoid test_functional_dispatch_threshold(CInt threshold) {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = TEST_THREAD_SIZE;
+    config.secondary_thread_size_ = 0;
+    config.max_thread_size_ = TEST_THREAD_SIZE;
+    config.monitor_enable_ = false;
+    config.dispatch_queue_threshold_ = threshold;
+    UThreadPool pool(true, config);
+
+    std::atomic<CBool> release {false};
+    blockPrimaryThreads(pool, release);
+
+    const CSize extraSize = 100;
+    const CSize taskSize = TEST_THREAD_SIZE * (threshold + 1) + extraSize;
+    std::atomic<CSize> done {0};
+    for (CSize i = 0; i < taskSize; i++) {
+        pool.execute([&done] { done++; });
+    }
+
+    UThreadPoolStats stats = pool.getStats();
+    CGRAPH_TEST_CHECK(TEST_THREAD_SIZE == stats.primary_stats_.size())
+    CSize primaryTaskSize = 0;
+    for (const auto& cur : stats.primary_stats_) {
+        CGRAPH_TEST_CHECK(cur.queue_size_ <= (CSize)threshold + 1)
+        primaryTaskSize += cur.queue_size_;
+    }
+    CGRAPH_TEST_CHECK(stats.pool_queue_size_ >= extraSize)
+    CGRAPH_TEST_CHECK(primaryTaskSize + stats.pool_queue_size_ == taskSize)
+
+    release = true;
+    CGRAPH_TEST_CHECK(waitUntil([&done, taskSize] { return taskSize == done; }, TEST_WAIT_TTL))
+}
+
+
+/**
+ * 多个线程同时通过 executeBulk 和 commitBulk 写入不同大小的批量任务，每个任务恰好执行一次
+ */
+CVoid test_functional_dispatch_bulk_once() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = TEST_THREAD_SIZE;
+    config.secondary_thread_size_ = 0;
+    config.max_thread_size_ = TEST_MAX_THREAD_SIZE;
+    config.monitor_enable_ = false;
+    UThreadPool pool(true, config);
+
+    const CSize bulkSize = 13;                                  // 每轮写入 1 ~ bulkSize 个任务
+    const CSize roundSize = bulkSize * (bulkSize + 1) / 2;
+    const CSize threadSize = roundSize * TEST_BULK_TIMES * 2;  // 每个线程中 executeBulk 和 commitBulk 各一半
+    const CSize total = threadSize * TEST_SUBMIT_THREAD_SIZE;
+    std::unique_ptr<std::atomic<CUInt>[]> counts(new std::atomic<CUInt>[total]);
+    for (CSize i = 0; i < total; i++) {
+        counts[i] = 0;
+    }
+
+    std::vector<std::thread> submitters;
+    for (CInt i = 0; i < TEST_SUBMIT_THREAD_SIZE; i++) {
+        submitters.emplace_back([&pool, &counts, threadSize, bulkSize, i] {
+            CSize id = threadSize * i;
+            for (CInt round = 0; round < TEST_BULK_TIMES; round++) {
+                for (CSize size = 1; size <= bulkSize; size++) {
+                    std::vector<std::function<CVoid()>> tasks;
+                    for (CSize j = 0; j < size; j++, id++) {
+                        tasks.emplace_back([&counts, id] { counts[id]++; });
+                    }
+                    pool.executeBulk(tasks.begin(), tasks.end());
+
+                    std::vector<std::function<CSize()>> funcs;
+                    for (CSize j = 0; j < size; j++, id++) {
+                        funcs.emplace_back([&counts, id] { counts[id]++; return id; });
+                    }
+                    CSize first = id - size;
+                    auto futures = pool.commitBulk(funcs.begin(), funcs.end());
+                    CGRAPH_TEST_CHECK(size == futures.size())
+                    for (CSize j = 0; j < size; j++) {
+                        CGRAPH_TEST_CHECK(first + j == futures[j].get())
+                    }
+                }
+            }
+        });
+    }
+    for (auto& cur : submitters) {
+        cur.join();
+    }
+
+    for (CSize i = 0; i < total; i++) {
+        CGRAPH_TEST_CHECK(waitUntil([&counts, i] { return 0 != counts[i].load(); }, TEST_WAIT_TTL))
+        CGRAPH_TEST_CHECK(1 == counts[i].load())
+    }
+}
+
+
+/**
+ * 主线程都在阻塞的时候，多个线程同时写入 (TEST_MAX_THREAD_SIZE + 1) 个任务的批量任务
+ * 每次多出的一个任务，按照共享的起始位置依次写入，所以每个主线程和通用队列中的任务个数，都是可以确定的
+ */
+CVoid test_functional_dispatch_bulk_cursor() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = TEST_THREAD_SIZE;
+    config.secondary_thread_size_ = 0;
+    config.max_thread_size_ = TEST_MAX_THREAD_SIZE;
+    config.monitor_enable_ = false;
+    config.elastic_enable_ = false;
+    config.secondary_reserve_size_ = 0;    // 不创建辅助线程，通用队列中的任务保留到放开阻塞之后
+    UThreadPool pool(true, config);
+
+    std::atomic<CBool> release {false};
+    blockPrimaryThreads(pool, release);
+
+    std::atomic<CSize> done {0};
+    std::vector<std::thread> submitters;
+    for (CInt i = 0; i < TEST_SUBMIT_THREAD_SIZE; i++) {
+        submitters.emplace_back([&pool, &done] {
+            for (CInt round = 0; round < TEST_BULK_TIMES; round++) {
+                std::vector<std::function<CVoid()>> tasks(TEST_MAX_THREAD_SIZE + 1, [&done] { done++; });
+                pool.executeBulk(tasks.begin(), tasks.end());
+            }
+        });
+    }
+    for (auto& cur : submitters) {
+        cur.join();
+    }
+
+    // 总共多出的任务个数为 TEST_SUBMIT_THREAD_SIZE * TEST_BULK_TIMES，可以被 TEST_MAX_THREAD_SIZE 整除
+    const CSize bulkTimes = TEST_SUBMIT_THREAD_SIZE * TEST_BULK_TIMES;
+    const CSize slotTaskSize = bulkTimes + bulkTimes / TEST_MAX_THREAD_SIZE;
+    UThreadPoolStats stats = pool.getStats();
+    CGRAPH_TEST_CHECK(TEST_THREAD_SIZE == stats.primary_stats_.size())
+    for (const auto& cur : stats.primary_stats_) {
+        CGRAPH_TEST_CHECK(slotTaskSize == cur.queue_size_)
+    }
+    CGRAPH_TEST_CHECK(slotTaskSize * (TEST_MAX_THREAD_SIZE - TEST_THREAD_SIZE) == stats.pool_queue_size_)
+
+    release = true;
+    const CSize total = bulkTimes * (TEST_MAX_THREAD_SIZE + 1);
+    CGRAPH_TEST_CHECK(waitUntil([&done, total] { return total == done; }, TEST_WAIT_TTL))
+}
+
+
+int main() {
+    test_functional_dispatch_threshold(0);
+    test_functional_dispatch_threshold(CGRAPH_DISPATCH_QUEUE_THRESHOLD);
+    test_functional_dispatch_bulk_once();
+    test_functional_dispatch_bulk_cursor();
+
+    printf("[test] test-functional-dispatch finished\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-future.cpp
+@Time: 2026/10/18 14:10
+@Desc: commit 系列接口返回 std::future，commitFast 系列接口返回 UFuture。确认结果、异常、等待和线程退出时的状态回收
+***************************/
+
+#include <atomic>
+#include <thread>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+
+#include "../_Materials/TestInclude.h"
+
+static std::atomic<CInt> g_exit_result {0};
+
+
+/**
+ * commit 系列接口的返回值类型，和之前保持一致
+ */
+CVoid test_functional_future_type() {
+    UThreadPool pool;
+    auto func = [] { return 1; };
+    std::vector<std::function<CInt()>> funcs(4, func);
+    static_assert(std::is_same<decltype(pool.commit(func)), std::future<CInt>>::value, "commit");
+    static_assert(std::is_same<decltype(pool.commitWithTid(func, 0, false, false)), std::future<CInt>>::value, "commitWithTid");
+    static_assert(std::is_same<decltype(pool.commitWithPriority(func, 0)), std::future<CInt>>::value, "commitWithPriority");
+    static_assert(std::is_same<decltype(pool.commitWithLane(func, UTaskLane::HIGH)), std::future<CInt>>::value, "commitWithLane");
+    static_assert(std::is_same<decltype(pool.commitWithTag(func, 0)), std::future<CInt>>::value, "commitWithTag");
+    static_assert(std::is_same<decltype(pool.commitBulk(funcs.begin(), funcs.end())), std::vector<std::future<CInt>>>::value, "commitBulk");
+    static_assert(std::is_same<decltype(pool.commitFast(func)), UFuture<CInt>>::value, "commitFast");
+    static_assert(std::is_same<decltype(pool.commitFastWithTid(func, 0, false, false)), UFuture<CInt>>::value, "commitFastWithTid");
+    static_assert(std::is_same<decltype(pool.commitFastWithPriority(func, 0)), UFuture<CInt>>::value, "commitFastWithPriority");
+    static_assert(std::is_same<decltype(pool.commitFastWithLane(func, UTaskLane::HIGH)), UFuture<CInt>>::value, "commitFastWithLane");
+    static_assert(std::is_same<decltype(pool.commitFastWithTag(func, 0)), UFuture<CInt>>::value, "commitFastWithTag");
+    static_assert(std::is_same<decltype(pool.commitFastBulk(funcs.begin(), funcs.end())), std::vector<UFuture<CInt>>>::value, "commitFastBulk");
+
+    std::shared_future<CInt> shared = pool.commit(func).share();
+    CGRAPH_TEST_CHECK(1 == shared.get() && 1 == shared.get())
+    CInt sum = 0;
+    for (auto& future : pool.commitBulk(funcs.begin(), funcs.end())) {
+        sum += future.get();
+    }
+    CGRAPH_TEST_CHECK(4 == sum)
+}
+
+
+/**
+ * commitFast 的结果、引用、异常和等待
+ */
+CVoid test_functional_future_fast() {
+    UThreadPool pool;
+    CGRAPH_TEST_CHECK(3 == pool.commitFast([] { return 3; }).get())
+    CGRAPH_TEST_CHECK("ctp" == pool.commitFast([] { return std::string("ctp"); }).get())
+
+    CInt value = 0;
+    CInt& ref = pool.commitFast([&value]() -> CInt& { return value; }).get();
+    CGRAPH_TEST_CHECK(&value == &ref)
+
+    std::atomic<CBool> done {false};
+    pool.commitFast([&done] { done = true; }).get();
+    CGRAPH_TEST_CHECK(done)
+
+    auto error = pool.commitFast([]() -> CInt { throw std::runtime_error("ctp"); });
+    CBool caught = false;
+    try {
+        error.get();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    CGRAPH_TEST_CHECK(caught && !error.valid())
+
+    std::atomic<CBool> release {false};
+    auto slow = pool.commitFast([&release] {
+        while (!release) {
+            std::this_thread::yield();
+        }
+        return 5;
+    });
+    CGRAPH_TEST_CHECK(std::future_status::timeout == slow.wait_for(std::chrono::milliseconds(10)))
+    release = true;
+    CGRAPH_TEST_CHECK(std::future_status::ready == slow.wait_for(std::chrono::seconds(10)))
+    std::future<CInt> converted = std::move(slow);
+    CGRAPH_TEST_CHECK(5 == converted.get())
+}
+
+
+/**
+ * commitFast 系列的其他提交方式，结果和对应的 commit 接口一致
+ */
+CVoid test_functional_future_fast_variant() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.max_thread_size_ = 4;
+    UThreadPool pool(true, config);
+
+    CGRAPH_TEST_CHECK(1 == pool.commitFastWithTid([] { return 1; }, 1, false, false).get())
+    CGRAPH_TEST_CHECK(2 == pool.commitFastWithTid([] { return 2; }, 100, false, false).get())
+    CGRAPH_TEST_CHECK(3 == pool.commitFastWithPriority([] { return 3; }, 1).get())
+    CGRAPH_TEST_CHECK(4 == pool.commitFastWithLane([] { return 4; }, UTaskLane::URGENT).get())
+    CGRAPH_TEST_CHECK(5 == pool.commitFastWithLane([] { return 5; }, UTaskLane::BACKGROUND).get())
+    CGRAPH_TEST_CHECK(6 == pool.commitFastWithTag([] { return 6; }, 1).get())
+
+    // 加锁和解锁之间写入的任务，在同一个线程中执行。解锁之前，任务不会被执行
+    auto locked = pool.commitFastWithTid([] { return std::this_thread::get_id(); }, 2, true, true);
+    auto unlocked = pool.commitFastWithTid([] { return std::this_thread::get_id(); }, 2, true, false);
+    CGRAPH_TEST_CHECK(locked.get() == unlocked.get())
+
+    std::vector<std::function<CSize()>> funcs;
+    for (CSize i = 0; i < 100; i++) {
+        funcs.emplace_back([i] { return i; });
+    }
+    auto futures = pool.commitFastBulk(funcs.begin(), funcs.end());
+    CGRAPH_TEST_CHECK(funcs.size() == futures.size())
+    for (CSize i = 0; i < futures.size(); i++) {
+        CGRAPH_TEST_CHECK(i == futures[i].get())
+    }
+
+    auto error = pool.commitFastWithPriority([]() -> CInt { throw std::runtime_error("ctp"); }, 1);
+    CBool caught = false;
+    try {
+        error.get();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    CGRAPH_TEST_CHECK(caught)
+}
+
+
+/**
+ * 在线程退出的过程中，析构 UFuture 并且再次提交。此时线程本地的缓存已经被释放
+ */
+struct TestExitHolder {
+    ~TestExitHolder() {
+        future_.wait();
+        future_ = UFuture<CInt>();    // 释放最后一份引用，状态不能再放回缓存中
+        g_exit_result = pool_->commitFast([] { return 2; }).get();
+    }
+
+    UThreadPoolPtr pool_ = nullptr;
+    UFuture<CInt> future_;
+};
+
+
+CVoid test_functional_future_thread_exit() {
+    UThreadPool pool;
+    std::thread thread([&pool] {
+        // holder 先于缓存构造，所以在缓存之后析构
+        static thread_local TestExitHolder holder;
+        holder.pool_ = &pool;
+        holder.future_ = pool.commitFast([] { return 1; });
+        CGRAPH_TEST_CHECK(1 == pool.commitFast([] { return 1; }).get())
+    });
+    thread.join();
+    CGRAPH_TEST_CHECK(2 == g_exit_result)
+}
+
+
+int main() {
+    test_functional_future_type();
+    test_functional_future_fast();
+    test_functional_future_fast_variant();
+    test_functional_future_thread_exit();
+
+    printf("[test] test-functional-future finished\n");
+    return 0;
+}
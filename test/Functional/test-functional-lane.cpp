@@ -0,0 +1,86 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-lane.cpp
+@Time: 2026/10/18 18:10
+@Desc: 主线程的任务通道。BACKGROUND 通道中的任务，在本线程的普通任务、可以盗取的任务和通用队列中的任务都开始执行之后，才会执行
+***************************/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../_Materials/TestInclude.h"
+
+static const CInt TEST_LANE_ROUND = 20;
+static const CInt TEST_NORMAL_SIZE = 64;                     // 写入 0号线程的普通任务个数，1号线程需要盗取
+static const CInt TEST_POOL_SIZE = 64;                       // 写入通用队列的任务个数
+static const CInt TEST_BACKGROUND_SIZE = 16;
+static const CMSec TEST_WAIT_TTL = 10000;
+
+
+/**
+ * 两个主线程都在执行阻塞的任务的时候，依次写入普通任务（仅写入0号线程）、通用队列任务和 BACKGROUND 任务
+ * 放开阻塞之后，每个 BACKGROUND 任务开始执行的时候，其他任务都已经开始执行
+ */
+CVoid test_functional_lane_background() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 2;
+    config.secondary_thread_size_ = 0;
+    config.max_thread_size_ = 2;
+    config.monitor_enable_ = false;
+    UThreadPool pool(true, config);
+
+    for (CInt round = 0; round < TEST_LANE_ROUND; round++) {
+        std::atomic<CBool> release {false};
+        std::atomic<CInt> blocked {0};
+        // 通过加锁、解锁的方式写入，不加锁的写入会和线程自身的获取以及盗取产生竞争
+        for (CInt tid = 0; tid < 2; tid++) {
+            pool.executeWithTid([] {}, tid, true, true);
+            pool.executeWithTid([&release, &blocked] {
+                blocked++;
+                while (!release) {
+                    std::this_thread::yield();
+                }
+            }, tid, true, false);
+        }
+        CGRAPH_TEST_CHECK(waitUntil([&blocked] { return 2 == blocked; }, TEST_WAIT_TTL))
+
+        std::atomic<CInt> started {0};
+        auto normalTask = [&started] {
+            started++;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        };
+        for (CInt i = 0; i < TEST_NORMAL_SIZE; i++) {
+            const CBool isFirst = (0 == i);
+            const CBool isLast = (TEST_NORMAL_SIZE - 1 == i);
+            pool.executeWithTid(normalTask, 0, isFirst || isLast, isFirst);
+        }
+        for (CInt i = 0; i < TEST_POOL_SIZE; i++) {
+            pool.execute(normalTask, CGRAPH_POOL_TASK_STRATEGY);
+        }
+
+        std::vector<std::future<CInt>> futures;
+        for (CInt i = 0; i < TEST_BACKGROUND_SIZE; i++) {
+            futures.emplace_back(pool.commitWithLane([&started] { return started.load(); }, UTaskLane::BACKGROUND));
+        }
+
+        release = true;
+        for (auto& future : futures) {
+            CInt startedSize = future.get();
+            if (TEST_NORMAL_SIZE + TEST_POOL_SIZE != startedSize) {
+                printf("[test] background task runs before [%d] tasks, in round [%d]\n",
+                       TEST_NORMAL_SIZE + TEST_POOL_SIZE - startedSize, round);
+                std::exit(1);
+            }
+        }
+    }
+}
+
+
+int main() {
+    test_functional_lane_background();
+
+    printf("[test] test-functional-lane finished\n");
+    return 0;
+}
@@ -0,0 +1,55 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-priority-queue.cpp
+@Time: 2026/10/18 15:30
+@Desc: 优先级队列默认严格按照优先级弹出，仅在设置老化时间之后，等待较久的低优先级任务才会被提前
+***************************/
+
+#include "../_Materials/TestInclude.h"
+
+
+/**
+ * 默认不开启老化
+ */
+CVoid test_functional_priority_queue_default() {
+    CGRAPH_TEST_CHECK(0 == UThreadPoolConfig().priority_aging_interval_)
+
+    UAtomicPriorityQueue<CInt> queue;
+    queue.push(1, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.push(2, 5);
+    queue.push(3, 5);
+
+    CInt value = 0;
+    CGRAPH_TEST_CHECK(queue.tryPop(value) && 2 == value)
+    CGRAPH_TEST_CHECK(queue.tryPop(value) && 3 == value)
+    CGRAPH_TEST_CHECK(queue.tryPop(value) && 1 == value)
+    CGRAPH_TEST_CHECK(queue.empty())
+}
+
+
+/**
+ * 开启老化之后，每等待 1ms 优先级视为提升1
+ */
+CVoid test_functional_priority_queue_aging() {
+    UAtomicPriorityQueue<CInt> queue;
+    queue.setAgingInterval(1);
+    queue.push(1, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.push(2, 5);
+
+    CInt value = 0;
+    CGRAPH_TEST_CHECK(queue.tryPop(value) && 1 == value)
+    CGRAPH_TEST_CHECK(queue.tryPop(value) && 2 == value)
+    CGRAPH_TEST_CHECK(!queue.tryPop(value))
+}
+
+
+int main() {
+    test_functional_priority_queue_default();
+    test_functional_priority_queue_aging();
+
+    printf("[test] test-functional-priority-queue finished\n");
+    return 0;
+}
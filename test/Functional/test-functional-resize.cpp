@@ -0,0 +1,274 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-resize.cpp
+@Time: 2026/10/18 11:20
+@Desc: 运行时调整主线程个数的同时，多个线程并发提交任务，确认任务不会丢失
+***************************/
+
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "../_Materials/TestInclude.h"
+
+static const CInt TEST_SUBMIT_THREAD_SIZE = 3;
+static const CInt TEST_SUBMIT_TIMES = 700;
+static const CInt TEST_RESIZE_TIMES = 200;
+static const CMSec TEST_WAIT_TTL = 30000;
+
+
+/**
+ * 按照不同的方式提交任务，覆盖主线程的本地队列、通道队列、pool 的通用队列和批量写入
+ * @param pool
+ * @param done
+ * @param futures
+ * @return 提交的任务个数（含任务内部再提交的任务）
+ */
+CULong submitTasks(UThreadPoolPtr pool, std::atomic<CULong>& done, std::vector<std::future<CVoid>>& futures) {
+    CULong total = 0;
+    std::vector<std::function<CVoid()>> bulk(8, [&done] { done++; });
+    for (CInt i = 0; i < TEST_SUBMIT_TIMES; i++) {
+        switch (i % 7) {
+            case 0:
+                // 在 primary 线程中再提交任务，写入执行线程的本地队列
+                pool->execute([pool, &done] {
+                    done++;
+                    pool->execute([&done] { done++; });
+                });
+                total += 2;
+                break;
+            case 1: pool->execute([&done] { done++; }, i % 8); total++; break;
+            case 2: pool->executeWithLane([&done] { done++; }, UTaskLane::HIGH); total++; break;
+            case 3: pool->executeWithLane([&done] { done++; }, UTaskLane::BACKGROUND); total++; break;
+            case 4:
+                // 按照加锁、写入、解锁的方式，向同一个线程写入一组任务
+                pool->executeWithTid([&done] { done++; }, i % 8, true, true);
+                pool->executeWithTid([&done] { done++; }, i % 8, false, false);
+                pool->executeWithTid([&done] { done++; }, i % 8, true, false);
+                total += 3;
+                break;
+            case 5: pool->executeBulk(bulk.begin(), bulk.end()); total += bulk.size(); break;
+            default: futures.emplace_back(pool->commit([&done] { done++; })); total++; break;
+        }
+    }
+    return total;
+}
+
+
+/**
+ * 并发提交任务的同时，反复减少和增加主线程个数
+ * @param config
+ */
+CVoid test_functional_resize_concurrent(const UThreadPoolConfig& config) {
+    UThreadPool pool(true, config);
+    std::atomic<CULong> done {0};
+    std::atomic<CULong> total {0};
+    std::atomic<CInt> resizeTimes {0};
+
+    std::thread resizer([&pool, &resizeTimes, &config] {
+        const CInt sizes[] = {config.max_thread_size_, 1, 3, config.max_thread_size_ - 2, 2, config.max_thread_size_, 4};
+        for (CInt i = 0; i < TEST_RESIZE_TIMES; i++) {
+            CStatus status = pool.resizePrimaryThread(sizes[i % 7]);
+            CGRAPH_TEST_CHECK(status.isOK())
+            resizeTimes++;
+            std::this_thread::yield();
+        }
+    });
+
+    // 提交任务的线程，一直提交到调整的次数足够为止
+    std::vector<std::thread> submitters;
+    std::vector<std::vector<std::future<CVoid>>> futures(TEST_SUBMIT_THREAD_SIZE);
+    for (CInt i = 0; i < TEST_SUBMIT_THREAD_SIZE; i++) {
+        submitters.emplace_back([&pool, &done, &total, &futures, &resizeTimes, i] {
+            while (resizeTimes < TEST_RESIZE_TIMES) {
+                total += submitTasks(&pool, done, futures[i]);
+            }
+        });
+    }
+    for (auto& submitter : submitters) {
+        submitter.join();
+    }
+    resizer.join();
+
+    CBool finished = waitUntil([&done, &total] { return done.load() == total.load(); }, TEST_WAIT_TTL);
+    if (!finished) {
+        printf("[test] only [%lu] of [%lu] tasks finished\n", (unsigned long)done.load(), (unsigned long)total.load());
+    }
+    CGRAPH_TEST_CHECK(finished)
+    for (auto& cur : futures) {
+        for (auto& future : cur) {
+            // 任务中先计数，再设置结果，这里需要等待
+            CGRAPH_TEST_CHECK(std::future_status::ready == future.wait_for(std::chrono::milliseconds(TEST_WAIT_TTL)))
+        }
+    }
+
+    // 调整结束之后，线程池仍然可以正常执行任务
+    CGRAPH_TEST_CHECK(pool.resizePrimaryThread(2).isOK())
+    CGRAPH_TEST_CHECK(2 == pool.getPrimaryThreadSize())
+    CGRAPH_TEST_CHECK(3 == pool.commit([] { return 3; }).get())
+    CGRAPH_TEST_CHECK(pool.resizePrimaryThread(config.max_thread_size_).isOK())
+    CGRAPH_TEST_CHECK(config.max_thread_size_ == pool.getConfig().default_thread_size_)
+}
+
+
+/**
+ * 非法的调整：超出范围，或者在待回收的 primary 线程中调整
+ */
+CVoid test_functional_resize_reject() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.max_thread_size_ = 6;
+    UThreadPool pool(true, config);
+
+    CGRAPH_TEST_CHECK(pool.resizePrimaryThread(0).isErr())
+    CGRAPH_TEST_CHECK(pool.resizePrimaryThread(7).isErr())
+
+    // 任务可能被其他线程盗取，按照实际执行的线程判断。回收执行线程的调整，需要被拒绝
+    for (CInt i = 0; i < 4; i++) {
+        auto future = pool.commitWithTid([&pool] {
+            CIndex index = pool.getThreadIndex();
+            return index <= 0 || pool.resizePrimaryThread(index).isErr();
+        }, i, false, false);
+        CGRAPH_TEST_CHECK(future.get())
+    }
+    CGRAPH_TEST_CHECK(4 == pool.getPrimaryThreadSize())
+}
+
+
+/**
+ * 写入没有运行的 primary 线程的时候，写入 pool 的通用队列。加锁之后调整主线程个数，解锁之前的写入仍然在同一个线程中
+ */
+CVoid test_functional_resize_tid() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.max_thread_size_ = 8;
+    UThreadPool pool(true, config);
+
+    auto lockFuture = pool.commitWithTid([] { return 1; }, 5, true, true);
+    auto unlockFuture = pool.commitWithTid([] { return 2; }, 5, true, false);
+    CGRAPH_TEST_CHECK(std::future_status::ready == lockFuture.wait_for(std::chrono::milliseconds(500)))
+    CGRAPH_TEST_CHECK(std::future_status::ready == unlockFuture.wait_for(std::chrono::milliseconds(500)))
+    CGRAPH_TEST_CHECK(1 == lockFuture.get() && 2 == unlockFuture.get())
+
+    std::atomic<CInt> done {0};
+    pool.executeWithTid([&done] { done++; }, 5, true, true);
+    pool.executeWithTid([&done] { done++; }, 5, false, false);
+    pool.executeWithTid([&done] { done++; }, 5, true, false);
+    CGRAPH_TEST_CHECK(waitUntil([&done] { return 3 == done; }, 500))
+
+    // 加锁之后，回收加锁的线程，再解锁
+    pool.executeWithTid([&done] { done++; }, 3, true, true);
+    CGRAPH_TEST_CHECK(pool.resizePrimaryThread(2).isOK())
+    pool.executeWithTid([&done] { done++; }, 3, false, false);
+    pool.executeWithTid([&done] { done++; }, 3, true, false);
+    CGRAPH_TEST_CHECK(waitUntil([&done] { return 6 == done; }, 500))
+
+    // 加锁之后，增加线程，再解锁
+    pool.executeWithTid([&done] { done++; }, 1, true, true);
+    CGRAPH_TEST_CHECK(pool.resizePrimaryThread(8).isOK())
+    pool.executeWithTid([&done] { done++; }, 1, true, false);
+    pool.executeWithTid([&done] { done++; }, 7, false, false);
+    CGRAPH_TEST_CHECK(waitUntil([&done] { return 9 == done; }, 500))
+}
+
+
+/**
+ * 加锁的写入进入通用队列之后，对应的线程被重新开启。同一组中后续的写入和解锁，仍然进入通用队列，不会写入没有加锁的线程
+ */
+CVoid test_functional_resize_tid_pool() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.max_thread_size_ = 8;
+    config.secondary_thread_size_ = 0;
+    config.monitor_enable_ = false;
+    UThreadPool pool(true, config);
+
+    std::atomic<CInt> done {0};
+    pool.executeWithTid([&done] { done++; }, 5, true, true);
+    CGRAPH_TEST_CHECK(pool.resizePrimaryThread(8).isOK())
+    CGRAPH_TEST_CHECK(waitUntil([&done] { return 1 == done; }, 500))
+
+    // 在其他线程中阻塞所有的主线程（加锁的记录按照线程区分），之后确认剩余的写入所在的队列
+    std::atomic<CBool> release {false};
+    std::atomic<CInt> blocked {0};
+    std::thread blocker([&pool, &release, &blocked] {
+        for (CInt tid = 0; tid < 8; tid++) {
+            pool.executeWithTid([] {}, tid, true, true);
+            pool.executeWithTid([&release, &blocked] {
+                blocked++;
+                while (!release) {
+                    std::this_thread::yield();
+                }
+            }, tid, true, false);
+        }
+    });
+    blocker.join();
+    CGRAPH_TEST_CHECK(waitUntil([&blocked] { return 8 == blocked; }, 10000))
+
+    pool.executeWithTid([&done] { done++; }, 5, false, false);
+    pool.executeWithTid([&done] { done++; }, 5, true, false);
+    UThreadPoolStats stats = pool.getStats();
+    CGRAPH_TEST_CHECK(2 == stats.pool_queue_size_)
+    for (const auto& cur : stats.primary_stats_) {
+        CGRAPH_TEST_CHECK(0 == cur.queue_size_)
+    }
+
+    release = true;
+    CGRAPH_TEST_CHECK(waitUntil([&done] { return 3 == done; }, 10000))
+}
+
+
+/**
+ * 反复释放和重新初始化线程池的同时，其他线程（包括任务中）获取统计信息，不会访问到已经释放的线程
+ */
+CVoid test_functional_resize_stats() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.max_thread_size_ = 8;
+    config.latency_enable_ = true;
+    UThreadPool pool(true, config);
+
+    std::atomic<CBool> stop {false};
+    std::thread reader([&pool, &stop] {
+        while (!stop) {
+            UThreadPoolStats stats = pool.getStats();
+            CGRAPH_TEST_CHECK(stats.primary_stats_.size() <= 8)
+        }
+    });
+
+    for (CInt i = 0; i < 50; i++) {
+        std::atomic<CInt> done {0};
+        for (CInt j = 0; j < 8; j++) {
+            pool.execute([&pool, &done] {
+                pool.getStats();
+                done++;
+            });
+        }
+        CGRAPH_TEST_CHECK(waitUntil([&done] { return 8 == done; }, 10000))
+        CGRAPH_TEST_CHECK(pool.destroy().isOK())
+        CGRAPH_TEST_CHECK(pool.init().isOK())
+    }
+    stop = true;
+    reader.join();
+}
+
+
+int main() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.max_thread_size_ = 8;
+    test_functional_resize_concurrent(config);
+
+    config.batch_task_enable_ = true;
+    config.steal_half_enable_ = true;
+    test_functional_resize_concurrent(config);
+
+    test_functional_resize_reject();
+    test_functional_resize_tid();
+    test_functional_resize_tid_pool();
+    test_functional_resize_stats();
+    printf("[test] test-functional-resize finished\n");
+    return 0;
+}
@@ -0,0 +1,190 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-ring-buffer-queue.cpp
+@Time: 2026/10/18 12:10
+@Desc: 无锁环形队列（多入多出 / 单入单出）的正确性，含批量写入和批量读取
+***************************/
+
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include "../_Materials/TestInclude.h"
+
+static const CSize TEST_VALUE_SIZE = 200000;                 // 每个写入线程写入的个数
+static const CInt TEST_QUEUE_CAPACITY = 64;                  // 容量较小，覆盖队列已满和回绕的情况
+static const CInt TEST_MAX_BATCH_SIZE = 17;
+
+using TestMpmcQueue = ULockFreeRingBufferQueue<CSize, TEST_QUEUE_CAPACITY>;
+using TestSpscQueue = ULockFreeSpscRingBufferQueue<CSize, TEST_QUEUE_CAPACITY>;
+
+
+/**
+ * 单线程中的边界情况：队列已满、部分写入、队列为空
+ */
+CVoid test_functional_ring_buffer_bound() {
+    TestMpmcQueue queue;
+    std::vector<CSize> values;
+    for (CSize i = 0; i < (CSize)TEST_QUEUE_CAPACITY + 10; i++) {
+        values.push_back(i);
+    }
+
+    // 批量写入的时候，仅写入容量以内的部分，剩余部分保留在 values 中
+    CGRAPH_TEST_CHECK(!queue.tryPush(values))
+    CGRAPH_TEST_CHECK(10 == values.size() && TEST_QUEUE_CAPACITY == values.front())
+    CSize value = 0;
+    CGRAPH_TEST_CHECK(!queue.tryPush(std::move(value)))
+
+    std::vector<CSize> result;
+    CGRAPH_TEST_CHECK(queue.tryPop(result, TEST_MAX_BATCH_SIZE))
+    CGRAPH_TEST_CHECK((CSize)TEST_MAX_BATCH_SIZE == result.size())
+    while (queue.tryPop(value)) {
+        result.push_back(value);
+    }
+    CGRAPH_TEST_CHECK((CSize)TEST_QUEUE_CAPACITY == result.size())
+    for (CSize i = 0; i < result.size(); i++) {
+        CGRAPH_TEST_CHECK(i == result[i])
+    }
+    CGRAPH_TEST_CHECK(!queue.tryPop(result, TEST_MAX_BATCH_SIZE))
+
+    TestSpscQueue spsc;
+    CGRAPH_TEST_CHECK(!spsc.tryPush(values = std::vector<CSize>(TEST_QUEUE_CAPACITY + 1, 1)))
+    CGRAPH_TEST_CHECK(1 == values.size())
+    result.clear();
+    CGRAPH_TEST_CHECK(spsc.tryPop(result, TEST_QUEUE_CAPACITY * 2))
+    CGRAPH_TEST_CHECK((CSize)TEST_QUEUE_CAPACITY == result.size())
+    CGRAPH_TEST_CHECK(!spsc.tryPop(value))
+}
+
+
+/**
+ * 写入线程交替使用单个写入和批量写入。数值为 线程index * TEST_VALUE_SIZE + 序号
+ * @tparam QueueType
+ * @param queue
+ * @param index
+ */
+template<typename QueueType>
+CVoid produce(QueueType& queue, CSize index) {
+    std::vector<CSize> values;
+    CSize cur = 0;
+    CSize batchSize = 1;
+    while (cur < TEST_VALUE_SIZE) {
+        if (0 == cur % 3) {
+            CSize value = index * TEST_VALUE_SIZE + cur;
+            if (queue.tryPush(std::move(value))) {
+                cur++;
+            } else {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        batchSize = batchSize % TEST_MAX_BATCH_SIZE + 1;
+        for (CSize i = 0; i < batchSize && cur + i < TEST_VALUE_SIZE; i++) {
+            values.push_back(index * TEST_VALUE_SIZE + cur + i);
+        }
+        cur += values.size();
+        while (!queue.tryPush(values)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+/**
+ * 读取线程交替使用单个读取和批量读取，记录每个数值被读取的次数
+ * 同一个写入线程的数值，在同一个读取线程中需要按照写入的顺序读到
+ * @tparam QueueType
+ * @param queue
+ * @param counts
+ * @param popped
+ * @param total
+ * @param producerSize
+ */
+template<typename QueueType>
+CVoid consume(QueueType& queue, std::unique_ptr<std::atomic<CUInt>[]>& counts,
+              std::atomic<CSize>& popped, CSize total, CSize producerSize) {
+    std::vector<CSize> lastValues(producerSize, 0);
+    std::vector<CBool> hasValues(producerSize, false);
+    std::vector<CSize> values;
+    CInt batchSize = 0;
+    while (popped.load() < total) {
+        values.clear();
+        CSize value = 0;
+        batchSize = batchSize % TEST_MAX_BATCH_SIZE + 1;
+        if (1 == batchSize % 2) {
+            if (queue.tryPop(value)) {
+                values.push_back(value);
+            }
+        } else {
+            queue.tryPop(values, batchSize);
+        }
+        if (values.empty()) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (CSize cur : values) {
+            CGRAPH_TEST_CHECK(cur < total)
+            const CSize producer = cur / TEST_VALUE_SIZE;
+            CGRAPH_TEST_CHECK(!hasValues[producer] || lastValues[producer] < cur)
+            lastValues[producer] = cur;
+            hasValues[producer] = true;
+            counts[cur]++;
+        }
+        popped += values.size();
+    }
+}
+
+
+/**
+ * 多个线程同时读写，确认每个数值恰好被读取一次
+ * @tparam QueueType
+ * @param producerSize
+ * @param consumerSize
+ */
+template<typename QueueType>
+CVoid test_functional_ring_buffer_concurrent(CSize producerSize, CSize consumerSize) {
+    QueueType queue;
+    const CSize total = producerSize * TEST_VALUE_SIZE;
+    std::unique_ptr<std::atomic<CUInt>[]> counts(new std::atomic<CUInt>[total]);
+    for (CSize i = 0; i < total; i++) {
+        counts[i].store(0);
+    }
+    std::atomic<CSize> popped {0};
+
+    std::vector<std::thread> threads;
+    for (CSize i = 0; i < producerSize; i++) {
+        threads.emplace_back([&queue, i] { produce(queue, i); });
+    }
+    for (CSize i = 0; i < consumerSize; i++) {
+        threads.emplace_back([&queue, &counts, &popped, total, producerSize] {
+            consume(queue, counts, popped, total, producerSize);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CGRAPH_TEST_CHECK(total == popped.load())
+    for (CSize i = 0; i < total; i++) {
+        CGRAPH_TEST_CHECK(1 == counts[i].load())
+    }
+    CSize value = 0;
+    CGRAPH_TEST_CHECK(!queue.tryPop(value))
+}
+
+
+int main() {
+    test_functional_ring_buffer_bound();
+
+    const CSize sizes[][2] = {{1, 1}, {2, 2}, {4, 1}, {1, 4}, {4, 4}};
+    for (const auto& size : sizes) {
+        test_functional_ring_buffer_concurrent<TestMpmcQueue>(size[0], size[1]);
+    }
+    test_functional_ring_buffer_concurrent<TestSpscQueue>(1, 1);
+
+    printf("[test] test-functional-ring-buffer-queue finished\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-secondary.cpp
+@Time: 2026/10/18 17:10
+@Desc: 辅助线程的回收和唤醒。回收的时候，待回收线程中正在执行的任务，仍然可以继续提交任务
+ * 多个辅助线程休眠的时候，写入的每个优先级任务，都可以唤醒一个辅助线程
+***************************/
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "../_Materials/TestInclude.h"
+
+static const CInt TEST_RELEASE_ROUND = 8;
+static const CMSec TEST_WAIT_TTL = 10000;
+
+
+/**
+ * 回收辅助线程的时候，被回收的线程中，正在执行的任务再提交优先级任务（此时还有其他休眠中的辅助线程）
+ * 回收的线程需要在锁外等待结束，否则提交任务时唤醒辅助线程，会和回收线程互相等待
+ */
+CVoid test_functional_secondary_release() {
+    for (CInt round = 0; round < TEST_RELEASE_ROUND; round++) {
+        UThreadPoolConfig config;
+        config.default_thread_size_ = 1;
+        config.max_thread_size_ = 8;
+        config.secondary_thread_size_ = 3;
+        config.secondary_reserve_size_ = 0;
+        config.queue_emtpy_interval_ = 5000;    // 休眠中的辅助线程，在测试过程中不会超时退出
+        UThreadPool pool(true, config);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));    // 等待辅助线程进入休眠
+
+        std::atomic<CBool> releasing {false};
+        std::atomic<CInt> done {0};
+        auto future = pool.commitWithPriority([&pool, &releasing, &done] {
+            while (!releasing) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));    // 等待回收线程开始等待当前线程结束
+            pool.commitWithPriority([&done] { done++; }, 1);
+            done++;
+        }, 1);
+
+        // 标记前两个辅助线程，再回收被标记的线程
+        CGRAPH_TEST_CHECK(pool.releaseSecondaryThread(2).isOK())
+        std::atomic<CBool> released {false};
+        std::thread releaser([&pool, &releasing, &released] {
+            releasing = true;
+            pool.releaseSecondaryThread(0);
+            released = true;
+        });
+
+        CBool finished = waitUntil([&released] { return released.load(); }, TEST_WAIT_TTL);
+        if (!finished) {
+            printf("[test] release secondary thread blocked, in round [%d]\n", round);
+            std::exit(1);
+        }
+        releaser.join();
+        future.wait();
+        CGRAPH_TEST_CHECK(waitUntil([&done] { return 2 == done; }, TEST_WAIT_TTL))
+    }
+}
+
+
+/**
+ * 多个辅助线程休眠的时候，写入多个优先级任务，每个任务都唤醒一个辅助线程，并且同时执行
+ */
+CVoid test_functional_secondary_wakeup() {
+    const CInt secondarySize = 4;
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 1;
+    config.max_thread_size_ = 8;
+    config.secondary_thread_size_ = secondarySize;
+    config.secondary_reserve_size_ = 0;
+    config.queue_emtpy_interval_ = 5000;
+    UThreadPool pool(true, config);
+
+    for (CInt round = 0; round < 4; round++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));    // 等待辅助线程进入休眠
+        std::atomic<CInt> started {0};
+        std::vector<std::future<CBool>> futures;
+        for (CInt i = 0; i < secondarySize; i++) {
+            futures.emplace_back(pool.commitWithPriority([&started, secondarySize] {
+                started++;
+                return waitUntil([&started, secondarySize] { return secondarySize == started; }, TEST_WAIT_TTL);
+            }, i));
+        }
+        for (auto& future : futures) {
+            CGRAPH_TEST_CHECK(future.get())
+        }
+    }
+}
+
+
+int main() {
+    test_functional_secondary_release();
+    test_functional_secondary_wakeup();
+
+    printf("[test] test-functional-secondary finished\n");
+    return 0;
+}
@@ -0,0 +1,257 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-segment-queue.cpp
+@Time: 2026/10/18 19:10
+@Desc: 无锁分段队列和 hazard pointer。覆盖段的追加、回收复用、阻塞等待弹出，以及多入多出的时候每个数值恰好被获取一次
+ * 默认编译的时候，通用队列不使用无锁分段队列，这里开启 _CGRAPH_LOCKFREE_POOL_QUEUE_ENABLE_，同时覆盖线程池中的使用
+***************************/
+
+#ifndef _CGRAPH_LOCKFREE_POOL_QUEUE_ENABLE_
+#define _CGRAPH_LOCKFREE_POOL_QUEUE_ENABLE_
+#endif
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "../_Materials/TestInclude.h"
+#include "../_Materials/TestAllocCounter.h"
+
+static const CSize TEST_SEGMENT_SIZE = 4;                      // 较小的段，频繁触发段的追加和回收
+static const CInt TEST_PRODUCER_SIZE = 4;
+static const CInt TEST_CONSUMER_SIZE = 4;
+static const CSize TEST_PRODUCE_SIZE = 100000;                 // 每个写入线程写入的个数
+static const CMSec TEST_WAIT_TTL = 10000;
+
+using TestQueue = ULockFreeSegmentQueue<CSize, TEST_SEGMENT_SIZE>;
+
+
+/**
+ * 写入多个段的数据，按照写入的顺序弹出。批量写入和批量弹出同样跨段
+ */
+CVoid test_functional_segment_queue_rollover() {
+    TestQueue queue;
+    CGRAPH_TEST_CHECK(queue.empty())
+
+    const CSize total = TEST_SEGMENT_SIZE * 10 + 1;
+    for (CSize i = 0; i < total; i++) {
+        queue.push(CSize(i));
+    }
+    CGRAPH_TEST_CHECK(total == queue.size() && !queue.empty())
+
+    CSize value = 0;
+    for (CSize i = 0; i < total; i++) {
+        CGRAPH_TEST_CHECK(queue.tryPop(value) && i == value)
+    }
+    CGRAPH_TEST_CHECK(!queue.tryPop(value) && queue.empty() && 0 == queue.size())
+
+    std::vector<CSize> values;
+    for (CSize i = 0; i < total; i++) {
+        values.push_back(i);
+    }
+    queue.pushBulk(values.begin(), values.end());
+    CGRAPH_TEST_CHECK(total == queue.size())
+
+    values.clear();
+    CGRAPH_TEST_CHECK(queue.tryPop(values, (CInt)total - 1) && total - 1 == values.size())
+    for (CSize i = 0; i < values.size(); i++) {
+        CGRAPH_TEST_CHECK(i == values[i])
+    }
+    CGRAPH_TEST_CHECK(queue.tryPop(value) && total - 1 == value && queue.empty())
+}
+
+
+/**
+ * 读完的段被回收之后再次使用。稳定之后，反复写入和弹出多个段的数据，不再申请内存，并且复用的段中没有残留的数据
+ */
+CVoid test_functional_segment_queue_reuse() {
+    TestQueue queue;
+    const CSize total = TEST_SEGMENT_SIZE * 8;
+    CSize value = 0;
+    for (CInt round = 0; round < 4; round++) {
+        for (CSize i = 0; i < total; i++) {
+            queue.push(CSize(i));
+        }
+        while (queue.tryPop(value)) {
+        }
+    }
+
+    auto before = getAllocTimes();
+    for (CInt round = 0; round < 100; round++) {
+        for (CSize i = 0; i < total; i++) {
+            queue.push(round * total + i);
+        }
+        for (CSize i = 0; i < total; i++) {
+            CGRAPH_TEST_CHECK(queue.tryPop(value) && round * total + i == value)
+        }
+        CGRAPH_TEST_CHECK(!queue.tryPop(value))
+    }
+    auto times = getAllocTimes() - before;
+    printf("[test] segment alloc times in steady state: %lu\n", times);
+    CGRAPH_TEST_CHECK(0 == times)
+}
+
+
+/**
+ * 阻塞等待弹出：空队列超时返回，写入之后唤醒等待的线程，reset() 之后不用等到超时即返回，setup() 清空剩余数据
+ */
+CVoid test_functional_segment_queue_timeout() {
+    TestQueue queue;
+    CSize value = 0;
+    {
+        TestTimer timer;
+        CGRAPH_TEST_CHECK(!queue.popWithTimeout(value, 20))
+        CGRAPH_TEST_CHECK(timer.getElapsedMs() >= 15)
+    }
+
+    std::atomic<CBool> popped {false};
+    std::thread waiter([&queue, &popped] {
+        CSize cur = 0;
+        popped = queue.popWithTimeout(cur, TEST_WAIT_TTL) && 7 == cur;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.push(CSize(7));
+    CGRAPH_TEST_CHECK(waitUntil([&popped] { return popped.load(); }, TEST_WAIT_TTL))
+    waiter.join();
+
+    std::atomic<CInt> released {0};
+    std::vector<std::thread> waiters;
+    for (CInt i = 0; i < 4; i++) {
+        waiters.emplace_back([&queue, &released] {
+            CSize cur = 0;
+            if (!queue.popWithTimeout(cur, TEST_WAIT_TTL)) {
+                released++;
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    TestTimer timer;
+    queue.reset();
+    for (auto& cur : waiters) {
+        cur.join();
+    }
+    CGRAPH_TEST_CHECK(4 == released && timer.getElapsedMs() < TEST_WAIT_TTL / 2)
+
+    for (CSize i = 0; i < TEST_SEGMENT_SIZE * 3; i++) {
+        queue.push(CSize(i));
+    }
+    queue.setup();
+    CGRAPH_TEST_CHECK(queue.empty() && !queue.tryPop(value))
+    queue.push(CSize(9));
+    CGRAPH_TEST_CHECK(queue.popWithTimeout(value, 20) && 9 == value)
+}
+
+
+/**
+ * hazard pointer：被保护的节点不能被回收，清除之后可以回收。线程退出之后，不再保护之前的节点
+ */
+CVoid test_functional_segment_queue_hazard() {
+    CInt node = 0;
+    CInt other = 0;
+    std::atomic<CInt *> src {&node};
+
+    CGRAPH_TEST_CHECK(&node == UHazardPointer::protect(src))
+    CGRAPH_TEST_CHECK(UHazardPointer::isHazard(&node) && !UHazardPointer::isHazard(&other))
+    UHazardPointer::clear();
+    CGRAPH_TEST_CHECK(!UHazardPointer::isHazard(&node))
+
+    std::atomic<CInt> step {0};
+    std::thread holder([&src, &step] {
+        UHazardPointer::protect(src);
+        step = 1;
+        while (1 == step) {
+            std::this_thread::yield();
+        }
+    });
+    CGRAPH_TEST_CHECK(waitUntil([&step] { return 1 == step; }, TEST_WAIT_TTL))
+    CGRAPH_TEST_CHECK(UHazardPointer::isHazard(&node))
+    step = 2;
+    holder.join();
+    CGRAPH_TEST_CHECK(!UHazardPointer::isHazard(&node))
+}
+
+
+/**
+ * 多个线程同时写入和弹出，段不断的追加和复用。确认每个数值恰好被获取一次
+ */
+CVoid test_functional_segment_queue_mpmc() {
+    TestQueue queue;
+    const CSize total = TEST_PRODUCER_SIZE * TEST_PRODUCE_SIZE;
+    std::unique_ptr<std::atomic<CUInt>[]> counts(new std::atomic<CUInt>[total]);
+    for (CSize i = 0; i < total; i++) {
+        counts[i] = 0;
+    }
+
+    std::atomic<CSize> popped {0};
+    std::vector<std::thread> threads;
+    for (CInt i = 0; i < TEST_PRODUCER_SIZE; i++) {
+        threads.emplace_back([&queue, i] {
+            for (CSize j = 0; j < TEST_PRODUCE_SIZE; j++) {
+                queue.push(i * TEST_PRODUCE_SIZE + j);
+            }
+        });
+    }
+    for (CInt i = 0; i < TEST_CONSUMER_SIZE; i++) {
+        threads.emplace_back([&queue, &counts, &popped, total, i] {
+            CSize value = 0;
+            std::vector<CSize> values;
+            while (popped < total) {
+                CBool result = (0 == i % 2) ? queue.popWithTimeout(value, 1) : queue.tryPop(value);
+                if (result) {
+                    values.push_back(value);
+                } else if (!queue.tryPop(values, 8)) {
+                    continue;
+                }
+                for (CSize cur : values) {
+                    CGRAPH_TEST_CHECK(cur < total)
+                    counts[cur]++;
+                }
+                popped += values.size();
+                values.clear();
+            }
+        });
+    }
+    for (auto& cur : threads) {
+        cur.join();
+    }
+
+    CGRAPH_TEST_CHECK(total == popped && queue.empty())
+    for (CSize i = 0; i < total; i++) {
+        CGRAPH_TEST_CHECK(1 == counts[i].load())
+    }
+}
+
+
+/**
+ * 通用队列使用无锁分段队列的时候，写入通用队列的任务，被主线程和辅助线程全部执行
+ */
+CVoid test_functional_segment_queue_pool() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 2;
+    config.secondary_thread_size_ = 2;
+    config.max_thread_size_ = 4;
+    UThreadPool pool(true, config);
+
+    const CSize taskSize = CGRAPH_DEFAULT_SEGMENT_SIZE * 20 + 1;
+    std::atomic<CSize> done {0};
+    for (CSize i = 0; i < taskSize; i++) {
+        pool.execute([&done] { done++; }, CGRAPH_POOL_TASK_STRATEGY);
+    }
+    CGRAPH_TEST_CHECK(waitUntil([&done, taskSize] { return taskSize == done; }, TEST_WAIT_TTL))
+    CGRAPH_TEST_CHECK(0 == pool.getStats().pool_queue_size_)
+}
+
+
+int main() {
+    test_functional_segment_queue_rollover();
+    test_functional_segment_queue_reuse();
+    test_functional_segment_queue_timeout();
+    test_functional_segment_queue_hazard();
+    test_functional_segment_queue_mpmc();
+    test_functional_segment_queue_pool();
+
+    printf("[test] test-functional-segment-queue finished\n");
+    return 0;
+}
@@ -0,0 +1,132 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-task-alloc.cpp
+@Time: 2026/10/18 16:15
+@Desc: UTask 中的堆内存申请次数。较小的函数体直接存放在内部，构造、move 和执行都不申请内存；较大的函数体申请一次
+***************************/
+
+#include <atomic>
+#include <array>
+
+#include "../_Materials/TestAllocCounter.h"
+#include "../_Materials/TestInclude.h"
+
+static const CSize TEST_TASK_SIZE = 100000;                  // 线程池中执行的任务个数
+static const CSize TEST_WARMUP_SIZE = 10000;                 // 预热时，每轮提交的任务个数
+static const CSize TEST_STEADY_SIZE = 64;                    // 稳定运行时，每轮提交的任务个数，不超过各个队列的初始容量
+static const CInt TEST_STEADY_ROUND = 200;
+
+
+/**
+ * move 可能抛出异常的函数，不会存放在内部
+ */
+struct TestThrowMove {
+    TestThrowMove() = default;
+    TestThrowMove(const TestThrowMove&) = default;
+    TestThrowMove(TestThrowMove&&) {}
+
+    CVoid operator()() const {}
+};
+
+
+/**
+ * 单个任务的构造、move 和执行
+ */
+CVoid test_functional_task_alloc_inline() {
+    CInt value = 0;
+    CInt* ptr = &value;
+    auto small = [ptr, &value] { (*ptr)++; };
+    static_assert(sizeof(small) <= CGRAPH_TASK_INLINE_SIZE, "small task should be stored inline");
+
+    auto before = getAllocTimes();
+    {
+        UTask task(small);
+        UTask moved(std::move(task));
+        UTask assigned;
+        assigned = std::move(moved);
+        assigned();
+        CGRAPH_TEST_CHECK(task.empty() && moved.empty() && nullptr != assigned.target<decltype(small)>())
+    }
+    CGRAPH_TEST_CHECK(getAllocTimes() == before && 1 == value)
+
+    std::array<CChar, CGRAPH_TASK_INLINE_SIZE + 1> buf {};
+    auto large = [buf, &value] { value += buf[0] + 1; };
+    before = getAllocTimes();
+    {
+        UTask task(large);
+        UTask moved(std::move(task));
+        moved();
+    }
+    CGRAPH_TEST_CHECK(getAllocTimes() == before + 1 && 2 == value)
+
+    before = getAllocTimes();
+    {
+        UTask task {TestThrowMove()};
+        UTask moved(std::move(task));
+        moved();
+    }
+    CGRAPH_TEST_CHECK(getAllocTimes() == before + 1)
+}
+
+
+/**
+ * 线程池中执行较小的任务，平均每个任务的申请次数应远小于1。剩余的申请来自队列自身的扩容
+ */
+CVoid test_functional_task_alloc_pool() {
+    std::atomic<CSize> done {0};
+    UThreadPool pool;
+    auto before = getAllocTimes();
+    for (CSize i = 0; i < TEST_TASK_SIZE; i++) {
+        pool.execute([&done] { done++; });
+    }
+    CGRAPH_TEST_CHECK(waitUntil([&done] { return TEST_TASK_SIZE == done; }, 60000))
+    CDouble times = (CDouble)(getAllocTimes() - before) / TEST_TASK_SIZE;
+    printf("[test] alloc times per task: %.4f\n", times);
+    CGRAPH_TEST_CHECK(times < 0.5)
+}
+
+
+/**
+ * 开启批量执行的时候，先用较多的任务预热（各个队列和批量缓存扩容到足够的大小），之后稳定运行时不再申请内存
+ * 不开启辅助线程，防止监控线程在统计期间新建线程
+ */
+CVoid test_functional_task_alloc_batch() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.secondary_thread_size_ = 0;
+    config.max_thread_size_ = 4;
+    config.batch_task_enable_ = true;
+    UThreadPool pool(true, config);
+
+    std::atomic<CSize> done {0};
+    auto runRound = [&pool, &done](CSize size) {
+        done = 0;
+        for (CSize i = 0; i < size; i++) {
+            pool.execute([&done] { done++; });
+        }
+        CGRAPH_TEST_CHECK(waitUntil([&done, size] { return size == done; }, 60000))
+    };
+
+    for (CInt i = 0; i < 4; i++) {
+        runRound(TEST_WARMUP_SIZE);
+    }
+
+    auto before = getAllocTimes();
+    for (CInt i = 0; i < TEST_STEADY_ROUND; i++) {
+        runRound(TEST_STEADY_SIZE);
+    }
+    auto times = getAllocTimes() - before;
+    printf("[test] batch alloc times in steady state: %lu\n", times);
+    CGRAPH_TEST_CHECK(0 == times)
+}
+
+
+int main() {
+    test_functional_task_alloc_inline();
+    test_functional_task_alloc_pool();
+    test_functional_task_alloc_batch();
+
+    printf("[test] test-functional-task-alloc finished\n");
+    return 0;
+}
@@ -0,0 +1,151 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-task-group.cpp
+@Time: 2026/10/18 14:50
+@Desc: 任务组和 commit 系列接口中，函数体的拷贝次数。右值不发生拷贝，左值任务组按照拷贝的方式执行，可以重复执行
+***************************/
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <iterator>
+
+#include "../_Materials/TestInclude.h"
+
+static std::atomic<CInt> g_copy_times {0};
+static std::atomic<CInt> g_run_times {0};
+
+
+/**
+ * 记录拷贝次数的函数
+ */
+struct TestCopyCounter {
+    TestCopyCounter() = default;
+    TestCopyCounter(const TestCopyCounter&) { g_copy_times++; }
+    TestCopyCounter(TestCopyCounter&&) noexcept = default;
+
+    CInt operator()() const {
+        g_run_times++;
+        return 1;
+    }
+};
+
+
+/**
+ * 仅可 move 的函数
+ */
+struct TestMoveOnly {
+    TestMoveOnly() : value_(new CInt(1)) {}
+
+    CInt operator()() const {
+        g_run_times++;
+        return *value_;
+    }
+
+    std::unique_ptr<CInt> value_;
+};
+
+
+CVoid resetTimes() {
+    g_copy_times = 0;
+    g_run_times = 0;
+}
+
+
+/**
+ * 左值任务组：拷贝执行，任务组不变，可以重复执行；右值任务组：move 执行，执行之后被清空
+ */
+CVoid test_functional_task_group_submit(UThreadPoolPtr pool) {
+    resetTimes();
+    UTaskGroup group;
+    for (CInt i = 0; i < 8; i++) {
+        group.addTask(TestCopyCounter());
+    }
+    CGRAPH_TEST_CHECK(0 == g_copy_times)
+
+    CGRAPH_TEST_CHECK(pool->submit(group).isOK())
+    CGRAPH_TEST_CHECK(8 == g_copy_times && 8 == g_run_times && 8 == group.getSize())
+    const UTaskGroup& constGroup = group;
+    CGRAPH_TEST_CHECK(pool->submit(constGroup).isOK())
+    CGRAPH_TEST_CHECK(16 == g_copy_times && 16 == g_run_times && 8 == group.getSize())
+
+    CGRAPH_TEST_CHECK(pool->submit(std::move(group)).isOK())
+    CGRAPH_TEST_CHECK(16 == g_copy_times && 24 == g_run_times && 0 == group.getSize())
+
+    // 左值添加的时候，拷贝一次
+    resetTimes();
+    TestCopyCounter counter;
+    group.addTask(counter);
+    CGRAPH_TEST_CHECK(pool->submit(std::move(group)).isOK())
+    CGRAPH_TEST_CHECK(1 == g_copy_times && 1 == g_run_times)
+
+    // 单个任务直接执行
+    resetTimes();
+    CGRAPH_TEST_CHECK(pool->submit(TestCopyCounter()).isOK())
+    CGRAPH_TEST_CHECK(0 == g_copy_times && 1 == g_run_times)
+
+    // 回调函数和超时时间，在两种执行方式中都生效
+    std::atomic<CInt> finished {0};
+    UTaskGroup ttlGroup(TestCopyCounter(), 1000, [&finished](const CStatus& status) {
+        if (status.isOK()) {
+            finished++;
+        }
+    });
+    CGRAPH_TEST_CHECK(pool->submit(ttlGroup).isOK() && 1 == finished)
+    CGRAPH_TEST_CHECK(pool->submit(std::move(ttlGroup)).isOK() && 2 == finished)
+}
+
+
+/**
+ * 仅可 move 的函数，只能通过右值任务组执行。按照左值执行的时候，返回错误，并且不执行任何任务
+ */
+CVoid test_functional_task_group_move_only(UThreadPoolPtr pool) {
+    resetTimes();
+    UTaskGroup group;
+    group.addTask(TestCopyCounter());
+    group.addTask(TestMoveOnly());
+    CGRAPH_TEST_CHECK(pool->submit(group).isErr())
+    CGRAPH_TEST_CHECK(0 == g_run_times && 2 == group.getSize())
+
+    CGRAPH_TEST_CHECK(pool->submit(std::move(group)).isOK())
+    CGRAPH_TEST_CHECK(2 == g_run_times && 0 == g_copy_times)
+}
+
+
+/**
+ * commit 系列接口中，右值不发生拷贝
+ */
+CVoid test_functional_task_group_commit(UThreadPoolPtr pool) {
+    resetTimes();
+    CInt sum = pool->commit(TestCopyCounter()).get()
+               + pool->commitFast(TestCopyCounter()).get()
+               + pool->commitWithTid(TestCopyCounter(), 0, false, false).get()
+               + pool->commitWithPriority(TestCopyCounter(), 0).get()
+               + pool->commitWithLane(TestCopyCounter(), UTaskLane::HIGH).get()
+               + pool->commitWithTag(TestCopyCounter(), 0).get()
+               + pool->commit(TestMoveOnly()).get();
+    CGRAPH_TEST_CHECK(7 == sum && 0 == g_copy_times)
+
+    std::vector<TestCopyCounter> counters(8);
+    for (auto& future : pool->commitBulk(std::make_move_iterator(counters.begin()),
+                                         std::make_move_iterator(counters.end()))) {
+        sum += future.get();
+    }
+    CGRAPH_TEST_CHECK(15 == sum && 0 == g_copy_times)
+
+    // 左值的函数，拷贝一次
+    TestCopyCounter counter;
+    CGRAPH_TEST_CHECK(1 == pool->commit(counter).get() && 1 == g_copy_times)
+}
+
+
+int main() {
+    UThreadPool pool;
+    test_functional_task_group_submit(&pool);
+    test_functional_task_group_move_only(&pool);
+    test_functional_task_group_commit(&pool);
+
+    printf("[test] test-functional-task-group finished\n");
+    return 0;
+}
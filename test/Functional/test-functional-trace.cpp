@@ -0,0 +1,80 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-trace.cpp
+@Time: 2026/10/18 16:40
+@Desc: 调度事件的记录和导出。线程名称中的特殊字符需要转义，未开启记录的时候不记录任何事件
+***************************/
+
+#ifndef _CGRAPH_TRACE_ENABLE_
+#define _CGRAPH_TRACE_ENABLE_
+#endif
+
+#include <string>
+#include <thread>
+
+#include "../_Materials/TestInclude.h"
+
+
+/**
+ * 未调用 start() 的时候，不记录事件
+ */
+CVoid test_functional_trace_disable() {
+    CGRAPH_TEST_CHECK(!UTraceRecorder::isEnable())
+    std::thread([] {
+        CGRAPH_TRACE_THREAD_NAME("disabled")
+        CGRAPH_TRACE(ENQUEUE, 0, 1)
+    }).join();
+    CGRAPH_TEST_CHECK(std::string::npos == UTraceRecorder::get().dumpJson().find("enqueue"))
+}
+
+
+/**
+ * 线程名称中的引号、反斜杠和控制字符，导出时转义
+ */
+CVoid test_functional_trace_escape() {
+    UTraceRecorder::get().start();
+    CGRAPH_TEST_CHECK(UTraceRecorder::isEnable())
+    std::thread([] {
+        CGRAPH_TRACE_THREAD_NAME("a\"b\\c\nd\x01")
+        CGRAPH_TRACE(ENQUEUE, 0, 1)
+    }).join();
+    UTraceRecorder::get().stop();
+    CGRAPH_TEST_CHECK(!UTraceRecorder::isEnable())
+
+    const std::string json = UTraceRecorder::get().dumpJson();
+    CGRAPH_TEST_CHECK(std::string::npos != json.find(R"("args":{"name":"a\"b\\c\nd\u0001"})"))
+    CGRAPH_TEST_CHECK(std::string::npos != json.find("enqueue"))
+    CGRAPH_TEST_CHECK(std::string::npos == json.find('\x01'))
+}
+
+
+/**
+ * 线程池中的事件，在开启之后记录
+ */
+CVoid test_functional_trace_pool() {
+    UTraceRecorder::get().start();
+    {
+        UThreadPool pool;
+        std::atomic<CInt> done {0};
+        for (CInt i = 0; i < 100; i++) {
+            pool.execute([&done] { done++; });
+        }
+        CGRAPH_TEST_CHECK(waitUntil([&done] { return 100 == done; }, 10000))
+    }
+    UTraceRecorder::get().stop();
+
+    const std::string json = UTraceRecorder::get().dumpJson();
+    CGRAPH_TEST_CHECK(std::string::npos != json.find("\"primary-0\""))
+    CGRAPH_TEST_CHECK(std::string::npos != json.find(R"("name":"run","ph":"B")"))
+}
+
+
+int main() {
+    test_functional_trace_disable();
+    test_functional_trace_escape();
+    test_functional_trace_pool();
+
+    printf("[test] test-functional-trace finished\n");
+    return 0;
+}
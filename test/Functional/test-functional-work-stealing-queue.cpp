@@ -0,0 +1,244 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-functional-work-stealing-queue.cpp
+@Time: 2026/10/18 13:30
+@Desc: 盗取队列（Chase-Lev 双端队列 + inbox）中，持有线程弹出和盗取线程盗取的竞争，确认每个任务恰好被获取一次
+***************************/
+
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include "../_Materials/TestInclude.h"
+
+static const CSize TEST_LOCAL_SIZE = 300000;                 // 持有线程写入的个数
+static const CSize TEST_EXTERNAL_SIZE = 120000;              // 每个外部线程写入的个数，为6的倍数
+static const CInt TEST_QUEUE_CAPACITY = 4;                   // 初始容量较小，覆盖扩容的情况
+static const CInt TEST_MAX_BATCH_SIZE = 7;
+
+using TestQueue = UWorkStealingQueue<CSize>;
+
+
+/**
+ * 记录获取到的数值
+ * @param counts
+ * @param popped
+ * @param values
+ * @param total
+ */
+CVoid record(std::unique_ptr<std::atomic<CUInt>[]>& counts, std::atomic<CSize>& popped,
+             const std::vector<CSize>& values, CSize total) {
+    for (CSize cur : values) {
+        CGRAPH_TEST_CHECK(cur < total)
+        counts[cur]++;
+    }
+    popped += values.size();
+}
+
+
+/**
+ * 确认每个数值恰好被获取一次
+ * @param counts
+ * @param total
+ */
+CVoid checkCounts(std::unique_ptr<std::atomic<CUInt>[]>& counts, CSize total) {
+    for (CSize i = 0; i < total; i++) {
+        CGRAPH_TEST_CHECK(1 == counts[i].load())
+    }
+}
+
+
+/**
+ * 单线程中的顺序：持有线程从底部弹出（后进先出），盗取从顶部进行（先进先出）
+ */
+CVoid test_functional_work_stealing_order() {
+    TestQueue queue(TEST_QUEUE_CAPACITY);
+    for (CSize i = 0; i < 10; i++) {
+        queue.pushLocal(CSize(i));
+    }
+    CGRAPH_TEST_CHECK(10 == queue.size())
+
+    CSize value = 0;
+    CGRAPH_TEST_CHECK(queue.tryPop(value) && 9 == value)
+    CGRAPH_TEST_CHECK(queue.trySteal(value) && 0 == value)
+
+    std::vector<CSize> values;
+    CGRAPH_TEST_CHECK(queue.tryStealHalf(values))
+    CGRAPH_TEST_CHECK(4 == values.size() && 1 == values.front() && 4 == values.back())
+    values.clear();
+    CGRAPH_TEST_CHECK(queue.tryPop(values, TEST_MAX_BATCH_SIZE))
+    CGRAPH_TEST_CHECK(4 == values.size() && 8 == values.front() && 5 == values.back())
+    CGRAPH_TEST_CHECK(queue.empty() && !queue.tryPop(value) && !queue.trySteal(value))
+
+    // 外部写入的任务，持有线程按照写入的顺序弹出，盗取线程优先盗取最新写入的
+    for (CSize i = 0; i < 4; i++) {
+        queue.push(CSize(i));
+    }
+    CGRAPH_TEST_CHECK(queue.trySteal(value) && 3 == value)
+    CGRAPH_TEST_CHECK(queue.tryPopExternal(value) && 0 == value)
+    CGRAPH_TEST_CHECK(queue.tryPop(value) && 1 == value)
+    CGRAPH_TEST_CHECK(queue.trySteal(value) && 2 == value)
+    CGRAPH_TEST_CHECK(queue.empty())
+}
+
+
+/**
+ * 持有线程一直只保留一个节点，写入后立即弹出，和盗取线程竞争最后一个节点
+ * @param thiefSize
+ */
+CVoid test_functional_work_stealing_last_node(CSize thiefSize) {
+    TestQueue queue(TEST_QUEUE_CAPACITY);
+    const CSize total = TEST_LOCAL_SIZE;
+    std::unique_ptr<std::atomic<CUInt>[]> counts(new std::atomic<CUInt>[total]);
+    for (CSize i = 0; i < total; i++) {
+        counts[i].store(0);
+    }
+    std::atomic<CSize> popped {0};
+    std::atomic<CBool> finished {false};
+
+    std::vector<std::thread> thieves;
+    for (CSize i = 0; i < thiefSize; i++) {
+        thieves.emplace_back([&queue, &counts, &popped, &finished, total] {
+            std::vector<CSize> values(1);
+            while (!finished) {
+                if (queue.trySteal(values[0])) {
+                    record(counts, popped, values, total);
+                }
+            }
+        });
+    }
+
+    std::vector<CSize> values(1);
+    for (CSize i = 0; i < total; i++) {
+        queue.pushLocal(CSize(i));
+        if (queue.tryPop(values[0])) {
+            record(counts, popped, values, total);
+        }
+    }
+    CGRAPH_TEST_CHECK(waitUntil([&popped, total] { return popped.load() == total; }, 30000))
+    finished = true;
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    checkCounts(counts, total);
+    CGRAPH_TEST_CHECK(queue.empty())
+}
+
+
+/**
+ * 持有线程在底部写入和弹出（单个/批量/inbox），外部线程写入 inbox，盗取线程交替使用三种盗取方式
+ * 持有线程写入 [0, TEST_LOCAL_SIZE)，第 i 个外部线程写入之后的第 i 段
+ * @param externalSize
+ * @param thiefSize
+ */
+CVoid test_functional_work_stealing_concurrent(CSize externalSize, CSize thiefSize) {
+    TestQueue queue(TEST_QUEUE_CAPACITY);
+    const CSize total = TEST_LOCAL_SIZE + externalSize * TEST_EXTERNAL_SIZE;
+    std::unique_ptr<std::atomic<CUInt>[]> counts(new std::atomic<CUInt>[total]);
+    for (CSize i = 0; i < total; i++) {
+        counts[i].store(0);
+    }
+    std::atomic<CSize> popped {0};
+
+    std::vector<std::thread> threads;
+    for (CSize i = 0; i < externalSize; i++) {
+        threads.emplace_back([&queue, i] {
+            const CSize begin = TEST_LOCAL_SIZE + i * TEST_EXTERNAL_SIZE;
+            std::vector<CSize> values;
+            CSize step = 0;
+            for (CSize cur = begin; cur < begin + TEST_EXTERNAL_SIZE; cur++) {
+                switch (step++ % 4) {
+                    case 0: queue.push(CSize(cur)); break;
+                    case 1: while (!queue.tryPush(CSize(cur))) { std::this_thread::yield(); } break;
+                    case 2:
+                        // 加锁写入、不加锁写入、写入并解锁，连续写入3个
+                        queue.push(CSize(cur), true, true);
+                        queue.push(CSize(++cur), false, false);
+                        queue.push(CSize(++cur), true, false);
+                        break;
+                    default:
+                        values.push_back(cur);
+                        if (values.size() >= (CSize)TEST_MAX_BATCH_SIZE) {
+                            queue.pushBulk(values.begin(), values.end());
+                            values.clear();
+                        }
+                        break;
+                }
+            }
+            if (!values.empty()) {
+                queue.push(values);
+            }
+        });
+    }
+
+    for (CSize i = 0; i < thiefSize; i++) {
+        threads.emplace_back([&queue, &counts, &popped, total] {
+            std::vector<CSize> values;
+            CInt batchSize = 0;
+            while (popped.load() < total) {
+                values.clear();
+                batchSize = batchSize % TEST_MAX_BATCH_SIZE + 1;
+                switch (batchSize % 3) {
+                    case 0: values.resize(1); if (!queue.trySteal(values[0])) { values.clear(); } break;
+                    case 1: queue.trySteal(values, batchSize); break;
+                    default: queue.tryStealHalf(values); break;
+                }
+                if (values.empty()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                record(counts, popped, values, total);
+            }
+        });
+    }
+
+    // 持有线程：写入一小段之后，交替使用不同的方式弹出一部分，保证双端队列中始终有可以盗取的任务
+    std::vector<CSize> values;
+    CSize cur = 0;
+    CInt batchSize = 0;
+    while (popped.load() < total) {
+        for (CSize i = 0; i < 5 && cur < TEST_LOCAL_SIZE; i++) {
+            queue.pushLocal(CSize(cur++));
+        }
+
+        values.clear();
+        batchSize = batchSize % TEST_MAX_BATCH_SIZE + 1;
+        switch (batchSize % 3) {
+            case 0: values.resize(1); if (!queue.tryPop(values[0])) { values.clear(); } break;
+            case 1: queue.tryPop(values, batchSize); break;
+            default: values.resize(1); if (!queue.tryPopExternal(values[0])) { values.clear(); } break;
+        }
+        if (!values.empty()) {
+            record(counts, popped, values, total);
+        } else if (cur >= TEST_LOCAL_SIZE) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CGRAPH_TEST_CHECK(total == popped.load())
+    checkCounts(counts, total);
+    CGRAPH_TEST_CHECK(queue.empty())
+}
+
+
+int main() {
+    test_functional_work_stealing_order();
+
+    const CSize thiefSizes[] = {1, 2, 4};
+    for (CSize thiefSize : thiefSizes) {
+        test_functional_work_stealing_last_node(thiefSize);
+    }
+
+    const CSize sizes[][2] = {{0, 1}, {1, 1}, {2, 2}, {1, 4}, {4, 4}};
+    for (const auto& size : sizes) {
+        test_functional_work_stealing_concurrent(size[0], size[1]);
+    }
+
+    printf("[test] test-functional-work-stealing-queue finished\n");
+    return 0;
+}
@@ -0,0 +1,100 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-performance-dispatch.cpp
+@Time: 2026/10/18 18:40
+@Desc: 长短任务混合提交的时候，不同的 dispatch_queue_threshold_ 下，各个主线程之间执行时长的偏差，以及任务的开始延迟
+ * 每 TEST_LONG_INTERVAL 个任务中，有一个长任务，其余为短任务
+***************************/
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include "../_Materials/TestInclude.h"
+
+static const CInt TEST_THREAD_SIZE = 4;
+static const CSize TEST_TASK_SIZE = 20000;
+static const CInt TEST_SHORT_TASK_US = 2;
+static const CInt TEST_LONG_TASK_US = 200;
+static const CSize TEST_LONG_INTERVAL = 16;
+static const CIndex TEST_POOL_ONLY = -1;                          // 全部写入通用队列，作为对比
+
+using TestClock = std::chrono::steady_clock;
+
+
+/**
+ * 忙等一段时间，模拟计算型的任务
+ * @param us
+ */
+CVoid busyWait(CInt us) {
+    auto end = TestClock::now() + std::chrono::microseconds(us);
+    while (TestClock::now() < end) {
+    }
+}
+
+
+/**
+ * 按照阈值提交长短混合的任务，统计完成时长、开始延迟的分位数，以及各线程执行时长的最大值和平均值之比
+ * @param threshold 为 TEST_POOL_ONLY 的时候，全部写入通用队列
+ */
+CVoid calcSkew(CInt threshold) {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = TEST_THREAD_SIZE;
+    config.max_thread_size_ = TEST_THREAD_SIZE;
+    config.secondary_thread_size_ = 0;
+    config.dispatch_queue_threshold_ = (std::max)(threshold, 0);
+    UThreadPool pool(true, config);
+
+    std::mutex mutex;
+    std::map<std::thread::id, CULong> busyUs;                     // 每个线程中，任务的执行时长
+    std::vector<CDouble> startUs(TEST_TASK_SIZE, 0.0);
+    std::atomic<CSize> done {0};
+
+    auto begin = TestClock::now();
+    for (CSize i = 0; i < TEST_TASK_SIZE; i++) {
+        const CInt us = (0 == i % TEST_LONG_INTERVAL) ? TEST_LONG_TASK_US : TEST_SHORT_TASK_US;
+        auto submitTime = TestClock::now();
+        auto task = [&mutex, &busyUs, &startUs, &done, submitTime, us, i] {
+            startUs[i] = std::chrono::duration<CDouble, std::micro>(TestClock::now() - submitTime).count();
+            busyWait(us);
+            {
+                CGRAPH_LOCK_GUARD lk(mutex);
+                busyUs[std::this_thread::get_id()] += us;
+            }
+            done.fetch_add(1, std::memory_order_release);
+        };
+        pool.execute(task, TEST_POOL_ONLY == threshold ? CGRAPH_POOL_TASK_STRATEGY : CGRAPH_DEFAULT_TASK_STRATEGY);
+    }
+    CGRAPH_TEST_CHECK(waitUntil([&done] { return TEST_TASK_SIZE == done; }, 120000))
+    CDouble totalMs = std::chrono::duration<CDouble, std::milli>(TestClock::now() - begin).count();
+
+    CULong maxUs = 0;
+    CULong sumUs = 0;
+    for (const auto& cur : busyUs) {
+        maxUs = (std::max)(maxUs, cur.second);
+        sumUs += cur.second;
+    }
+    std::sort(startUs.begin(), startUs.end());
+
+    const std::string name = TEST_POOL_ONLY == threshold ? "pool-only" : std::to_string(threshold);
+    printf("%-12s %10.1f %10.1f %10.1f %10.2f\n", name.c_str(), totalMs,
+           startUs[TEST_TASK_SIZE / 2], startUs[TEST_TASK_SIZE * 99 / 100],
+           (CDouble)maxUs * TEST_THREAD_SIZE / sumUs);
+    fflush(stdout);
+}
+
+
+int main() {
+    printf("mixed %dus/%dus tasks (1 long in %d), %d primary threads\n",
+           TEST_SHORT_TASK_US, TEST_LONG_TASK_US, (CInt)TEST_LONG_INTERVAL, TEST_THREAD_SIZE);
+    printf("%-12s %10s %10s %10s %10s\n", "threshold", "total(ms)", "p50(us)", "p99(us)", "max/avg");
+    const CInt thresholds[] = {0, CGRAPH_DISPATCH_QUEUE_THRESHOLD, 1 << 30, TEST_POOL_ONLY};
+    for (CInt threshold : thresholds) {
+        calcSkew(threshold);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-performance-false-sharing.cpp
+@Time: 2026/10/18 15:50
+@Desc: 伪共享对比。按照写入线程分缓存行存放（和 UWorkStealingQueue / UThreadBase 中的分组方式一致），和紧凑存放的耗时对比
+ * 以及外部线程持续写入小任务的时候，线程池的吞吐。需要在多核机器上执行，单核的时候没有伪共享
+***************************/
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+#include "../_Materials/TestInclude.h"
+
+static const CSize TEST_OPERATE_TIMES = 20000000;            // 持有线程的操作次数
+static const CSize TEST_TASK_SIZE = 1000000;                 // 线程池吞吐测试中，写入的任务总个数
+
+
+/**
+ * 紧凑存放：持有线程写入的 bottom_ 和盗取线程写入的 top_ 在同一个缓存行中
+ */
+struct TestPackedIndex {
+    std::atomic<std::int64_t> top_ {0};
+    std::atomic<std::int64_t> bottom_ {0};
+};
+
+
+/**
+ * 分缓存行存放
+ */
+struct TestAlignedIndex {
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<std::int64_t> top_ {0};
+    alignas(CGRAPH_CACHE_LINE_SIZE) std::atomic<std::int64_t> bottom_ {0};
+};
+
+
+/**
+ * 持有线程不断修改 bottom_，盗取线程不断读取 bottom_ 并通过 CAS 修改 top_
+ * @tparam IndexType
+ * @param thiefSize
+ * @return 持有线程每次操作的平均耗时（ns）
+ */
+template<typename IndexType>
+CDouble calcOwnerNs(CSize thiefSize) {
+    IndexType index;
+    std::atomic<CBool> finished {false};
+    std::vector<std::thread> thieves;
+    for (CSize i = 0; i < thiefSize; i++) {
+        thieves.emplace_back([&index, &finished] {
+            while (!finished.load(std::memory_order_relaxed)) {
+                std::int64_t top = index.top_.load(std::memory_order_acquire);
+                if (top < index.bottom_.load(std::memory_order_acquire)) {
+                    index.top_.compare_exchange_weak(top, top + 1, std::memory_order_acq_rel);
+                }
+            }
+        });
+    }
+
+    TestTimer timer;
+    for (CSize i = 0; i < TEST_OPERATE_TIMES; i++) {
+        index.bottom_.store(index.bottom_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    CDouble ns = timer.getElapsedMs() * 1000000.0 / TEST_OPERATE_TIMES;
+
+    finished = true;
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+    return ns;
+}
+
+
+/**
+ * 多个外部线程持续写入小任务，主线程执行的同时，会修改 is_running_ 等信息
+ * @param producerSize
+ * @return 每个任务的平均耗时（ns）
+ */
+CDouble calcPoolTaskNs(CSize producerSize) {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.max_thread_size_ = 4;
+    UThreadPool pool(true, config);
+    std::atomic<CSize> done {0};
+    const CSize produceSize = TEST_TASK_SIZE / producerSize;
+
+    TestTimer timer;
+    std::vector<std::thread> producers;
+    for (CSize i = 0; i < producerSize; i++) {
+        producers.emplace_back([&pool, &done, produceSize] {
+            for (CSize j = 0; j < produceSize; j++) {
+                pool.execute([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    CGRAPH_TEST_CHECK(waitUntil([&done, produceSize, producerSize] {
+        return done.load() == produceSize * producerSize;
+    }, 60000))
+    return timer.getElapsedMs() * 1000000.0 / (produceSize * producerSize);
+}
+
+
+int main() {
+    printf("cache line size: %d, alignof(UWorkStealingQueue<UTask>): %zu\n\n",
+           (int)CGRAPH_CACHE_LINE_SIZE, alignof(UWorkStealingQueue<UTask>));
+
+    const CSize thiefSizes[] = {0, 1, 2, 4};
+    printf("%-8s %12s %12s\n", "thief", "packed", "aligned");
+    for (CSize thiefSize : thiefSizes) {
+        printf("%-8zu %10.2fns %10.2fns\n", thiefSize,
+               calcOwnerNs<TestPackedIndex>(thiefSize), calcOwnerNs<TestAlignedIndex>(thiefSize));
+        fflush(stdout);
+    }
+
+    const CSize producerSizes[] = {1, 2, 4};
+    printf("\n%-8s %12s\n", "producer", "pool-task");
+    for (CSize producerSize : producerSizes) {
+        printf("%-8zu %10.2fns\n", producerSize, calcPoolTaskNs(producerSize));
+        fflush(stdout);
+    }
+    return 0;
+}
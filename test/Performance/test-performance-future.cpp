@@ -0,0 +1,80 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-performance-future.cpp
+@Time: 2026/10/18 14:10
+@Desc: 提交任务并等待结果的往返耗时，对比 commit（std::future）和 commitFast（UFuture）
+***************************/
+
+#include <vector>
+
+#include "../_Materials/TestInclude.h"
+
+static const CSize TEST_ROUND_TRIP_TIMES = 200000;           // 单次提交并等待的次数
+static const CSize TEST_BATCH_SIZE = 64;                     // 批量提交之后，再统一等待
+
+
+/**
+ * 逐个提交并等待，计算每次往返的平均耗时
+ * @tparam Submitter
+ * @param submitter
+ * @return 平均耗时（ns）
+ */
+template<typename Submitter>
+CDouble calcRoundTripNs(Submitter submitter) {
+    CSize sum = 0;
+    TestTimer timer;
+    for (CSize i = 0; i < TEST_ROUND_TRIP_TIMES; i++) {
+        sum += submitter(i).get();
+    }
+    CGRAPH_TEST_CHECK(sum == TEST_ROUND_TRIP_TIMES * (TEST_ROUND_TRIP_TIMES - 1) / 2)
+    return timer.getElapsedMs() * 1000000.0 / TEST_ROUND_TRIP_TIMES;
+}
+
+
+/**
+ * 每次提交 TEST_BATCH_SIZE 个之后统一等待，计算每个任务的平均耗时
+ * @tparam FutureType
+ * @tparam Submitter
+ * @param submitter
+ * @return 平均耗时（ns）
+ */
+template<typename FutureType, typename Submitter>
+CDouble calcBatchNs(Submitter submitter) {
+    CSize sum = 0;
+    std::vector<FutureType> futures;
+    futures.reserve(TEST_BATCH_SIZE);
+    TestTimer timer;
+    for (CSize i = 0; i < TEST_ROUND_TRIP_TIMES; i += TEST_BATCH_SIZE) {
+        for (CSize j = i; j < i + TEST_BATCH_SIZE; j++) {
+            futures.emplace_back(submitter(j));
+        }
+        for (auto& future : futures) {
+            sum += future.get();
+        }
+        futures.clear();
+    }
+    CGRAPH_TEST_CHECK(sum > 0)
+    return timer.getElapsedMs() * 1000000.0 / TEST_ROUND_TRIP_TIMES;
+}
+
+
+int main() {
+    const CInt threadSizes[] = {1, 4, 8};
+    printf("%-8s %14s %14s %14s %14s\n", "thread", "commit", "commitFast", "commit-64", "commitFast-64");
+    for (CInt threadSize : threadSizes) {
+        UThreadPoolConfig config;
+        config.default_thread_size_ = threadSize;
+        config.max_thread_size_ = threadSize;
+        UThreadPool pool(true, config);
+
+        auto commit = [&pool](CSize i) { return pool.commit([i] { return i; }); };
+        auto commitFast = [&pool](CSize i) { return pool.commitFast([i] { return i; }); };
+        calcRoundTripNs(commitFast);    // 预热，填充线程本地的缓存
+        printf("%-8d %12.1fns %12.1fns %12.1fns %12.1fns\n", threadSize,
+               calcRoundTripNs(commit), calcRoundTripNs(commitFast),
+               calcBatchNs<std::future<CSize>>(commit), calcBatchNs<UFuture<CSize>>(commitFast));
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-performance-lane.cpp
+@Time: 2026/10/18 18:20
+@Desc: 普通任务持续占满线程池的时候，分别通过 NORMAL/HIGH/URGENT 通道提交探测任务，对比探测任务从提交到开始执行的延迟分布
+***************************/
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include "../_Materials/TestInclude.h"
+
+static const CInt TEST_THREAD_SIZE = 4;
+static const CSize TEST_LOAD_BACKLOG = 256 * TEST_THREAD_SIZE;    // 线程池中保持的普通任务积压个数
+static const CInt TEST_LOAD_TASK_US = 20;                         // 每个普通任务的执行时长
+static const CInt TEST_PROBE_TIMES = 500;                         // 每个通道的探测次数
+static const CInt TEST_PROBE_INTERVAL_US = 500;
+
+using TestClock = std::chrono::steady_clock;
+
+
+/**
+ * 忙等一段时间，模拟计算型的任务
+ * @param us
+ */
+CVoid busyWait(CInt us) {
+    auto end = TestClock::now() + std::chrono::microseconds(us);
+    while (TestClock::now() < end) {
+    }
+}
+
+
+/**
+ * 获取分位数
+ * @param values 已排序
+ * @param ratio
+ * @return
+ */
+CDouble calcPercentile(const std::vector<CDouble>& values, CDouble ratio) {
+    return values[(CSize)((values.size() - 1) * ratio)];
+}
+
+
+/**
+ * 保持线程池被普通任务占满的同时，按照固定间隔通过 lane 提交探测任务，记录探测任务的开始延迟
+ * @param lane
+ */
+CVoid calcProbeLatency(UTaskLane lane) {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = TEST_THREAD_SIZE;
+    config.max_thread_size_ = TEST_THREAD_SIZE;
+    config.secondary_thread_size_ = 0;
+    UThreadPool pool(true, config);
+
+    std::atomic<CBool> stop {false};
+    std::atomic<CSize> loadDone {0};
+    std::thread loader([&pool, &stop, &loadDone] {
+        CSize submitted = 0;
+        while (!stop) {
+            if (submitted - loadDone.load(std::memory_order_relaxed) < TEST_LOAD_BACKLOG) {
+                pool.execute([&loadDone] {
+                    busyWait(TEST_LOAD_TASK_US);
+                    loadDone.fetch_add(1, std::memory_order_relaxed);
+                });
+                submitted++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));    // 等待积压的任务达到稳定
+
+    std::vector<CDouble> latencies(TEST_PROBE_TIMES, 0.0);
+    std::atomic<CInt> probeDone {0};
+    for (CInt i = 0; i < TEST_PROBE_TIMES; i++) {
+        auto submitTime = TestClock::now();
+        pool.executeWithLane([&latencies, &probeDone, submitTime, i] {
+            latencies[i] = std::chrono::duration<CDouble, std::micro>(TestClock::now() - submitTime).count();
+            probeDone++;
+        }, lane);
+        std::this_thread::sleep_for(std::chrono::microseconds(TEST_PROBE_INTERVAL_US));
+    }
+    CGRAPH_TEST_CHECK(waitUntil([&probeDone] { return TEST_PROBE_TIMES == probeDone; }, 120000))
+    stop = true;
+    loader.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    const CChar* name = UTaskLane::URGENT == lane ? "urgent" : (UTaskLane::HIGH == lane ? "high" : "normal");
+    printf("%-12s %10.1f %10.1f %10.1f %10.1f\n", name,
+           calcPercentile(latencies, 0.5), calcPercentile(latencies, 0.99),
+           calcPercentile(latencies, 0.999), latencies.back());
+    fflush(stdout);
+}
+
+
+int main() {
+    printf("probe start latency under saturating normal load, in us\n");
+    printf("%-12s %10s %10s %10s %10s\n", "lane", "p50", "p99", "p99.9", "max");
+    calcProbeLatency(UTaskLane::NORMAL);
+    calcProbeLatency(UTaskLane::HIGH);
+    calcProbeLatency(UTaskLane::URGENT);
+    return 0;
+}
@@ -0,0 +1,139 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-performance-ring-buffer-queue.cpp
+@Time: 2026/10/18 12:10
+@Desc: 无锁环形队列在不同写入/读取线程个数下的吞吐（ops/s），并和加锁的队列对比
+***************************/
+
+#include <vector>
+#include <atomic>
+
+#include "../_Materials/TestInclude.h"
+
+static const CSize TEST_TOTAL_SIZE = 2000000;                // 每一轮写入和读取的总个数
+static const CInt TEST_BATCH_SIZE = 16;
+
+
+/** 加锁的无界队列，作为对比 */
+class TestMutexQueue {
+public:
+    CBool tryPush(CSize&& value) {
+        queue_.push(std::move(value));
+        return true;
+    }
+
+    CBool tryPush(std::vector<CSize>& values) {
+        queue_.pushBulk(values.begin(), values.end());
+        values.clear();
+        return true;
+    }
+
+    CBool tryPop(CSize& value) {
+        return queue_.tryPop(value);
+    }
+
+    CBool tryPop(std::vector<CSize>& values, int maxBatchSize) {
+        return queue_.tryPop(values, maxBatchSize);
+    }
+
+private:
+    UAtomicQueue<CSize> queue_;
+};
+
+
+/**
+ * 计算吞吐
+ * @tparam QueueType
+ * @param producerSize
+ * @param consumerSize
+ * @param batchSize 为1的时候，单个写入和读取，否则批量写入和读取
+ * @return 每秒写入并读取的个数
+ */
+template<typename QueueType>
+CDouble calcOpsPerSecond(CSize producerSize, CSize consumerSize, CInt batchSize) {
+    QueueType queue;
+    const CSize produceSize = TEST_TOTAL_SIZE / producerSize;
+    const CSize total = produceSize * producerSize;
+    std::atomic<CSize> popped {0};
+    std::atomic<CBool> start {false};
+
+    std::vector<std::thread> threads;
+    for (CSize i = 0; i < producerSize; i++) {
+        threads.emplace_back([&queue, &start, produceSize, batchSize] {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            std::vector<CSize> values;
+            for (CSize cur = 0; cur < produceSize; ) {
+                if (1 == batchSize) {
+                    CSize value = cur;
+                    if (queue.tryPush(std::move(value))) {
+                        cur++;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                    continue;
+                }
+                for (CInt j = 0; j < batchSize && cur < produceSize; j++) {
+                    values.push_back(cur++);
+                }
+                while (!queue.tryPush(values)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (CSize i = 0; i < consumerSize; i++) {
+        threads.emplace_back([&queue, &start, &popped, total, batchSize] {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            std::vector<CSize> values;
+            CSize value = 0;
+            while (popped.load(std::memory_order_relaxed) < total) {
+                CSize size = 0;
+                if (1 == batchSize) {
+                    size = queue.tryPop(value) ? 1 : 0;
+                } else {
+                    values.clear();
+                    queue.tryPop(values, batchSize);
+                    size = values.size();
+                }
+                if (size > 0) {
+                    popped.fetch_add(size, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    TestTimer timer;
+    start = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return (CDouble)total / timer.getElapsedMs() * 1000.0;
+}
+
+
+int main() {
+    const CSize sizes[][2] = {{1, 1}, {1, 4}, {4, 1}, {2, 2}, {4, 4}, {8, 8}};
+    printf("%-8s %-8s %12s %12s %12s %12s\n", "producer", "consumer",
+           "mpmc", "mpmc-batch", "mutex", "mutex-batch");
+    for (const auto& size : sizes) {
+        printf("%-8zu %-8zu %10.2fM %10.2fM %10.2fM %10.2fM\n", size[0], size[1],
+               calcOpsPerSecond<ULockFreeRingBufferQueue<CSize>>(size[0], size[1], 1) / 1000000.0,
+               calcOpsPerSecond<ULockFreeRingBufferQueue<CSize>>(size[0], size[1], TEST_BATCH_SIZE) / 1000000.0,
+               calcOpsPerSecond<TestMutexQueue>(size[0], size[1], 1) / 1000000.0,
+               calcOpsPerSecond<TestMutexQueue>(size[0], size[1], TEST_BATCH_SIZE) / 1000000.0);
+        fflush(stdout);
+    }
+
+    printf("\n%-8s %-8s %12s %12s\n", "producer", "consumer", "spsc", "spsc-batch");
+    printf("%-8d %-8d %10.2fM %10.2fM\n", 1, 1,
+           calcOpsPerSecond<ULockFreeSpscRingBufferQueue<CSize>>(1, 1, 1) / 1000000.0,
+           calcOpsPerSecond<ULockFreeSpscRingBufferQueue<CSize>>(1, 1, TEST_BATCH_SIZE) / 1000000.0);
+    return 0;
+}
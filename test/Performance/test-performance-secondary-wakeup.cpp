@@ -0,0 +1,129 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-performance-secondary-wakeup.cpp
+@Time: 2026/10/18 17:30
+@Desc: 唤醒预留的辅助线程的耗时。包含新建线程池之后，第一个优先级任务（或长时间任务）的提交耗时和开始执行的耗时
+ * 以及辅助线程休眠的时候，多个线程并发提交优先级任务的耗时
+***************************/
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include "../_Materials/TestInclude.h"
+
+static const CInt TEST_TRIAL_TIMES = 100;                    // 新建线程池的次数
+static const CSize TEST_SUBMIT_TIMES = 200000;               // 并发提交时，提交的任务总数
+
+using TestClock = std::chrono::steady_clock;
+
+
+/**
+ * 获取从 start 到 end 的时长，单位为us
+ */
+CDouble calcUs(TestClock::time_point start, TestClock::time_point end) {
+    return std::chrono::duration<CDouble, std::micro>(end - start).count();
+}
+
+
+/**
+ * 获取分位数
+ * @param values
+ * @param ratio
+ * @return
+ */
+CDouble calcPercentile(std::vector<CDouble> values, CDouble ratio) {
+    std::sort(values.begin(), values.end());
+    return values[(CSize)((values.size() - 1) * ratio)];
+}
+
+
+UThreadPoolConfig buildConfig() {
+    UThreadPoolConfig config;
+    config.default_thread_size_ = 4;
+    config.max_thread_size_ = 8;
+    return config;
+}
+
+
+/**
+ * 每次新建线程池，等待辅助线程休眠之后，提交一个任务，记录提交的耗时和开始执行的耗时
+ * @param longTime true 表示按照长时间任务提交，false 表示按照优先级任务提交
+ */
+CVoid calcFirstTaskUs(CBool longTime) {
+    std::vector<CDouble> submitUs;
+    std::vector<CDouble> startUs;
+    for (CInt i = 0; i < TEST_TRIAL_TIMES; i++) {
+        UThreadPool pool(true, buildConfig());
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));    // 等待预留的辅助线程进入休眠
+
+        std::atomic<CBool> started {false};
+        TestClock::time_point startTime;
+        auto task = [&started, &startTime] {
+            startTime = TestClock::now();
+            started = true;
+        };
+        auto begin = TestClock::now();
+        if (longTime) {
+            pool.execute(task, CGRAPH_LONG_TIME_TASK_STRATEGY);
+        } else {
+            pool.commitWithPriority(task, 1);
+        }
+        auto end = TestClock::now();
+        CGRAPH_TEST_CHECK(waitUntil([&started] { return started.load(); }, 10000))
+        submitUs.emplace_back(calcUs(begin, end));
+        startUs.emplace_back(calcUs(begin, startTime));
+    }
+
+    printf("%-16s %8.1f/%-8.1f %8.1f/%.1f\n", longTime ? "long-time" : "priority",
+           calcPercentile(submitUs, 0.5), calcPercentile(submitUs, 0.99),
+           calcPercentile(startUs, 0.5), calcPercentile(startUs, 0.99));
+    fflush(stdout);
+}
+
+
+/**
+ * 多个线程并发提交优先级任务，每个任务都很短，辅助线程频繁的休眠和唤醒
+ * @param submitterSize
+ * @return 每次提交的平均耗时（ns）
+ */
+CDouble calcSubmitNs(CInt submitterSize) {
+    UThreadPool pool(true, buildConfig());
+    std::atomic<CSize> done {0};
+    const CSize submitSize = TEST_SUBMIT_TIMES / submitterSize;
+
+    TestTimer timer;
+    std::vector<std::thread> submitters;
+    for (CInt i = 0; i < submitterSize; i++) {
+        submitters.emplace_back([&pool, &done, submitSize] {
+            for (CSize j = 0; j < submitSize; j++) {
+                pool.commitWithPriority([&done] { done.fetch_add(1, std::memory_order_relaxed); }, 1);
+            }
+        });
+    }
+    for (auto& submitter : submitters) {
+        submitter.join();
+    }
+    CDouble ns = timer.getElapsedMs() * 1000000.0 / (submitSize * submitterSize);
+    CGRAPH_TEST_CHECK(waitUntil([&done, submitSize, submitterSize] {
+        return done.load() == submitSize * submitterSize;
+    }, 60000))
+    return ns;
+}
+
+
+int main() {
+    printf("first task after the pool is created, p50/p99 in us\n");
+    printf("%-16s %17s %17s\n", "case", "submit", "start");
+    calcFirstTaskUs(false);
+    calcFirstTaskUs(true);
+
+    printf("\n%-16s %12s\n", "submitter", "priority");
+    const CInt submitterSizes[] = {1, 2, 4};
+    for (CInt submitterSize : submitterSizes) {
+        printf("%-16d %10.1fns\n", submitterSize, calcSubmitNs(submitterSize));
+        fflush(stdout);
+    }
+    return 0;
+}
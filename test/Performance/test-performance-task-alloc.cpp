@@ -0,0 +1,94 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-performance-task-alloc.cpp
+@Time: 2026/10/18 16:25
+@Desc: 任务的构造、move 和执行的耗时及堆内存申请次数，对比 UTask 和 std::function。以及线程池中，每个任务的申请次数
+***************************/
+
+#include <array>
+#include <atomic>
+#include <functional>
+
+#include "../_Materials/TestAllocCounter.h"
+#include "../_Materials/TestInclude.h"
+
+static const CSize TEST_TASK_TIMES = 2000000;                // 单线程中，构造任务的次数
+static const CSize TEST_POOL_TASK_SIZE = 1000000;            // 线程池中执行的任务个数
+
+
+/**
+ * 构造任务，move 两次之后执行（和写入队列、从队列中取出的过程一致）
+ * @tparam TaskType
+ * @tparam Func
+ * @param func
+ * @param allocTimes 每个任务的平均申请次数
+ * @return 每个任务的平均耗时（ns）
+ */
+template<typename TaskType, typename Func>
+CDouble calcTaskNs(const Func& func, CDouble& allocTimes) {
+    auto before = getAllocTimes();
+    TestTimer timer;
+    for (CSize i = 0; i < TEST_TASK_TIMES; i++) {
+        TaskType task(func);
+        TaskType queued(std::move(task));
+        TaskType popped(std::move(queued));
+        popped();
+    }
+    CDouble ns = timer.getElapsedMs() * 1000000.0 / TEST_TASK_TIMES;
+    allocTimes = (CDouble)(getAllocTimes() - before) / TEST_TASK_TIMES;
+    return ns;
+}
+
+
+/**
+ * 线程池中执行较小的任务
+ * @param allocTimes
+ * @return
+ */
+CDouble calcPoolTaskNs(CDouble& allocTimes) {
+    std::atomic<CSize> done {0};
+    UThreadPool pool;
+    auto before = getAllocTimes();
+    TestTimer timer;
+    for (CSize i = 0; i < TEST_POOL_TASK_SIZE; i++) {
+        pool.execute([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+    }
+    CGRAPH_TEST_CHECK(waitUntil([&done] { return TEST_POOL_TASK_SIZE == done; }, 60000))
+    CDouble ns = timer.getElapsedMs() * 1000000.0 / TEST_POOL_TASK_SIZE;
+    allocTimes = (CDouble)(getAllocTimes() - before) / TEST_POOL_TASK_SIZE;
+    return ns;
+}
+
+
+int main() {
+    std::atomic<CSize> sum {0};
+    CSize step = 1;
+    std::array<CSize, 4> mediumBuf {};
+    std::array<CSize, 8> largeBuf {};
+    // libstdc++ 中，std::function 内部仅可以存放16字节的函数体。medium 对应 UTask 中新增的内部存放的范围
+    auto small = [&sum, step] { sum.fetch_add(step, std::memory_order_relaxed); };
+    auto medium = [&sum, mediumBuf] { sum.fetch_add(mediumBuf[0] + 1, std::memory_order_relaxed); };
+    auto large = [&sum, largeBuf] { sum.fetch_add(largeBuf[0] + 1, std::memory_order_relaxed); };
+    printf("closure size: small %zu, medium %zu, large %zu bytes. inline size: %zu bytes\n\n",
+           sizeof(small), sizeof(medium), sizeof(large), (CSize)CGRAPH_TASK_INLINE_SIZE);
+
+    CDouble allocTimes = 0.0;
+    printf("%-16s %12s %12s\n", "case", "time", "alloc/task");
+    CDouble ns = calcTaskNs<UTask>(small, allocTimes);
+    printf("%-16s %10.2fns %12.4f\n", "UTask-small", ns, allocTimes);
+    ns = calcTaskNs<std::function<CVoid()>>(small, allocTimes);
+    printf("%-16s %10.2fns %12.4f\n", "function-small", ns, allocTimes);
+    ns = calcTaskNs<UTask>(medium, allocTimes);
+    printf("%-16s %10.2fns %12.4f\n", "UTask-medium", ns, allocTimes);
+    ns = calcTaskNs<std::function<CVoid()>>(medium, allocTimes);
+    printf("%-16s %10.2fns %12.4f\n", "function-medium", ns, allocTimes);
+    ns = calcTaskNs<UTask>(large, allocTimes);
+    printf("%-16s %10.2fns %12.4f\n", "UTask-large", ns, allocTimes);
+    ns = calcTaskNs<std::function<CVoid()>>(large, allocTimes);
+    printf("%-16s %10.2fns %12.4f\n", "function-large", ns, allocTimes);
+    ns = calcPoolTaskNs(allocTimes);
+    printf("%-16s %10.2fns %12.4f\n", "pool-execute", ns, allocTimes);
+    CGRAPH_TEST_CHECK(sum > 0)
+    return 0;
+}
@@ -0,0 +1,101 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: test-performance-work-stealing-queue.cpp
+@Time: 2026/10/18 13:30
+@Desc: 盗取队列在不同盗取线程个数下的吞吐（ops/s）。持有线程在底部写入和弹出，盗取线程在顶部竞争
+***************************/
+
+#include <vector>
+#include <atomic>
+
+#include "../_Materials/TestInclude.h"
+
+static const CSize TEST_TOTAL_SIZE = 2000000;                // 每一轮写入并获取的总个数
+static const CInt TEST_BATCH_SIZE = 8;
+
+enum class TestStealType {
+    SINGLE = 0,                // trySteal(value)
+    BATCH = 1,                 // trySteal(values, TEST_BATCH_SIZE)
+    HALF = 2,                  // tryStealHalf(values)
+};
+
+
+/**
+ * 计算吞吐，并统计被盗取的比例
+ * @param thiefSize
+ * @param type
+ * @param stolenRate
+ * @return 每秒写入并获取的个数
+ */
+CDouble calcOpsPerSecond(CSize thiefSize, TestStealType type, CDouble& stolenRate) {
+    UWorkStealingQueue<CSize> queue;
+    std::atomic<CSize> popped {0};
+    std::atomic<CSize> stolen {0};
+    std::atomic<CBool> start {false};
+
+    std::vector<std::thread> thieves;
+    for (CSize i = 0; i < thiefSize; i++) {
+        thieves.emplace_back([&queue, &popped, &stolen, &start, type] {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            std::vector<CSize> values;
+            while (popped.load(std::memory_order_relaxed) < TEST_TOTAL_SIZE) {
+                values.clear();
+                switch (type) {
+                    case TestStealType::SINGLE: values.resize(1); if (!queue.trySteal(values[0])) { values.clear(); } break;
+                    case TestStealType::BATCH: queue.trySteal(values, TEST_BATCH_SIZE); break;
+                    case TestStealType::HALF: queue.tryStealHalf(values); break;
+                }
+                if (values.empty()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                stolen.fetch_add(values.size(), std::memory_order_relaxed);
+                popped.fetch_add(values.size(), std::memory_order_relaxed);
+            }
+        });
+    }
+
+    TestTimer timer;
+    start = true;
+    // 持有线程：每写入 TEST_BATCH_SIZE 个，弹出一个。剩余的留给盗取线程，写完之后自己也参与弹出
+    CSize value = 0;
+    for (CSize cur = 0; cur < TEST_TOTAL_SIZE; cur++) {
+        queue.pushLocal(CSize(cur));
+        if (0 == cur % TEST_BATCH_SIZE && queue.tryPop(value)) {
+            popped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    while (popped.load(std::memory_order_relaxed) < TEST_TOTAL_SIZE) {
+        if (queue.tryPop(value)) {
+            popped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    stolenRate = (CDouble)stolen.load() / TEST_TOTAL_SIZE * 100.0;
+    return (CDouble)TEST_TOTAL_SIZE / timer.getElapsedMs() * 1000.0;
+}
+
+
+int main() {
+    const CSize thiefSizes[] = {0, 1, 2, 4, 8};
+    printf("%-8s %12s %8s %12s %8s %12s %8s\n", "thief",
+           "single", "stolen", "batch", "stolen", "half", "stolen");
+    for (CSize thiefSize : thiefSizes) {
+        CDouble rates[3] = {0.0};
+        CDouble single = calcOpsPerSecond(thiefSize, TestStealType::SINGLE, rates[0]);
+        CDouble batch = calcOpsPerSecond(thiefSize, TestStealType::BATCH, rates[1]);
+        CDouble half = calcOpsPerSecond(thiefSize, TestStealType::HALF, rates[2]);
+        printf("%-8zu %10.2fM %7.1f%% %10.2fM %7.1f%% %10.2fM %7.1f%%\n", thiefSize,
+               single / 1000000.0, rates[0], batch / 1000000.0, rates[1], half / 1000000.0, rates[2]);
+        fflush(stdout);
+    }
+    return 0;
+}
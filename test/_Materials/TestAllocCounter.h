@@ -0,0 +1,141 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: TestAllocCounter.h
+@Time: 2026/10/18 16:10
+@Desc: 替换全局的 operator new，统计堆内存申请次数。会定义全局的 operator new/delete，每个可执行程序中只能包含一次
+ * 普通、nothrow、sized（C++14）和 align_val_t（C++17）的版本都需要替换，保证 new 和 delete 成对使用同一套实现
+***************************/
+
+#ifndef CGRAPH_TESTALLOCCOUNTER_H
+#define CGRAPH_TESTALLOCCOUNTER_H
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+
+    #if defined(__GNUC__)
+/**
+ * 替换的函数不内联到调用处。否则编译器会将内联后的 free() 和 operator new 的返回值配对，误报 -Wmismatched-new-delete
+ */
+#define CGRAPH_TEST_ALLOC_NOINLINE __attribute__((noinline))
+    #else
+#define CGRAPH_TEST_ALLOC_NOINLINE
+    #endif
+
+static std::atomic<unsigned long> g_test_alloc_times {0};         // 全局的堆内存申请次数
+
+
+/**
+ * 获取当前为止的堆内存申请次数
+ * @return
+ */
+inline unsigned long getAllocTimes() {
+    return g_test_alloc_times.load(std::memory_order_relaxed);
+}
+
+
+/**
+ * 申请内存并计数
+ * @param size
+ * @return 申请失败的时候，返回nullptr
+ */
+inline void* testAlloc(std::size_t size) noexcept {
+    g_test_alloc_times.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(0 == size ? 1 : size);
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void* operator new(std::size_t size) {
+    void* ptr = testAlloc(size);
+    if (nullptr == ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return testAlloc(size);
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+
+    #if defined(__cpp_sized_deallocation)
+CGRAPH_TEST_ALLOC_NOINLINE void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+    #endif
+
+
+    #if defined(__cpp_aligned_new)
+/**
+ * 按照对齐要求申请内存并计数。aligned_alloc 要求 size 是 align 的整数倍
+ * @param size
+ * @param align
+ * @return 申请失败的时候，返回nullptr
+ */
+inline void* testAlignedAlloc(std::size_t size, std::align_val_t align) noexcept {
+    g_test_alloc_times.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t alignment = static_cast<std::size_t>(align);
+    size = (0 == size ? 1 : size);
+        #if defined(_WIN32)
+    return _aligned_malloc(size, alignment);
+        #else
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        #endif
+}
+
+
+/**
+ * 释放按照对齐要求申请的内存
+ * @param ptr
+ */
+inline void testAlignedFree(void* ptr) noexcept {
+        #if defined(_WIN32)
+    _aligned_free(ptr);
+        #else
+    std::free(ptr);
+        #endif
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void* operator new(std::size_t size, std::align_val_t align) {
+    void* ptr = testAlignedAlloc(size, align);
+    if (nullptr == ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return testAlignedAlloc(size, align);
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void operator delete(void* ptr, std::align_val_t) noexcept {
+    testAlignedFree(ptr);
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    testAlignedFree(ptr);
+}
+
+
+CGRAPH_TEST_ALLOC_NOINLINE void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    testAlignedFree(ptr);
+}
+    #endif
+
+#endif //CGRAPH_TESTALLOCCOUNTER_H
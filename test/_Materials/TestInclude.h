@@ -0,0 +1,67 @@
+/***************************
+@Author: Chunel
+@Contact: chunel@foxmail.com
+@File: TestInclude.h
+@Time: 2026/10/18 11:20
+@Desc: 测试用例中使用的公共信息
+***************************/
+
+#ifndef CGRAPH_TESTINCLUDE_H
+#define CGRAPH_TESTINCLUDE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+
+#include "../../src/CThreadPool.h"
+
+using namespace CTP;
+
+/** 检查条件是否成立。不成立的时候，打印信息并以非0值退出，ctest 判定为失败 */
+#define CGRAPH_TEST_CHECK(cond)                                                                 \
+    if (!(cond)) {                                                                              \
+        printf("[test] check [%s] failed, in [%s] line [%d]\n", #cond, __FILE__, __LINE__);    \
+        std::exit(1);                                                                           \
+    }                                                                                           \
+
+
+/** 计时信息 */
+class TestTimer {
+public:
+    TestTimer() : start_(std::chrono::steady_clock::now()) {
+    }
+
+    /**
+     * 获取从创建到现在的时长，单位为ms
+     * @return
+     */
+    CDouble getElapsedMs() const {
+        return std::chrono::duration<CDouble, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+
+/**
+ * 等待条件成立，超时返回 false。用于检查任务是否全部执行，避免任务丢失的时候，测试一直阻塞
+ * @tparam Predicate
+ * @param pred
+ * @param ms
+ * @return
+ */
+template<typename Predicate>
+CBool waitUntil(Predicate pred, CMSec ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return true;
+}
+
+#endif //CGRAPH_TESTINCLUDE_H